@@ -0,0 +1,488 @@
+// Microbenchmarks of the layer kernels and of the whole inference for the three generated variants, with a
+// regression gate against a stored baseline. Build next to main.cpp:
+//   g++ -Wall -Wextra -pedantic -Ofast -march=native -std=c++17 -o gsc_bench -Iboard/gsc_output_fixed/ board/gsc_output_fixed/model.c board/gsc_output_fixed/model_int8.c bench.cpp
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "model.h"
+#include "model_int8.h"
+
+// Weights of every variant, conv1d_6/dense_4 is the model of cnn(). Each file undefines its macros at the end
+#include "weights/conv1d.c"
+#include "weights/dense.c"
+#include "weights/conv1d_5.c"
+#include "weights/dense_2.c"
+#include "weights/conv1d_6.c"
+#include "weights/dense_4.c"
+
+// Batch sizes of the sweep, larger than MODEL_BATCH_SIZE runs several steps of the batched kernels
+static const unsigned int batch_sizes[] = {1, 2, 4, 8, 16, 32, 64};
+static const unsigned int max_batch = 64;
+static const unsigned int repetitions = 5; // Timed repetitions of each benchmark, the fastest is kept
+
+// Core cycles from the Linux perf counter, TSC ticks when it cannot be opened (virtual machines, perf_event_paranoid),
+// nothing on other hosts
+class CycleCounter {
+private:
+	int fd = -1;
+
+public:
+	CycleCounter() {
+#ifdef __linux__
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CPU_CYCLES;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+
+	CycleCounter(const CycleCounter &) = delete;
+	CycleCounter &operator=(const CycleCounter &) = delete;
+
+	~CycleCounter() {
+#ifdef __linux__
+		if (fd >= 0) {
+			::close(fd);
+		}
+#endif
+	}
+
+	const char *source() const {
+		if (fd >= 0) {
+			return "perf";
+		}
+#if defined(__x86_64__) || defined(__i386__)
+		return "tsc";
+#else
+		return "none";
+#endif
+	}
+
+	uint64_t now() const {
+#ifdef __linux__
+		uint64_t count;
+		if (fd >= 0 && read(fd, &count, sizeof(count)) == sizeof(count)) {
+			return count;
+		}
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+};
+
+struct Result {
+	std::string name;
+	unsigned int batch;
+	double ns; // Per inference
+	double cycles; // Per inference
+	uint32_t macs; // Per inference
+};
+
+struct Options {
+	double min_time_ms = 20; // Per repetition
+	std::string filter; // Substring of the benchmark names to run
+};
+
+// Time fn(), which runs batch inferences, over repetitions of at least min_time_ms. The fastest repetition is the
+// least disturbed by other processes and frequency changes, so it is the most stable between runs
+template<typename F>
+Result measure(const std::string &name, unsigned int batch, uint32_t macs, const Options &options, const CycleCounter &counter, F fn) {
+	// Calibrate the number of calls of one repetition, which also warms up the caches
+	unsigned long calls = 1;
+	for (;;) {
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned long i = 0; i < calls; i++) {
+			fn();
+		}
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= options.min_time_ms / 4) {
+			calls = std::max(1ul, (unsigned long)(calls * options.min_time_ms / elapsed));
+			break;
+		}
+		calls *= 4;
+	}
+
+	std::vector<std::pair<double, double>> runs;
+	for (unsigned int r = 0; r < repetitions; r++) {
+		auto start = std::chrono::steady_clock::now();
+		uint64_t cycles_start = counter.now();
+		for (unsigned long i = 0; i < calls; i++) {
+			fn();
+		}
+		uint64_t cycles = counter.now() - cycles_start;
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		runs.emplace_back(ns / (calls * batch), (double)cycles / (calls * batch));
+	}
+	std::sort(runs.begin(), runs.end());
+
+	return Result{name, batch, runs[0].first, runs[0].second, macs};
+}
+
+// Layers of one variant: max_pooling1d -> conv1d -> flatten -> dense like the generated model, with the kernel
+// arrays of its weight files
+template<typename ConvLayer, typename DenseLayer>
+struct Variant {
+	typedef max_pooling1d_6_t pool_type; // The pooling of the input is the same in every variant
+	typedef ConvDense<ConvLayer, DenseLayer> fused_type;
+	typedef ConvDenseNonzero<ConvLayer, DenseLayer> nonzero_type;
+
+	const char *pool_name;
+	const char *conv_name;
+	const char *dense_name;
+	const typename ConvLayer::kernel_type &conv_kernel;
+	const typename ConvLayer::bias_type &conv_bias;
+	const typename DenseLayer::kernel_type &dense_kernel;
+	const typename DenseLayer::bias_type &dense_bias;
+};
+
+// Same layer sequence as cnn_r() for one sample and cnn_batch() for more
+template<typename ConvLayer, typename DenseLayer>
+struct Pipeline {
+	typedef Variant<ConvLayer, DenseLayer> variant_type;
+
+	typename variant_type::pool_type::output_type pooled[MODEL_BATCH_SIZE];
+	typename ConvLayer::output_type conv[MODEL_BATCH_SIZE];
+
+	void run(const variant_type &v, unsigned int batch, const number_t input[][MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[][MODEL_OUTPUT_SAMPLES]) {
+		if (batch == 1) {
+			variant_type::pool_type::forward(input[0], pooled[0]);
+#if MODEL_FUSED_CONV_DENSE
+			variant_type::fused_type::forward(pooled[0], v.conv_kernel, v.conv_bias, v.dense_kernel, v.dense_bias, output[0]);
+#else
+			ConvLayer::forward(pooled[0], v.conv_kernel, v.conv_bias, conv[0]);
+			DenseLayer::forward((const number_t *)conv[0], v.dense_kernel, v.dense_bias, output[0]);
+#endif
+			return;
+		}
+
+		for (unsigned int step; batch > 0; batch -= step, input += step, output += step) {
+			step = batch < MODEL_BATCH_SIZE ? batch : MODEL_BATCH_SIZE;
+			for (unsigned int b = 0; b < step; b++) {
+				variant_type::pool_type::forward(input[b], pooled[b]);
+			}
+			ConvLayer::forward_batch(step, pooled, v.conv_kernel, v.conv_bias, conv);
+			DenseLayer::forward_batch(step, (const typename DenseLayer::input_type *)conv, v.dense_kernel, v.dense_bias, output);
+		}
+	}
+};
+
+// Benchmark inputs, random Q7.9 values in [-1, 1)
+static number_t inputs[max_batch][MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES];
+static number_t outputs[max_batch][MODEL_OUTPUT_SAMPLES];
+
+static void fillInputs() {
+	uint32_t seed = 12345;
+	for (auto &sample : inputs) {
+		for (auto &channel : sample) {
+			for (auto &x : channel) {
+				seed = seed * 1664525 + 1013904223;
+				x = (number_t)((int32_t)(seed >> 16) % (2 << FIXED_POINT) - (1 << FIXED_POINT));
+			}
+		}
+	}
+}
+
+// Measure and print one benchmark unless it is filtered out
+static void runBenchmark(const std::string &name, unsigned int batch, uint32_t macs, const Options &options, const CycleCounter &counter,
+                         std::vector<Result> &results, const std::function<void()> &fn) {
+	if (name.find(options.filter) == std::string::npos) {
+		return;
+	}
+	results.push_back(measure(name, batch, macs, options, counter, fn));
+	const Result &r = results.back();
+	std::cout << name << " batch " << batch << ": " << r.ns << " ns/inference";
+	if (r.cycles > 0 && r.macs > 0) {
+		std::cout << ", " << r.macs / r.cycles << " MACs/" << (strcmp(counter.source(), "perf") ? "TSC tick" : "cycle");
+	}
+	std::cout << ", " << 1e9 / r.ns << " inferences/s" << std::endl;
+}
+
+template<typename ConvLayer, typename DenseLayer>
+void benchVariant(const Variant<ConvLayer, DenseLayer> &v, const Options &options, const CycleCounter &counter, std::vector<Result> &results) {
+	typedef Variant<ConvLayer, DenseLayer> variant_type;
+	typedef typename variant_type::pool_type pool_type;
+	typedef typename variant_type::fused_type fused_type;
+	typedef typename variant_type::nonzero_type nonzero_type;
+
+	static typename pool_type::output_type pooled[max_batch];
+	static typename ConvLayer::output_type conv[max_batch];
+	static Pipeline<ConvLayer, DenseLayer> pipeline;
+
+	for (unsigned int b = 0; b < max_batch; b++) {
+		pool_type::forward(inputs[b], pooled[b]);
+	}
+	ConvLayer::forward_batch(max_batch, pooled, v.conv_kernel, v.conv_bias, conv);
+	const typename DenseLayer::input_type *flat = (const typename DenseLayer::input_type *)conv;
+
+	std::string fused_name = std::string(v.conv_name) + "+" + v.dense_name;
+	std::string model_name = std::string("cnn/") + v.conv_name;
+
+	auto run = [&](const std::string &name, unsigned int batch, uint32_t macs, const std::function<void()> &fn) {
+		runBenchmark(name, batch, macs, options, counter, results, fn);
+	};
+
+	for (unsigned int batch : batch_sizes) {
+		run(v.pool_name, batch, pool_type::MACs, [&]() {
+			for (unsigned int b = 0; b < batch; b++) {
+				pool_type::forward(inputs[b], pooled[b]);
+			}
+		});
+
+		run(v.conv_name, batch, ConvLayer::MACs, [&]() {
+			if (batch == 1) {
+				ConvLayer::forward(pooled[0], v.conv_kernel, v.conv_bias, conv[0]);
+			} else {
+				ConvLayer::forward_batch(batch, pooled, v.conv_kernel, v.conv_bias, conv);
+			}
+		});
+
+		run(v.dense_name, batch, DenseLayer::MACs, [&]() {
+			if (batch == 1) {
+				DenseLayer::forward(flat[0], v.dense_kernel, v.dense_bias, outputs[0]);
+			} else {
+				DenseLayer::forward_batch(batch, flat, v.dense_kernel, v.dense_bias, outputs);
+			}
+		});
+
+		run(fused_name, batch, fused_type::MACs, [&]() {
+			for (unsigned int b = 0; b < batch; b++) {
+				fused_type::forward(pooled[b], v.conv_kernel, v.conv_bias, v.dense_kernel, v.dense_bias, outputs[b]);
+			}
+		});
+
+		run(fused_name + "/nonzero", batch, nonzero_type::MACs, [&]() {
+			for (unsigned int b = 0; b < batch; b++) {
+				nonzero_type::forward(pooled[b], v.conv_kernel, v.conv_bias, v.dense_kernel, v.dense_bias, outputs[b]);
+			}
+		});
+
+		run(model_name, batch, fused_type::MACs, [&]() {
+			pipeline.run(v, batch, inputs, outputs);
+		});
+	}
+}
+
+#if MODEL_INT8_CALIBRATED
+// int8 model of model_int8.c, one sample at a time like on the MCU, once main --calibrate has written its weights
+static void benchInt8(const Options &options, const CycleCounter &counter, std::vector<Result> &results) {
+	static cnn_int8_activations_t activations;
+	runBenchmark("cnn_int8/conv1d_6", 1, conv1d_6_dense_4_int8_t::MACs, options, counter, results, [&]() {
+		cnn_int8_r(inputs[0], outputs[0], &activations);
+	});
+}
+#endif
+
+static bool writeJSON(const char *filename, const char *cycle_source, const std::vector<Result> &results) {
+	std::ofstream out(filename);
+	out.precision(10);
+	out << "{\n  \"cycle_source\": \"" << cycle_source << "\",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result &r = results[i];
+		out << "    {\"name\": \"" << r.name << "\", \"batch\": " << r.batch << ", \"ns_per_inference\": " << r.ns
+		    << ", \"cycles_per_inference\": " << r.cycles << ", \"macs\": " << r.macs
+		    << ", \"macs_per_cycle\": " << (r.cycles > 0 ? r.macs / r.cycles : 0)
+		    << ", \"inferences_per_s\": " << 1e9 / r.ns << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+	return out.good();
+}
+
+// Only reads the files written by writeJSON(): one result object per line, then the closing "  ]" and "}". A file
+// without results or cut short is an error, so that a broken baseline cannot pass the regression gate
+static bool readJSON(const char *filename, std::vector<Result> &results) {
+	std::ifstream in(filename);
+	if (!in) {
+		std::cerr << "Error opening \"" << filename << "\": " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	auto number = [](const std::string &line, const char *key) {
+		size_t pos = line.find(std::string("\"") + key + "\": ");
+		return pos == std::string::npos ? 0 : std::strtod(line.c_str() + pos + strlen(key) + 4, NULL);
+	};
+
+	std::string line, previous;
+	bool closed = false; // The last two lines read end the results array and the object
+	while (std::getline(in, line)) {
+		if (!line.empty()) {
+			closed = previous == "  ]" && line == "}";
+			previous = line;
+		}
+		size_t name = line.find("\"name\": \"");
+		if (name == std::string::npos) {
+			continue;
+		}
+		name += 9;
+		Result r;
+		r.name = line.substr(name, line.find('"', name) - name);
+		r.batch = (unsigned int)number(line, "batch");
+		r.ns = number(line, "ns_per_inference");
+		r.cycles = number(line, "cycles_per_inference");
+		r.macs = (uint32_t)number(line, "macs");
+		if (r.ns <= 0) {
+			std::cerr << "Error reading \"" << filename << "\": no time for " << r.name << std::endl;
+			return false;
+		}
+		results.push_back(r);
+	}
+	if (!closed) {
+		std::cerr << "Error reading \"" << filename << "\": truncated, no closing ] and }" << std::endl;
+		return false;
+	}
+	if (results.empty()) {
+		std::cerr << "Error reading \"" << filename << "\": no results" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Fail when a benchmark of the baseline is slower by more than threshold percent, or missing
+static int compare(const std::vector<Result> &baseline, const std::vector<Result> &current, double threshold) {
+	unsigned int regressions = 0;
+	for (const Result &base : baseline) {
+		auto it = std::find_if(current.begin(), current.end(), [&](const Result &r) {
+			return r.name == base.name && r.batch == base.batch;
+		});
+		if (it == current.end()) {
+			std::cerr << base.name << " batch " << base.batch << ": missing" << std::endl;
+			regressions++;
+			continue;
+		}
+
+		double change = (it->ns - base.ns) / base.ns * 100;
+		bool regressed = change > threshold;
+		regressions += regressed;
+		std::cout << (regressed ? "REGRESSION " : "") << base.name << " batch " << base.batch << ": " << base.ns << " -> "
+		          << it->ns << " ns/inference (" << (change >= 0 ? "+" : "") << change << "%)" << std::endl;
+	}
+
+	if (regressions > 0) {
+		std::cerr << regressions << " benchmarks regressed by more than " << threshold << "%" << std::endl;
+		return 1;
+	}
+	std::cerr << "No regression above " << threshold << "%" << std::endl;
+	return 0;
+}
+
+// cnn() and cnn_batch() of model.c against the pipeline used for the other variants, so that the end-to-end
+// numbers of every variant measure the same sequence of kernels
+static bool checkPipeline(const Variant<conv1d_6_t, dense_4_t> &v) {
+	static Pipeline<conv1d_6_t, dense_4_t> pipeline;
+	static cnn_batch_activations_t activations;
+	number_t expected[max_batch][MODEL_OUTPUT_SAMPLES];
+
+	cnn_batch(max_batch, inputs, expected, &activations);
+	pipeline.run(v, max_batch, inputs, outputs);
+	for (unsigned int b = 0; b < max_batch; b++) {
+		number_t single[1][MODEL_OUTPUT_SAMPLES];
+		pipeline.run(v, 1, &inputs[b], single);
+		cnn(inputs[b], expected[b]);
+		if (memcmp(single[0], expected[b], sizeof(single[0])) || memcmp(outputs[b], expected[b], sizeof(outputs[b]))) {
+			std::cerr << "Error: the benchmark pipeline differs from cnn() on sample " << b << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, const char *argv[]) {
+	Options options;
+	const char *json = NULL;
+	const char *baseline = NULL;
+	const char *current = NULL;
+	double threshold = 10; // Percent, run-to-run noise of a busy desktop is a few percent
+
+	bool usage = false;
+	for (int i = 1; i < argc && !usage; i++) {
+		bool value = i + 1 < argc;
+		if (!strcmp(argv[i], "--json") && value) {
+			json = argv[++i];
+		} else if (!strcmp(argv[i], "--baseline") && value) {
+			baseline = argv[++i];
+		} else if (!strcmp(argv[i], "--compare") && i + 2 < argc) {
+			baseline = argv[++i];
+			current = argv[++i];
+		} else if (!strcmp(argv[i], "--threshold") && value) {
+			threshold = std::strtod(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "--time") && value) {
+			options.min_time_ms = std::strtod(argv[++i], NULL);
+		} else if (!strcmp(argv[i], "--filter") && value) {
+			options.filter = argv[++i];
+		} else {
+			usage = true;
+		}
+	}
+	if (usage || options.min_time_ms <= 0 || threshold < 0) {
+		std::cerr << "Usage: " << argv[0] << " [--json results.json] [--baseline baseline.json] [--threshold percent] [--time ms] [--filter name]" << std::endl;
+		std::cerr << "       " << argv[0] << " --compare baseline.json results.json [--threshold percent]" << std::endl;
+		return 1;
+	}
+
+	std::vector<Result> base;
+	if (baseline && !readJSON(baseline, base)) {
+		return 1;
+	}
+
+	if (current) {
+		std::vector<Result> results;
+		if (!readJSON(current, results)) {
+			return 1;
+		}
+		return compare(base, results, threshold);
+	}
+
+	fillInputs();
+
+	const Variant<conv1d_6_t, dense_4_t> v6 = {"max_pooling1d_6", "conv1d_6", "dense_4", conv1d_6_kernel, conv1d_6_bias, dense_4_kernel, dense_4_bias};
+	if (!checkPipeline(v6)) {
+		return 1;
+	}
+
+	typedef Conv1D<1, max_pooling1d_6_t::OutputSamples, 64, 8, 1, Activation::ReLU> conv1d_t;
+	typedef Dense<conv1d_t::Filters * conv1d_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_t;
+	typedef Conv1D<1, max_pooling1d_6_t::OutputSamples, 32, 8, 1, Activation::ReLU> conv1d_5_t;
+	typedef Dense<conv1d_5_t::Filters * conv1d_5_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_2_t;
+	const Variant<conv1d_t, dense_t> v0 = {"max_pooling1d", "conv1d", "dense", conv1d_kernel, conv1d_bias, dense_kernel, dense_bias};
+	const Variant<conv1d_5_t, dense_2_t> v5 = {"max_pooling1d_5", "conv1d_5", "dense_2", conv1d_5_kernel, conv1d_5_bias, dense_2_kernel, dense_2_bias};
+
+	CycleCounter counter;
+	std::vector<Result> results;
+	benchVariant(v0, options, counter, results);
+	benchVariant(v5, options, counter, results);
+	benchVariant(v6, options, counter, results);
+#if MODEL_INT8_CALIBRATED
+	benchInt8(options, counter, results);
+#endif
+
+	if (json && !writeJSON(json, counter.source(), results)) {
+		std::cerr << "Error writing \"" << json << "\"" << std::endl;
+		return 1;
+	}
+
+	return baseline ? compare(base, results, threshold) : 0;
+}
@@ -181,3 +181,33 @@ void ADC3101::setup() {
   //writeI2C(13, 0x3E); // 15Hz high-pass Butterworth 1st order 0dB
   writeI2C(13, 0x7F); // 30Hz high-pass Butterworth 1st order 0dB
 }
+
+void ADC3101::powerDown() {
+  if (debug) Serial.println("Power down ADC channels");
+  writeI2C(0x00, 0x00);
+  writeI2C(0x51, 0x02);
+
+  if (debug) Serial.println("Power down NADC and MADC dividers");
+  writeI2C(0x12, 0x01);
+  writeI2C(0x13, 0x02);
+
+  if (debug) Serial.println("Power down MICBIAS");
+  writeI2C(0x00, 0x01);
+  writeI2C(0x33, 0x00);
+
+  writeI2C(0x00, 0x00);
+}
+
+void ADC3101::powerUp() {
+  if (debug) Serial.println("Power up MICBIAS: MICBIAS1 = 3.3V, MICBIAS2 = 3.3V");
+  writeI2C(0x00, 0x01);
+  writeI2C(0x33, 0b01111000);
+
+  if (debug) Serial.println("Power up NADC and MADC dividers: NADC = 1, MADC = 2");
+  writeI2C(0x00, 0x00);
+  writeI2C(0x12, 0x81);
+  writeI2C(0x13, 0x82);
+
+  if (debug) Serial.println("Power up ADC channels");
+  writeI2C(0x51, 0xc2);
+}
@@ -20,6 +20,10 @@ public:
   void writeI2C(int reg, int val = -1);
   int readI2C();
   void setup();
+
+  // Power the ADC channels, their clock dividers and MICBIAS down or back up, the configuration is kept
+  void powerDown();
+  void powerUp();
 };
 
 #endif//_ADC3101_H_
@@ -0,0 +1,73 @@
+#include "activity.h"
+
+// log2(v) in Q8 with a linear fraction, at most 0.09 bit (0.26 dB) below the exact value
+static int32_t log2q8(uint64_t v) {
+  if (v == 0) {
+    return 0;
+  }
+
+  int32_t msb = 63 - __builtin_clzll(v);
+  uint32_t fraction = msb >= 8 ? (uint32_t)(v >> (msb - 8)) & 0xFF : (uint32_t)(v << (8 - msb)) & 0xFF;
+  return msb * 256 + fraction;
+}
+
+ActivityGate::ActivityGate() {
+  reset();
+}
+
+void ActivityGate::reset() {
+  energy = 0;
+  crossings = 0;
+  count = 0;
+  previous = 0;
+  level_db = ACTIVITY_MIN_DB * 256;
+  floor_db = ACTIVITY_MIN_DB * 256; // Rises to the background level, a sound present from the start opens the gate
+  hangover = 0;
+  open = false;
+  frames = 0;
+  active_frames = 0;
+}
+
+void ActivityGate::push(const int16_t *data, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    int16_t x = data[i];
+    energy += (uint32_t)((int32_t)x * x);
+    crossings += (x ^ previous) < 0;
+    previous = x;
+
+    if (++count == ACTIVITY_FRAME_SAMPLES) {
+      endFrame();
+    }
+  }
+}
+
+void ActivityGate::endFrame() {
+  // Mean square relative to full scale (2^30): 10 log10(x) = 3.0103 log2(x), 771 in Q8
+  uint64_t mean_square = energy / ACTIVITY_FRAME_SAMPLES;
+  level_db = mean_square ? ((log2q8(mean_square) - 30 * 256) * 771) >> 8 : -100 * 256;
+
+  bool frame_active = level_db >= floor_db + (open ? ACTIVITY_OFF_DB : ACTIVITY_ON_DB) * 256
+                   && level_db >= ACTIVITY_MIN_DB * 256
+                   && crossings <= ACTIVITY_MAX_CROSSINGS;
+
+  if (frame_active) {
+    open = true;
+    hangover = ACTIVITY_HANGOVER_FRAMES;
+  } else if (open && hangover-- == 0) {
+    open = false;
+  }
+
+  // Noise floor tracked after the decision so that an onset is compared with the floor before it
+  if (level_db < floor_db) {
+    floor_db = level_db;
+  } else {
+    floor_db += (level_db - floor_db) >> ACTIVITY_FLOOR_RISE_SHIFT;
+  }
+
+  frames++;
+  active_frames += open;
+
+  energy = 0;
+  crossings = 0;
+  count = 0;
+}
@@ -0,0 +1,52 @@
+#ifndef _ACTIVITY_H_
+#define _ACTIVITY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Cheap activity detector run on every sample before the model: per frame of ACTIVITY_FRAME_SAMPLES it measures the
+// level in dBFS and the zero-crossing count. A frame is active when its level is above the tracked noise floor by a
+// margin and it does not cross zero as often as hiss does. The gate opens on an active frame above floor + ON, stays
+// open while frames stay above floor + OFF and closes ACTIVITY_HANGOVER_FRAMES frames after the last one.
+#define ACTIVITY_FRAME_SAMPLES 256   // 16 ms at 16 kHz
+#define ACTIVITY_ON_DB 12            // Margin above the noise floor to open the gate
+#define ACTIVITY_OFF_DB 6            // Margin above the noise floor to keep it open
+#define ACTIVITY_MIN_DB -70          // Never open below this level, in dBFS
+#define ACTIVITY_MAX_CROSSINGS 100   // Frames crossing zero more often are noise-like
+#define ACTIVITY_HANGOVER_FRAMES 16  // Frames the gate stays open after the last active frame, 256 ms
+#define ACTIVITY_FLOOR_RISE_SHIFT 7  // The noise floor rises by 1 / 2^shift of the difference per frame, falls at once
+
+class ActivityGate {
+private:
+  // Current frame
+  uint64_t energy;
+  uint16_t crossings;
+  uint16_t count;
+  int16_t previous;
+
+  int32_t level_db; // Level of the last frame, Q8 dBFS
+  int32_t floor_db; // Noise floor, Q8 dBFS
+  uint16_t hangover;
+  bool open;
+  uint32_t frames;
+  uint32_t active_frames;
+
+  void endFrame();
+
+public:
+  ActivityGate();
+
+  void reset();
+
+  // Accumulate samples, the gate is updated at the end of every frame
+  void push(const int16_t *data, size_t count);
+
+  bool active() const { return open; }
+
+  int32_t level() const { return level_db; }      // Q8 dBFS
+  int32_t noiseFloor() const { return floor_db; } // Q8 dBFS
+  uint32_t frameCount() const { return frames; }
+  uint32_t activeFrameCount() const { return active_frames; } // Frames ending with the gate open
+};
+
+#endif//_ACTIVITY_H_
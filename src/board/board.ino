@@ -7,14 +7,99 @@
 
 #include "ADC3101.h"
 #include "gsc_model_fixed.h"
+#include "activity.h"
+#include "mfcc.h"
+#include "scheduler.h"
 
 #define I2S_SAMPLE_RATE 16000  // [16000, 48000] supported by the microphone
 #define I2S_BITS_PER_SAMPLE 16 // I2S wordlength is 16
 
-static number_t inputs[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES]; // 1-channel, 16000 samples for 16kHz over 1s
-static volatile size_t sample_i = 0; // Index for inputs array samples dimension
+#ifndef MFCC_FRONTEND
+#define MFCC_FRONTEND 1 // 1: classify 1 s clips from their MFCC like in training, 0: raw PCM sliding windows
+#endif
+
+#ifndef MODEL_INT8
+#define MODEL_INT8 0 // 1: run cnn_int8() with the calibrated int8 weights, half the weight flash of cnn()
+#endif
+
+// Flash address of a model blob written by main --export-model and programmed apart from the firmware, so that
+// retrained weights need no rebuild. Read in place; the compiled-in weights are used when no valid blob is found there
+//#define MODEL_BLOB_ADDRESS 0x080F0000 // Last 64 KB of the STM32L476RG
+#ifndef MODEL_BLOB_SIZE
+#define MODEL_BLOB_SIZE 0x10000 // Bytes reserved for the blob at MODEL_BLOB_ADDRESS
+#endif
+
+#if defined(MODEL_BLOB_ADDRESS) && MODEL_INT8
+#error "A model blob holds int16 weights, build without MODEL_INT8"
+#endif
+
+#if MODEL_INT8 && !MODEL_INT8_CALIBRATED
+#error "No int8 weights: run main --calibrate trainX.csv on the training set, then regenerate gsc_model_fixed.h"
+#endif
+
+#ifndef ACTIVITY_GATE
+#define ACTIVITY_GATE 1 // 1: only run the model on windows (clips) where the activity gate is open
+#endif
+
+#define CAPTURE_BUFFERS 2 // Ping-pong, the I2S callback fills one buffer while loop() processes the other
+#define CAPTURE_FRAMES (I2S_BUFFER_SIZE / 4) // Stereo 16-bit frames per buffer
+
+// Interleaved I2S data handed whole from the I2S callback to loop()
+static int16_t capture[CAPTURE_BUFFERS][CAPTURE_FRAMES * 2];
+static volatile uint32_t capture_frames[CAPTURE_BUFFERS];
+static volatile bool capture_gap[CAPTURE_BUFFERS]; // Data was discarded just before this buffer
+static volatile uint32_t capture_head = 0; // Buffers filled by the I2S callback
+static volatile uint32_t capture_tail = 0; // Buffers released by loop()
+static volatile uint32_t capture_overruns = 0; // Buffers discarded by the I2S callback while loop() held all of them
+
+#define RING_SIZE 512 // Power of two, holds a window plus a capture buffer
+
+static_assert(RING_SIZE >= MODEL_INPUT_SAMPLES + CAPTURE_FRAMES, "A capture buffer would overwrite the current window");
+static_assert(MODEL_INPUT_CHANNELS == 1, "Windows are read in place from the ring of the first channel");
+
+// First channel written by loop(), the first MODEL_INPUT_SAMPLES - 1 samples are mirrored past the end so that every
+// window is contiguous and cnn() reads it in place
+static number_t ring[RING_SIZE + MODEL_INPUT_SAMPLES - 1];
+static uint32_t ring_head = 0; // Total number of samples written, wraps around
+
 static number_t outputs[MODEL_OUTPUT_SAMPLES];
-static volatile boolean ready_for_inference = false; // Set to true when sample_i reaches the end of the inputs array
+
+#ifdef MODEL_BLOB_ADDRESS
+static model_blob_t blob; // Weights of the blob in flash when blob_valid
+static bool blob_valid = false;
+static cnn_activations_t blob_activations;
+#endif
+
+static ActivityGate gate; // Fed with every sample written to the ring
+static uint32_t windows_inferred = 0; // Windows (clips with MFCC_FRONTEND) given to the model
+static uint32_t windows_skipped = 0; // Windows (clips) skipped while the gate was closed
+
+#if MFCC_FRONTEND
+#define CLIP_SAMPLES MFCC_SAMPLE_RATE // 1 s clips, the length of the training clips
+
+static number_t inputs[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES]; // MFCC of the last clip
+static MFCC mfcc; // Frames are computed as soon as loop() writes their samples to the ring
+static uint32_t clip_samples = 0; // Samples of the current clip pushed so far
+static uint32_t clip_tail = 0; // ring_head value up to which samples were pushed to mfcc
+static bool clip_active = false; // Activity gate open at some point during the clip
+static bool clip_inferred = false; // The model ran on the last clip, counted by the scheduler when it leaves Infer
+
+#ifndef DUTY_CYCLE_PERIOD_MS
+#define DUTY_CYCLE_PERIOD_MS 2560 // Start of a clip to the start of the next one, 0 listens continuously
+#endif
+#define CODEC_SETTLE_MS 50 // ADC power-up and 30 Hz high-pass filter settling after ADC3101::powerUp()
+#define LISTEN_HCLK 16000000 // Enough for the I2S callback and the MFCC frames
+#define INFERENCE_HCLK 80000000
+
+static DutyCycleScheduler scheduler(DUTY_CYCLE_PERIOD_MS, CODEC_SETTLE_MS);
+static uint32_t stopped_ms = 0; // Time spent in STOP mode, where SysTick and thus millis() do not run
+#else
+static uint32_t window_end = MODEL_INPUT_SAMPLES; // ring_head value at which the next window is complete
+static cnn_stream_t stream; // Pooled and conv columns of the previous window
+#if ACTIVITY_GATE
+static bool stream_stale = false; // Windows were skipped since the last cnn_stream() call
+#endif
+#endif
 
 // Nucleo-L476RG I2C3 on A5/A4
 extern const stm32l4_i2c_pins_t g_Wire1Pins = { 0x0420, 0x0421 };
@@ -35,27 +120,78 @@ I2SClass I2S(&_SAI, g_SAIInstance, &g_SAIPins, STM32L4_SAI_IRQ_PRIORITY, g_SAIMo
 // ADC3101 on I2C3
 ADC3101 adc3101(Wire1);
 
-void processI2SData(uint8_t *data, size_t size) {
-  int16_t *data16 = (int16_t *)data;
-
-  // Copy first channel into model inputs
-  for (size_t i = 0; i < size / 4 && sample_i + i < MODEL_INPUT_SAMPLES; i++, sample_i++) {
-    inputs[0][sample_i] = data16[i * 2];
+// Copy ring positions [begin, end) past the end of the ring if they are the start of a window
+static void mirrorRing(uint32_t begin, uint32_t end) {
+  if (end > MODEL_INPUT_SAMPLES - 1) {
+    end = MODEL_INPUT_SAMPLES - 1;
   }
-
-  if (sample_i >= MODEL_INPUT_SAMPLES) {
-    ready_for_inference = true;
+  if (begin < end) {
+    memcpy(&ring[RING_SIZE + begin], &ring[begin], (end - begin) * sizeof(number_t));
   }
 }
 
+// Append the first channel of a capture buffer to the ring, called from loop() and vectorized
+void processI2SData(const int16_t *data, size_t frames) {
+  uint32_t offset = ring_head % RING_SIZE;
+  uint32_t first = frames < RING_SIZE - offset ? frames : RING_SIZE - offset;
+
+  // PCM samples are used as is: number_t is 16-bit like the I2S words
+  mac_deinterleave(data, &ring[offset], first);
+  mac_deinterleave(data + 2 * first, ring, frames - first);
+  mirrorRing(offset, offset + first);
+  mirrorRing(0, frames - first);
+
+#if ACTIVITY_GATE
+  // Energy and zero crossings while the samples are in cache
+  gate.push(&ring[offset], first);
+  gate.push(ring, frames - first);
+#endif
+
+  ring_head += frames;
+}
+
+// Hand the data to loop() in the next free buffer, nothing else is done in the interrupt
 void onI2SReceive() {
-  static uint8_t data[I2S_BUFFER_SIZE];
   size_t size = I2S.available();
 
+  if (size > sizeof(capture[0])) {
+    size = sizeof(capture[0]);
+  }
+
+  static bool gap = false;
+
   if (size > 0) {
-    I2S.read(data, size);
-    processI2SData(data, size);
+    if (capture_head - capture_tail >= CAPTURE_BUFFERS) {
+      static uint8_t discard[sizeof(capture[0])];
+      I2S.read(discard, size);
+      capture_overruns++;
+      gap = true;
+      return;
+    }
+
+    uint32_t index = capture_head % CAPTURE_BUFFERS;
+    I2S.read((uint8_t *)capture[index], size);
+    capture_frames[index] = size / 4;
+    capture_gap[index] = gap;
+    gap = false;
+    capture_head++;
+  }
+
+  // loop() may be waiting for this buffer in sleep mode
+  STM32L4.wakeup();
+}
+
+// Start I2S with MCLK enabled, also after each STOP mode of the duty cycle
+static void startCapture() {
+  if (!I2S.begin(I2S_PHILIPS_MODE, I2S_SAMPLE_RATE, I2S_BITS_PER_SAMPLE, true)) {
+    Serial.println("Failed to initialize I2S!");
+    while (1); // do nothing
   }
+
+  I2S.onReceive(onI2SReceive);
+
+  // Trigger a read to start DMA
+  I2S.peek();
 }
 
 void setup() {
@@ -79,23 +215,298 @@ void setup() {
 
   delay(500);
 
-  // start I2S, MCLK enabled
-  if (!I2S.begin(I2S_PHILIPS_MODE, I2S_SAMPLE_RATE, I2S_BITS_PER_SAMPLE, true)) {
-    Serial.println("Failed to initialize I2S!");
-    while (1); // do nothing
-  }
+#ifdef MODEL_BLOB_ADDRESS
+  static char msg[64];
+  const char *blob_error = model_blob_open((const void *)MODEL_BLOB_ADDRESS, MODEL_BLOB_SIZE, &blob);
+  blob_valid = blob_error == NULL;
+  snprintf(msg, sizeof(msg), "model,%s", blob_valid ? blob.header->name : blob_error);
+  Serial.println(msg);
+#endif
 
-  I2S.onReceive(onI2SReceive);
+#if MFCC_FRONTEND
+  STM32L4.setClocks(LISTEN_HCLK);
+#if MODEL_PROFILE
+  profile_init();
+  model_profile_reset();
+#endif
+#if MODEL_ACTIVATION_SPARSE
+  model_density_reset();
+#endif
+#else
+  cnn_stream_reset(&stream);
+#endif
+
+  startCapture();
+
+#if MFCC_FRONTEND
+  scheduler.start(millis());
+#endif
 
-  // Trigger a read to start DMA
-  I2S.peek();
-  
   //Serial.println("Initializing DONE");
 }
 
+// Whole-window inference into outputs, on the weights of the blob in flash when there is a valid one
+static void predict(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES]) {
+#if MODEL_INT8
+  cnn_int8(input, outputs);
+#else
+#ifdef MODEL_BLOB_ADDRESS
+  if (blob_valid) {
+    cnn_blob_r(&blob, input, outputs, &blob_activations);
+    return;
+  }
+#endif
+  cnn(input, outputs);
+#endif
+}
+
+// Get the output class, print it with the inference time since t_start, the dropped capture buffers and the gate
+// counters
+static void report(long long t_start) {
+  // Get output class
+  unsigned int label = 0;
+  number_t max_val = outputs[0];
+  for (unsigned int i = 1; i < MODEL_OUTPUT_SAMPLES; i++) {
+    if (max_val < outputs[i]) {
+      max_val = outputs[i];
+      label = i;
+    }
+  }
+
+  static char msg[64];
+  snprintf(msg, sizeof(msg), "%d,%d,%d,%lu,%lu,%lu", label, max_val, (int)(millis() - t_start), (unsigned long)capture_overruns,
+      (unsigned long)windows_inferred, (unsigned long)windows_skipped);
+  Serial.println(msg);
+
+  // Turn LED off after prediction has been sent
+  digitalWrite(PIN_LED, LOW);
+}
+
+#if MFCC_FRONTEND
+// Start a new clip from the next sample written to the ring
+static void resetClip() {
+  clip_samples = 0;
+  clip_tail = ring_head;
+  clip_active = gate.active();
+  mfcc.reset();
+}
+#endif
+
+// Append the next captured buffer to the ring, false if none is pending
+static bool drainCapture() {
+  if (capture_tail == capture_head) {
+    return false;
+  }
+
+  uint32_t index = capture_tail % CAPTURE_BUFFERS;
+
+  // Samples are missing before this buffer, restart from an empty clip or a full window
+  if (capture_gap[index]) {
+#if MFCC_FRONTEND
+    resetClip();
+#else
+    window_end = ring_head + MODEL_INPUT_SAMPLES;
+    cnn_stream_reset(&stream);
+#endif
+  }
+
+  processI2SData(capture[index], capture_frames[index]);
+
+  // Release the buffer, capture continues into it during the inferences
+  capture_tail++;
+  return true;
+}
+
+#if MFCC_FRONTEND
+// Push the new samples up to the end of the clip, one contiguous piece of the ring at a time
+static void pushClip() {
+  while (clip_tail != ring_head && clip_samples < CLIP_SAMPLES) {
+    uint32_t offset = clip_tail % RING_SIZE;
+    uint32_t count = ring_head - clip_tail;
+    if (count > RING_SIZE - offset) {
+      count = RING_SIZE - offset;
+    }
+    if (count > CLIP_SAMPLES - clip_samples) {
+      count = CLIP_SAMPLES - clip_samples;
+    }
+
+    mfcc.push(&ring[offset], count);
+
+    clip_tail += count;
+    clip_samples += count;
+    clip_active |= gate.active();
+  }
+}
+
+// Classify the complete clip at the boosted clock, the samples after it start the next clip. Returns false when the
+// activity gate skipped it
+static bool classifyClip() {
+#if ACTIVITY_GATE
+  if (!clip_active) {
+    windows_skipped++;
+    resetClip();
+    return false;
+  }
+#endif
+
+  STM32L4.setClocks(INFERENCE_HCLK);
+
+  // Turn LED on during preprocessing/prediction
+  digitalWrite(PIN_LED, HIGH);
+
+  // Start timer
+  long long t_start = millis();
+
+  // Last frames and DCT, then Q(MFCC_FRACTION_BITS) dB to number_t like the float inputs on the host
+  static int32_t coefficients[MFCC_N_COEFFICIENTS];
+  mfcc.finish(coefficients);
+  for (size_t i = 0; i < MODEL_INPUT_SAMPLES; i++) {
+    inputs[0][i] = clamp_to_number_t(MFCC::toFixed(coefficients[i], FIXED_POINT));
+  }
+
+  // Predict
+  predict(inputs);
+  windows_inferred++;
+
+  report(t_start);
+
+  clip_samples = 0;
+  clip_active = gate.active();
+
+  STM32L4.setClocks(LISTEN_HCLK);
+  return true;
+}
+
+// Power actions when the scheduler changes state
+static void enterState(PowerState previous, PowerState state) {
+  switch (state) {
+    case PowerState::Sleep:
+      I2S.end();
+      adc3101.powerDown();
+      break;
+    case PowerState::Settle:
+      adc3101.powerUp();
+      startCapture();
+      break;
+    case PowerState::Listen:
+      if (previous == PowerState::Settle) {
+        resetClip();
+      }
+      break;
+    case PowerState::Infer:
+      break;
+  }
+}
+
+// Energy counters, sent when 'e' is received: sleep, settle, listen and inference ms, inferences, wake-ups
+static void printEnergy(uint32_t now) {
+  const EnergyCounters &energy = scheduler.energy(now);
+
+  static char msg[80];
+  snprintf(msg, sizeof(msg), "energy,%lu,%lu,%lu,%lu,%lu,%lu", (unsigned long)energy.sleep_ms, (unsigned long)energy.settle_ms,
+      (unsigned long)energy.listen_ms, (unsigned long)energy.infer_ms, (unsigned long)energy.inferences, (unsigned long)energy.wakeups);
+  Serial.println(msg);
+}
+
+#if MODEL_PROFILE
+// Per-layer cycles of the inferences since the last dump, sent when 'p' is received
+static void printProfile() {
+  static char msg[128];
+  for (unsigned int i = 0; i < MODEL_PROFILE_LAYERS; i++) {
+    profile_format(msg, sizeof(msg), &model_profile[i]);
+    Serial.println(msg);
+  }
+  model_profile_reset();
+}
+#endif
+
+#if MODEL_ACTIVATION_SPARSE
+// Nonzero conv1d_6 outputs per inference since the last dump, out of the dense_4 inputs, sent when 'd' is received
+static void printDensity() {
+  static char msg[96];
+  snprintf(msg, sizeof(msg), "density,%lu,%lu,%lu,%lu,%lu", (unsigned long)model_density.inferences, (unsigned long)model_density.min,
+      model_density.inferences ? (unsigned long)(model_density.total / model_density.inferences) : 0UL,
+      (unsigned long)model_density.max, (unsigned long)flatten_2_t::OutputSamples);
+  Serial.println(msg);
+  model_density_reset();
+}
+#endif
+#endif
+
 void loop() {
-  if (ready_for_inference) {
-    // Input buffer full, perform inference
+#if MFCC_FRONTEND
+  uint32_t now = millis() + stopped_ms;
+
+  PowerState previous = scheduler.state();
+  PowerState state = scheduler.update(now, clip_samples == CLIP_SAMPLES, clip_inferred);
+  if (state != previous) {
+    enterState(previous, state);
+  }
+
+  if (Serial.available() > 0) {
+    int command = Serial.read();
+    if (command == 'e') {
+      printEnergy(now);
+    }
+#if MODEL_PROFILE
+    if (command == 'p') {
+      printProfile();
+    }
+#endif
+#if MODEL_ACTIVATION_SPARSE
+    if (command == 'd') {
+      printDensity();
+    }
+#endif
+  }
+
+  switch (state) {
+    case PowerState::Sleep: {
+      // Woken up by the RTC at the next period
+      uint32_t timeout = scheduler.sleepTime(now);
+      if (timeout > 0) {
+        STM32L4.stop(timeout);
+        stopped_ms += timeout;
+      }
+      break;
+    }
+    case PowerState::Settle:
+      // Discard the samples of the codec powering up
+      capture_tail = capture_head;
+      STM32L4.sleep();
+      break;
+    case PowerState::Listen:
+      if (drainCapture()) {
+        pushClip();
+      } else {
+        STM32L4.sleep(); // Until the next I2S buffer
+      }
+      break;
+    case PowerState::Infer:
+      clip_inferred = classifyClip();
+      break;
+  }
+#else
+  if (!drainCapture()) {
+    STM32L4.sleep(); // Until the next I2S buffer
+    return;
+  }
+
+  while ((int32_t)(ring_head - window_end) >= 0) {
+#if ACTIVITY_GATE
+    if (!gate.active()) {
+      windows_skipped++;
+      stream_stale = true;
+      window_end += MODEL_STREAM_HOP;
+      continue;
+    }
+    if (stream_stale) {
+      cnn_stream_reset(&stream); // The next window is computed in full
+      stream_stale = false;
+    }
+#endif
+
+    // Next window complete, perform inference
 
     // Turn LED on during preprocessing/prediction
     digitalWrite(PIN_LED, HIGH);
@@ -103,30 +514,31 @@ void loop() {
     // Start timer
     long long t_start = millis();
 
+    // Window read in place, contiguous thanks to the mirrored start of the ring
+    const number_t (*window)[MODEL_INPUT_SAMPLES] = (const number_t (*)[MODEL_INPUT_SAMPLES])&ring[(window_end - MODEL_INPUT_SAMPLES) % RING_SIZE];
+
     // Send signed 16-bit PCM little endian 1 channel
-    //Serial.write((uint8_t*)inputs[0], MODEL_INPUT_SAMPLES*2);
-
-    // Predict
-    cnn(inputs, outputs);
-
-    // Get output class
-    unsigned int label = 0;
-    number_t max_val = outputs[0];
-    for (unsigned int i = 1; i < MODEL_OUTPUT_SAMPLES; i++) {
-      if (max_val < outputs[i]) {
-        max_val = outputs[i];
-        label = i;
-      }
-    }
+    //Serial.write((uint8_t*)window[0], MODEL_INPUT_SAMPLES*2);
 
-    static char msg[32];
-    snprintf(msg, sizeof(msg), "%d,%d,%d", label, max_val, (int)(millis() - t_start));
-    Serial.println(msg);
+#if MODEL_INT8 || MODEL_SPARSE_DENSE
+    // Whole window: the int8 model has no streaming variant, and cnn_stream() would keep the dense weights of dense_4
+    // in flash
+    predict(window);
+#else
+#ifdef MODEL_BLOB_ADDRESS
+    // cnn_stream() runs the compiled-in weights
+    if (blob_valid)
+      predict(window);
+    else
+#endif
+    // Predict, only the columns of the last MODEL_STREAM_HOP samples are computed
+    cnn_stream(window, outputs, &stream);
+#endif
+    windows_inferred++;
+
+    report(t_start);
 
-    // Turn LED off after prediction has been sent
-    digitalWrite(PIN_LED, LOW);
-    
-    ready_for_inference = false;
-    sample_i = 0;
+    window_end += MODEL_STREAM_HOP;
   }
+#endif
 }
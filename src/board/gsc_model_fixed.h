@@ -19,6 +19,12 @@
 typedef int16_t number_t;		// Standard size numeric type used for weights and activations
 typedef int32_t long_number_t;	// Long numeric type used for intermediate results
 
+#ifdef __GNUC__
+#define NUMBER_ALIGN __attribute__((aligned(4)))	// Weight arrays start on a word so that kernels can load them as packed pairs
+#else
+#define NUMBER_ALIGN
+#endif
+
 #ifndef min
 static inline long_number_t min(long_number_t a, long_number_t b) {
 	if (a <= b)
@@ -55,150 +61,1372 @@ static inline number_t clamp_to_number_t(long_number_t number) {
 #endif //__NUMBER_H__
 /**
   ******************************************************************************
-  * @file    maxpool.cc
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    24 march 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
+  * @file    mac.h
+  * @brief   Multiply-accumulate and data movement primitives for the fixed-point kernels, vectorized with AVX2, NEON
+  *          or Cortex-M SMLAD when available
   */
 
+#ifndef __MAC_H__
+#define __MAC_H__
+
 #ifndef SINGLE_FILE
 #include "number.h"
 #endif
 
-#define INPUT_CHANNELS  1
-#define INPUT_SAMPLES   100
-#define POOL_SIZE       4
-#define POOL_STRIDE     3
-#define POOL_PAD        0 // Unsupported
-#define POOL_LENGTH	    ( ( (INPUT_SAMPLES - POOL_SIZE + (2*POOL_PAD) ) / POOL_STRIDE ) + 1 )
+// Select the implementation at compile time, define MAC_SCALAR to force the portable reference
+// or MAC_SMLAD_EMULATE to run the Cortex-M dual-MAC path with emulated intrinsics on the host
+#if !defined(MAC_SCALAR) && NUMBER_MIN == -32768 && NUMBER_MAX == 32767
+#if defined(MAC_SMLAD_EMULATE)
+#define MAC_SMLAD
+#elif defined(__AVX2__)
+#define MAC_AVX2
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define MAC_NEON
+#include <arm_neon.h>
+#elif defined(__ARM_FEATURE_DSP)
+#define MAC_SMLAD
+#endif
+#endif
+
+#define MAC_MAX_ROWS 8 // Maximum number of rows handled by one mac_dot_rows() call
+
+#ifdef MAC_SMLAD
+#include <string.h>
+
+// Two consecutive number_t as one word, first element in the bottom half (little-endian packing)
+static inline uint32_t mac_read_q15x2(const number_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v)); // Single LDR, unaligned accesses are allowed on Cortex-M4
+  return v;
+}
+
+#ifdef MAC_SMLAD_EMULATE
+// Bit-exact SMLAD: acc + x.bottom * y.bottom + x.top * y.top, wrapping like the instruction
+static inline long_number_t mac_smlad(uint32_t x, uint32_t y, long_number_t acc) {
+  int32_t bottom = (int32_t)(int16_t)(x & 0xFFFF) * (int16_t)(y & 0xFFFF);
+  int32_t top = (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+  return (long_number_t)((uint32_t)acc + (uint32_t)bottom + (uint32_t)top);
+}
+
+// Bit-exact PKHBT with LSL #16: bottom half of x, bottom half of y in the top half
+static inline uint32_t mac_pkhbt(uint32_t x, uint32_t y) {
+  return (x & 0xFFFF) | (y << 16);
+}
+#else
+// Same instruction as CMSIS __SMLAD() without depending on the CMSIS headers
+static inline long_number_t mac_smlad(uint32_t x, uint32_t y, long_number_t acc) {
+  long_number_t result;
+  __asm__ ("smlad %0, %1, %2, %3" : "=r" (result) : "r" (x), "r" (y), "r" (acc));
+  return result;
+}
+
+static inline uint32_t mac_pkhbt(uint32_t x, uint32_t y) {
+  uint32_t result;
+  __asm__ ("pkhbt %0, %1, %2, lsl #16" : "=r" (result) : "r" (x), "r" (y));
+  return result;
+}
+#endif
+
+#ifdef MAC_SMLAD_EMULATE
+// Bit-exact SXTB16: bytes 0 and 2 of x sign-extended into the bottom and top halves
+static inline uint32_t mac_sxtb16(uint32_t x) {
+  return (uint32_t)(uint16_t)(int16_t)(int8_t)(x & 0xFF) | ((uint32_t)(uint16_t)(int16_t)(int8_t)((x >> 16) & 0xFF) << 16);
+}
+#else
+static inline uint32_t mac_sxtb16(uint32_t x) {
+  uint32_t result;
+  __asm__ ("sxtb16 %0, %1" : "=r" (result) : "r" (x));
+  return result;
+}
+#endif
+
+// Bytes 1 and 3 of x sign-extended, the ROR #8 of SXTB16
+static inline uint32_t mac_sxtb16_ror8(uint32_t x) {
+  return mac_sxtb16((x >> 8) | (x << 24));
+}
+#endif
+
+#ifdef MAC_AVX2
+static inline long_number_t mac_hsum_128(__m128i acc) {
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(acc);
+}
+
+static inline long_number_t mac_hsum_256(__m256i acc) {
+  return mac_hsum_128(_mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+}
+#endif
+
+#ifdef MAC_NEON
+static inline long_number_t mac_hsum_neon(int32x4_t acc) {
+  int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+  return vget_lane_s32(vpadd_s32(sum, sum), 0);
+}
+#endif
+
+// Sum of a[i] * b[i] for i < n, bit-exact with the scalar loop
+static inline long_number_t mac_dot(const number_t *a, const number_t *b, unsigned int n) {
+  unsigned int i = 0;
+  long_number_t acc = 0;
+
+#if defined(MAC_AVX2)
+  __m256i acc256 = _mm256_setzero_si256();
+  for (; i + 16 <= n; i += 16)
+    acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(
+      _mm256_loadu_si256((const __m256i *)(a + i)),
+      _mm256_loadu_si256((const __m256i *)(b + i))));
+  acc = mac_hsum_256(acc256);
+
+  if (i + 8 <= n) {
+    acc += mac_hsum_128(_mm_madd_epi16(
+      _mm_loadu_si128((const __m128i *)(a + i)),
+      _mm_loadu_si128((const __m128i *)(b + i))));
+    i += 8;
+  }
+#elif defined(MAC_NEON)
+  int32x4_t acc128 = vdupq_n_s32(0);
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t va = vld1q_s16(a + i);
+    int16x8_t vb = vld1q_s16(b + i);
+    acc128 = vmlal_s16(acc128, vget_low_s16(va), vget_low_s16(vb));
+    acc128 = vmlal_s16(acc128, vget_high_s16(va), vget_high_s16(vb));
+  }
+  acc = mac_hsum_neon(acc128);
+#elif defined(MAC_SMLAD)
+  for (; i + 4 <= n; i += 4) {
+    acc = mac_smlad(mac_read_q15x2(a + i), mac_read_q15x2(b + i), acc);
+    acc = mac_smlad(mac_read_q15x2(a + i + 2), mac_read_q15x2(b + i + 2), acc);
+  }
+#endif
+
+  for (; i < n; i++)
+    acc = acc + a[i] * b[i];
+  return acc;
+}
+
+// Sum of a[i] * b[i] for i < n on int8 operands, bit-exact with the scalar loop as long as b holds no -128:
+// the AVX2 path moves the sign of a onto b to use the unsigned by signed byte multiply
+static inline int32_t mac_dot_int8(const int8_t *a, const int8_t *b, unsigned int n) {
+  unsigned int i = 0;
+  int32_t acc = 0;
+
+#if defined(MAC_AVX2)
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i acc256 = _mm256_setzero_si256();
+  for (; i + 32 <= n; i += 32) {
+    __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+    // |a| * (b with the sign of a): pairs of products fit in int16 since |b| <= 127
+    __m256i pairs = _mm256_maddubs_epi16(_mm256_sign_epi8(va, va), _mm256_sign_epi8(vb, va));
+    acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(pairs, ones));
+  }
+  acc = mac_hsum_256(acc256);
+
+  // Last 16 then 8 values, the zeroed upper bytes of a 64-bit load add nothing
+  for (unsigned int width = 16; width >= 8; width /= 2) {
+    if (i + width <= n) {
+      __m128i va = width == 16 ? _mm_loadu_si128((const __m128i *)(a + i)) : _mm_loadl_epi64((const __m128i *)(a + i));
+      __m128i vb = width == 16 ? _mm_loadu_si128((const __m128i *)(b + i)) : _mm_loadl_epi64((const __m128i *)(b + i));
+      acc += mac_hsum_128(_mm_madd_epi16(_mm_maddubs_epi16(_mm_sign_epi8(va, va), _mm_sign_epi8(vb, va)), _mm256_castsi256_si128(ones)));
+      i += width;
+    }
+  }
+#elif defined(MAC_NEON)
+  int32x4_t acc128 = vdupq_n_s32(0);
+  for (; i + 16 <= n; i += 16) {
+    int8x16_t va = vld1q_s8(a + i);
+    int8x16_t vb = vld1q_s8(b + i);
+    acc128 = vpadalq_s16(acc128, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+    acc128 = vpadalq_s16(acc128, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+  }
+  acc = mac_hsum_neon(acc128);
+#elif defined(MAC_SMLAD)
+  // One word holds 4 int8, SXTB16 splits it into the even and odd pairs of two SMLAD
+  for (; i + 4 <= n; i += 4) {
+    uint32_t va, vb;
+    memcpy(&va, a + i, sizeof(va));
+    memcpy(&vb, b + i, sizeof(vb));
+    acc = mac_smlad(mac_sxtb16(va), mac_sxtb16(vb), acc);
+    acc = mac_smlad(mac_sxtb16_ror8(va), mac_sxtb16_ror8(vb), acc);
+  }
+#endif
+
+  for (; i < n; i++)
+    acc = acc + a[i] * b[i];
+  return acc;
+}
 
-#define ACTIVATION_LINEAR
+// out[r] = sum of w[i] * rows[r * stride + i] for i < n and r < count <= MAC_MAX_ROWS,
+// each vector of weights is loaded once for all the rows
+static inline void mac_dot_rows(const number_t *w, const number_t *rows, unsigned int stride, unsigned int count, unsigned int n, long_number_t out[]) {
+  unsigned int i = 0, r;
 
-typedef number_t max_pooling1d_6_output_type[INPUT_CHANNELS][POOL_LENGTH];
+#if defined(MAC_AVX2)
+  __m256i acc[MAC_MAX_ROWS];
+  for (r = 0; r < count; r++)
+    acc[r] = _mm256_setzero_si256();
+  for (; i + 16 <= n; i += 16) {
+    __m256i vw = _mm256_loadu_si256((const __m256i *)(w + i));
+    for (r = 0; r < count; r++)
+      acc[r] = _mm256_add_epi32(acc[r], _mm256_madd_epi16(vw, _mm256_loadu_si256((const __m256i *)(rows + r * stride + i))));
+  }
+  for (r = 0; r < count; r++)
+    out[r] = mac_hsum_256(acc[r]);
+#elif defined(MAC_NEON)
+  int32x4_t acc[MAC_MAX_ROWS];
+  for (r = 0; r < count; r++)
+    acc[r] = vdupq_n_s32(0);
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t vw = vld1q_s16(w + i);
+    for (r = 0; r < count; r++) {
+      int16x8_t vr = vld1q_s16(rows + r * stride + i);
+      acc[r] = vmlal_s16(acc[r], vget_low_s16(vw), vget_low_s16(vr));
+      acc[r] = vmlal_s16(acc[r], vget_high_s16(vw), vget_high_s16(vr));
+    }
+  }
+  for (r = 0; r < count; r++)
+    out[r] = mac_hsum_neon(acc[r]);
+#elif defined(MAC_SMLAD)
+  for (r = 0; r < count; r++)
+    out[r] = 0;
+  for (; i + 2 <= n; i += 2) {
+    uint32_t vw = mac_read_q15x2(w + i);
+    for (r = 0; r < count; r++)
+      out[r] = mac_smlad(vw, mac_read_q15x2(rows + r * stride + i), out[r]);
+  }
+#else
+  for (r = 0; r < count; r++)
+    out[r] = 0;
+#endif
 
-static inline void max_pooling1d_6(
-  const number_t input[INPUT_CHANNELS][INPUT_SAMPLES], 	    // IN
-  number_t output[INPUT_CHANNELS][POOL_LENGTH]) {	// OUT
+  for (; i < n; i++)
+    for (r = 0; r < count; r++)
+      out[r] = out[r] + w[i] * rows[r * stride + i];
+}
 
-  unsigned short pos_x, k; 	// loop indexes for output volume
+#ifdef MAC_AVX2
+// Add 8 consecutive outputs of a unit-stride convolution to acc
+static inline __m256i mac_conv1d_block(const number_t *input, const number_t *kernel, unsigned int taps, __m256i acc) {
   unsigned int x;
-  number_t max, tmp; 
-
-  for (k = 0; k < INPUT_CHANNELS; k++) 
-    for (pos_x = 0; pos_x < POOL_LENGTH; pos_x++) {
-#ifdef ACTIVATION_LINEAR
-      max = input[k][pos_x*POOL_STRIDE];
-      x = 1;
-#elif defined(ACTIVATION_RELU)
-      max = 0;
-      x = 0;
-#endif
-      for (; x < POOL_SIZE; x++) {
-        tmp = input[k][(pos_x*POOL_STRIDE)+x]; 
-        if (max < tmp)
-          max = tmp;
-      }
-      output[k][pos_x] = max; 
+  // Interleave samples x + i and x + i + 1 so that madd applies two taps per lane
+  for (x = 0; x + 2 <= taps; x += 2) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(input + x));
+    __m128i b = _mm_loadu_si128((const __m128i *)(input + x + 1));
+    __m256i pairs = _mm256_set_m128i(_mm_unpackhi_epi16(a, b), _mm_unpacklo_epi16(a, b));
+    __m256i w = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)kernel[x] | ((uint32_t)(uint16_t)kernel[x + 1] << 16)));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, w));
+  }
+  if (x < taps) { // Odd number of taps
+    __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(input + x)));
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(v, _mm256_set1_epi32(kernel[x])));
+  }
+  return acc;
+}
+#endif
+
+#ifdef MAC_NEON
+// Add 8 consecutive outputs of a unit-stride convolution to lo and hi
+static inline void mac_conv1d_block(const number_t *input, const number_t *kernel, unsigned int taps, int32x4_t *lo, int32x4_t *hi) {
+  unsigned int x;
+  for (x = 0; x < taps; x++) {
+    int16x8_t v = vld1q_s16(input + x);
+    *lo = vmlal_n_s16(*lo, vget_low_s16(v), kernel[x]);
+    *hi = vmlal_n_s16(*hi, vget_high_s16(v), kernel[x]);
+  }
+}
+#endif
+
+// out[pos] += sum of kernel[x] * input[pos + x] for x < taps and pos < outsamples,
+// input holds outsamples + taps - 1 values, vectorized over blocks of 8 output positions
+static inline void mac_conv1d(const number_t *input, const number_t *kernel, unsigned int taps, unsigned int outsamples, long_number_t out[]) {
+  unsigned int pos = 0, x;
+
+#if defined(MAC_AVX2) || defined(MAC_NEON)
+  long_number_t last[8];
+  unsigned int i;
+
+  for (; pos + 8 <= outsamples; pos += 8) {
+#if defined(MAC_AVX2)
+    __m256i acc = mac_conv1d_block(input + pos, kernel, taps, _mm256_loadu_si256((const __m256i *)(out + pos)));
+    _mm256_storeu_si256((__m256i *)(out + pos), acc);
+#else
+    int32x4_t lo = vld1q_s32(out + pos);
+    int32x4_t hi = vld1q_s32(out + pos + 4);
+    mac_conv1d_block(input + pos, kernel, taps, &lo, &hi);
+    vst1q_s32(out + pos, lo);
+    vst1q_s32(out + pos + 4, hi);
+#endif
+  }
+
+  // Remaining outputs come from one more block ending on the last output, overlapping lanes are dropped
+  if (pos < outsamples && outsamples >= 8) {
+#if defined(MAC_AVX2)
+    _mm256_storeu_si256((__m256i *)last, mac_conv1d_block(input + outsamples - 8, kernel, taps, _mm256_setzero_si256()));
+#else
+    int32x4_t lo = vdupq_n_s32(0);
+    int32x4_t hi = vdupq_n_s32(0);
+    mac_conv1d_block(input + outsamples - 8, kernel, taps, &lo, &hi);
+    vst1q_s32(last, lo);
+    vst1q_s32(last + 4, hi);
+#endif
+    for (i = pos + 8 - outsamples; i < 8; i++)
+      out[outsamples - 8 + i] = out[outsamples - 8 + i] + last[i];
+    pos = outsamples;
+  }
+#elif defined(MAC_SMLAD)
+  // Two outputs at a time share each packed pair of taps
+  for (; pos + 2 <= outsamples; pos += 2) {
+    long_number_t acc0 = out[pos];
+    long_number_t acc1 = out[pos + 1];
+    for (x = 0; x + 2 <= taps; x += 2) {
+      uint32_t w = mac_read_q15x2(kernel + x);
+      acc0 = mac_smlad(mac_read_q15x2(input + pos + x), w, acc0);
+      acc1 = mac_smlad(mac_read_q15x2(input + pos + x + 1), w, acc1);
     }
+    if (x < taps) { // Odd number of taps
+      acc0 = acc0 + input[pos + x] * kernel[x];
+      acc1 = acc1 + input[pos + x + 1] * kernel[x];
+    }
+    out[pos] = acc0;
+    out[pos + 1] = acc1;
+  }
+#endif
+
+  for (x = 0; x < taps; x++)
+    for (unsigned int p = pos; p < outsamples; p++)
+      out[p] = out[p] + input[p + x] * kernel[x];
 }
 
-#undef INPUT_CHANNELS  
-#undef INPUT_SAMPLES
-#undef POOL_SIZE
-#undef POOL_STRIDE
-#undef POOL_PAD
-#undef POOL_LENGTH
-#undef ACTIVATION_LINEAR
+#ifdef MAC_AVX2
+// Add 8 consecutive outputs of a unit-stride int8 convolution to acc, samples widened to the pairs of mac_conv1d_block()
+static inline __m256i mac_conv1d_int8_block(const int8_t *input, const int8_t *kernel, unsigned int taps, __m256i acc) {
+  unsigned int x;
+  for (x = 0; x + 2 <= taps; x += 2) {
+    __m128i a = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)(input + x)));
+    __m128i b = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)(input + x + 1)));
+    __m256i pairs = _mm256_set_m128i(_mm_unpackhi_epi16(a, b), _mm_unpacklo_epi16(a, b));
+    __m256i w = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)kernel[x] | ((uint32_t)(uint16_t)kernel[x + 1] << 16)));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, w));
+  }
+  if (x < taps) { // Odd number of taps
+    __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(input + x)));
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(v, _mm256_set1_epi32(kernel[x])));
+  }
+  return acc;
+}
+#endif
+
+#ifdef MAC_NEON
+// Add 8 consecutive outputs of a unit-stride int8 convolution to lo and hi
+static inline void mac_conv1d_int8_block(const int8_t *input, const int8_t *kernel, unsigned int taps, int32x4_t *lo, int32x4_t *hi) {
+  unsigned int x;
+  for (x = 0; x < taps; x++) {
+    int16x8_t v = vmovl_s8(vld1_s8(input + x));
+    *lo = vmlal_n_s16(*lo, vget_low_s16(v), kernel[x]);
+    *hi = vmlal_n_s16(*hi, vget_high_s16(v), kernel[x]);
+  }
+}
+#endif
+
+// mac_conv1d() on int8 operands: out[pos] += sum of kernel[x] * input[pos + x] for x < taps and pos < outsamples
+static inline void mac_conv1d_int8(const int8_t *input, const int8_t *kernel, unsigned int taps, unsigned int outsamples, int32_t out[]) {
+  unsigned int pos = 0, x;
+
+#if defined(MAC_AVX2) || defined(MAC_NEON)
+  int32_t last[8];
+  unsigned int i;
+
+  for (; pos + 8 <= outsamples; pos += 8) {
+#if defined(MAC_AVX2)
+    __m256i acc = mac_conv1d_int8_block(input + pos, kernel, taps, _mm256_loadu_si256((const __m256i *)(out + pos)));
+    _mm256_storeu_si256((__m256i *)(out + pos), acc);
+#else
+    int32x4_t lo = vld1q_s32(out + pos);
+    int32x4_t hi = vld1q_s32(out + pos + 4);
+    mac_conv1d_int8_block(input + pos, kernel, taps, &lo, &hi);
+    vst1q_s32(out + pos, lo);
+    vst1q_s32(out + pos + 4, hi);
+#endif
+  }
+
+  // Remaining outputs come from one more block ending on the last output, overlapping lanes are dropped
+  if (pos < outsamples && outsamples >= 8) {
+#if defined(MAC_AVX2)
+    _mm256_storeu_si256((__m256i *)last, mac_conv1d_int8_block(input + outsamples - 8, kernel, taps, _mm256_setzero_si256()));
+#else
+    int32x4_t lo = vdupq_n_s32(0);
+    int32x4_t hi = vdupq_n_s32(0);
+    mac_conv1d_int8_block(input + outsamples - 8, kernel, taps, &lo, &hi);
+    vst1q_s32(last, lo);
+    vst1q_s32(last + 4, hi);
+#endif
+    for (i = pos + 8 - outsamples; i < 8; i++)
+      out[outsamples - 8 + i] = out[outsamples - 8 + i] + last[i];
+    pos = outsamples;
+  }
+#elif defined(MAC_SMLAD)
+  // Taps unpacked once into the even and odd pairs of each word, 4 taps per SXTB16 pair of SMLAD
+  uint32_t even[8], odd[8];
+  unsigned int words = taps / 4 < 8 ? taps / 4 : 8;
+  for (x = 0; x < words; x++) {
+    uint32_t w;
+    memcpy(&w, kernel + 4 * x, sizeof(w));
+    even[x] = mac_sxtb16(w);
+    odd[x] = mac_sxtb16_ror8(w);
+  }
+  for (; pos < outsamples; pos++) {
+    int32_t acc = out[pos];
+    for (x = 0; x < words; x++) {
+      uint32_t v;
+      memcpy(&v, input + pos + 4 * x, sizeof(v));
+      acc = mac_smlad(mac_sxtb16(v), even[x], acc);
+      acc = mac_smlad(mac_sxtb16_ror8(v), odd[x], acc);
+    }
+    for (x = 4 * words; x < taps; x++)
+      acc = acc + input[pos + x] * kernel[x];
+    out[pos] = acc;
+  }
+#endif
+
+  for (x = 0; x < taps; x++)
+    for (unsigned int p = pos; p < outsamples; p++)
+      out[p] = out[p] + input[p + x] * kernel[x];
+}
+
+// out[i] = interleaved[2 * i] for i < n: first channel of interleaved stereo samples
+static inline void mac_deinterleave(const number_t *interleaved, number_t *out, unsigned int n) {
+  unsigned int i = 0;
+
+#if defined(MAC_AVX2)
+  const __m256i low_half = _mm256_set1_epi32(0xFFFF);
+  for (; i + 16 <= n; i += 16) {
+    __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(interleaved + 2 * i)), low_half);
+    __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(interleaved + 2 * i + 16)), low_half);
+    // Zero-extended samples are not saturated by packus, which packs within 128-bit lanes
+    _mm256_storeu_si256((__m256i *)(out + i), _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+#elif defined(MAC_NEON)
+  for (; i + 8 <= n; i += 8)
+    vst1q_s16(out + i, vld2q_s16(interleaved + 2 * i).val[0]);
+#elif defined(MAC_SMLAD)
+  // Two samples per store, one PKHBT packs the first channel of two stereo words
+  for (; i + 2 <= n; i += 2) {
+    uint32_t v = mac_pkhbt(mac_read_q15x2(interleaved + 2 * i), mac_read_q15x2(interleaved + 2 * i + 2));
+    memcpy(out + i, &v, sizeof(v));
+  }
+#endif
+
+  for (; i < n; i++)
+    out[i] = interleaved[2 * i];
+}
+
+#endif//__MAC_H__
+
 /**
   ******************************************************************************
-  * @file    conv.cc
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    24 march 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
+  * @file    layers.h
+  * @brief   Header-only fixed-point layer library, shapes and activations are template parameters so that the
+  *          compiler can unroll the kernels and drop the padding and activation branches that do not apply
   */
 
+#ifndef __LAYERS_H__
+#define __LAYERS_H__
+
 #ifndef SINGLE_FILE
 #include "number.h"
+#include "mac.h"
 #endif
 
-#define INPUT_CHANNELS      1
-#define INPUT_SAMPLES       33
-#define CONV_FILTERS        64
-#define CONV_KERNEL_SIZE    8
-#define CONV_STRIDE         1
+enum class Activation {
+  Linear, // Linear (MEANS NONE)
+  ReLU,
+};
+
+template<Activation Act>
+static inline number_t activate(long_number_t acc) {
+  if (Act == Activation::ReLU && acc < 0)
+    return 0;
+  return clamp_to_number_t(acc);
+}
+
+template<unsigned int Channels, unsigned int InSamples, unsigned int PoolSize, unsigned int PoolStride, Activation Act = Activation::Linear>
+struct MaxPool1D {
+  static constexpr unsigned int InputChannels = Channels;
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Size = PoolSize;
+  static constexpr unsigned int Stride = PoolStride;
+  static constexpr unsigned int OutputSamples = (InSamples - PoolSize) / PoolStride + 1; // POOL_PAD unsupported
+  static constexpr uint32_t MACs = 0; // Comparisons only
+  static constexpr Activation OutputActivation = Act;
+
+  typedef number_t input_type[Channels][InSamples];
+  typedef number_t output_type[Channels][OutputSamples];
+
+  static inline void forward(const input_type input, output_type output) {
+    forward_columns(input, output, 0, OutputSamples);
+  }
 
-#define ZEROPADDING_LEFT    0
-#define ZEROPADDING_RIGHT   0
+  // Outputs [first, first + count) only, for sliding windows that keep their older columns
+  static inline void forward_columns(const input_type input, output_type output, unsigned int first, unsigned int count) {
+    for (unsigned int k = 0; k < Channels; k++)
+      for (unsigned int pos_x = first; pos_x < first + count; pos_x++) {
+        // ReLU starts from 0 so that negative maxima are clipped
+        number_t max = Act == Activation::ReLU ? 0 : input[k][pos_x * PoolStride];
+        for (unsigned int x = Act == Activation::ReLU ? 0 : 1; x < PoolSize; x++) {
+          number_t tmp = input[k][pos_x * PoolStride + x];
+          if (max < tmp)
+            max = tmp;
+        }
+        output[k][pos_x] = max;
+      }
+  }
+};
+
+template<unsigned int InChannels, unsigned int InSamples, unsigned int ConvFilters, unsigned int KernelSize, unsigned int ConvStride, Activation Act,
+         unsigned int ZeroPaddingLeft = 0, unsigned int ZeroPaddingRight = 0>
+struct Conv1D {
+  static constexpr unsigned int InputChannels = InChannels;
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Filters = ConvFilters;
+  static constexpr unsigned int Size = KernelSize;
+  static constexpr unsigned int Stride = ConvStride;
+  static constexpr unsigned int PaddingLeft = ZeroPaddingLeft;
+  static constexpr unsigned int PaddingRight = ZeroPaddingRight;
+  static constexpr unsigned int OutputSamples = (InSamples - KernelSize + ZeroPaddingLeft + ZeroPaddingRight) / ConvStride + 1;
+  static constexpr uint32_t MACs = ConvFilters * OutputSamples * InChannels * KernelSize; // Padding included
+  static constexpr Activation OutputActivation = Act;
+
+  typedef number_t input_type[InChannels][InSamples];
+  typedef number_t kernel_type[ConvFilters][InChannels][KernelSize];
+  typedef number_t bias_type[ConvFilters];
+  typedef number_t output_type[ConvFilters][OutputSamples];
+
+  // Activated outputs of one filter
+  static inline void forward_row(const input_type input, const number_t kernel[InChannels][KernelSize], number_t bias, number_t output[OutputSamples]) {
+    long_number_t output_acc[OutputSamples];
+
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output_acc[pos_x] = 0;
 
-#define CONV_OUTSAMPLES     ( ( (INPUT_SAMPLES - CONV_KERNEL_SIZE + ZEROPADDING_LEFT + ZEROPADDING_RIGHT) / CONV_STRIDE ) + 1 )
+    for (unsigned int z = 0; z < InChannels; z++) {
+      if (ZeroPaddingLeft == 0 && ZeroPaddingRight == 0 && ConvStride == 1) {
+        // Windows never leave the input, accumulate the whole row with the vectorized primitive
+        mac_conv1d(input[z], kernel[z], KernelSize, OutputSamples, output_acc);
+      } else {
+        for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+          for (unsigned int x = 0; x < KernelSize; x++) {
+            int input_x = (int)(pos_x * ConvStride + x) - (int)ZeroPaddingLeft;
+            if (input_x >= 0 && input_x < (int)InSamples) // ZeroPadding1D
+              output_acc[pos_x] = output_acc[pos_x] + input[z][input_x] * kernel[z][x];
+          }
+      }
+    }
 
-#define ACTIVATION_RELU
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output[pos_x] = activate<Act>(scale_number_t(output_acc[pos_x]) + bias);
+  }
 
-typedef number_t conv1d_6_output_type[CONV_FILTERS][CONV_OUTSAMPLES];
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, output_type output) {
+    for (unsigned int k = 0; k < ConvFilters; k++)
+      forward_row(input, kernel[k], bias[k], output[k]);
+  }
 
-static inline void conv1d_6(
-  const number_t input[INPUT_CHANNELS][INPUT_SAMPLES],               // IN
-  const number_t kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE], // IN
+  // Outputs [first, first + count) of every filter only, for sliding windows that keep their older columns
+  static inline void forward_columns(const input_type input, const kernel_type kernel, const bias_type bias, output_type output, unsigned int first, unsigned int count) {
+    static_assert(ZeroPaddingLeft == 0 && ZeroPaddingRight == 0 && ConvStride == 1, "Column updates need an unpadded unit-stride convolution");
+    long_number_t output_acc[OutputSamples];
+
+    for (unsigned int k = 0; k < ConvFilters; k++) {
+      for (unsigned int pos_x = 0; pos_x < count; pos_x++)
+        output_acc[pos_x] = 0;
+      for (unsigned int z = 0; z < InChannels; z++)
+        mac_conv1d(&input[z][first], kernel[k][z], KernelSize, count, output_acc);
+      for (unsigned int pos_x = 0; pos_x < count; pos_x++)
+        output[k][first + pos_x] = activate<Act>(scale_number_t(output_acc[pos_x]) + bias[k]);
+    }
+  }
 
-  const number_t bias[CONV_FILTERS],						                // IN
+  // Batched variant, the kernel of each filter is loaded once and applied to every sample of the batch
+  static inline void forward_batch(unsigned int batch, const input_type input[], const kernel_type kernel, const bias_type bias, output_type output[]) {
+    number_t weights[InChannels][KernelSize];
 
-  number_t output[CONV_FILTERS][CONV_OUTSAMPLES]) {               // OUT
+    for (unsigned int k = 0; k < ConvFilters; k++) {
+      for (unsigned int z = 0; z < InChannels; z++)
+        for (unsigned int x = 0; x < KernelSize; x++)
+          weights[z][x] = kernel[k][z][x];
 
-  unsigned short pos_x, z, k; 	// loop indexes for output volume
-  unsigned short x;
-  short input_x;
-  long_number_t	kernel_mac;
-  static long_number_t	output_acc[CONV_OUTSAMPLES];
-  long_number_t tmp;
+      for (unsigned int b = 0; b < batch; b++)
+        forward_row(input[b], weights, bias[k], output[b][k]);
+    }
+  }
+};
+
+// Flatten is a noop: input and output share storage, OUT = (number_t*)IN
+template<unsigned int Channels, unsigned int Samples>
+struct Flatten {
+  static constexpr unsigned int OutputSamples = Channels * Samples;
+  static constexpr uint32_t MACs = 0;
+
+  typedef number_t input_type[Channels][Samples];
+  typedef number_t output_type[OutputSamples];
+};
+
+template<unsigned int InSamples, unsigned int FcUnits, Activation Act>
+struct Dense {
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Units = FcUnits;
+  static constexpr uint32_t MACs = InSamples * FcUnits;
+  static constexpr Activation OutputActivation = Act;
+
+  typedef number_t input_type[InSamples];
+  typedef number_t kernel_type[FcUnits][InSamples];
+  typedef number_t bias_type[FcUnits];
+  typedef number_t output_type[FcUnits];
+
+  // Scale, bias and activation of one accumulated unit
+  static inline number_t output_value(long_number_t output_acc, number_t bias) {
+    return activate<Act>(scale_number_t(output_acc) + bias);
+  }
 
-  for (k = 0; k < CONV_FILTERS; k++) { 
-    for (pos_x = 0; pos_x < CONV_OUTSAMPLES; pos_x++) { 
-      output_acc[pos_x] = 0;
-	    for (z = 0; z < INPUT_CHANNELS; z++) {
-
-        kernel_mac = 0; 
-        for (x = 0; x < CONV_KERNEL_SIZE; x++) {
-          input_x = pos_x * CONV_STRIDE - ZEROPADDING_LEFT + x;
-          if (input_x < 0 || input_x >= INPUT_SAMPLES) // ZeroPadding1D
-            tmp = 0;
-          else
-            tmp = input[z][input_x] * kernel[k][z][x]; 
-          kernel_mac = kernel_mac + tmp; 
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, output_type output) {
+    for (unsigned int k = 0; k < FcUnits; k++)
+      output[k] = output_value(mac_dot(kernel[k], input, InSamples), bias[k]);
+  }
+
+  // Batched variant, each weight is loaded once per tile of MAC_MAX_ROWS samples
+  static inline void forward_batch(unsigned int batch, const input_type input[], const kernel_type kernel, const bias_type bias, output_type output[]) {
+    long_number_t output_acc[MAC_MAX_ROWS];
+
+    for (unsigned int b0 = 0; b0 < batch; b0 += MAC_MAX_ROWS) {
+      unsigned int tile = batch - b0 < MAC_MAX_ROWS ? batch - b0 : MAC_MAX_ROWS;
+
+      for (unsigned int k = 0; k < FcUnits; k++) {
+        mac_dot_rows(kernel[k], input[b0], InSamples, tile, InSamples, output_acc);
+        for (unsigned int b = 0; b < tile; b++)
+          output[b0 + b][k] = output_value(output_acc[b], bias[k]);
+      }
+    }
+  }
+};
+
+// Conv1D -> Flatten -> Dense fused: each row of conv outputs is accumulated into the dense units as soon as it is
+// produced, so the flattened conv output is never stored
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDense {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs;
+
+  static inline void forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output) {
+
+    number_t conv_row[ConvLayer::OutputSamples]; // One slice of the flattened conv output
+    long_number_t fc_acc[DenseLayer::Units];
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      fc_acc[u] = 0;
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+
+      // Flatten keeps the [filter][sample] order, this row is dense input k * OutputSamples onwards
+      for (unsigned int u = 0; u < DenseLayer::Units; u++)
+        fc_acc[u] = fc_acc[u] + mac_dot(conv_row, &fc_kernel[u][k * ConvLayer::OutputSamples], ConvLayer::OutputSamples);
+    }
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_bias[u]);
+  }
+};
+
+// ConvDense for a ReLU conv: each row of conv outputs is compacted to the positions of its nonzero values and the dense
+// units only accumulate those, the weights of the zero outputs are never loaded. Returns the nonzero conv outputs
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDenseNonzero {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+  static_assert(ConvLayer::OutputActivation == Activation::ReLU, "Only a ReLU conv has outputs that are zero often enough");
+  static_assert(ConvLayer::OutputSamples <= 256, "Positions in a row are stored in a byte");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs; // Upper bound
+
+  static inline uint32_t forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output) {
+
+    number_t conv_row[ConvLayer::OutputSamples];
+    uint8_t nonzero[ConvLayer::OutputSamples]; // Positions of the nonzero outputs of conv_row
+    long_number_t fc_acc[DenseLayer::Units];
+    uint32_t nonzeros = 0;
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      fc_acc[u] = 0;
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+
+      // Branchless compaction: every position is written, only the nonzero ones are kept
+      unsigned int n = 0;
+      for (unsigned int pos_x = 0; pos_x < ConvLayer::OutputSamples; pos_x++) {
+        nonzero[n] = pos_x;
+        n += conv_row[pos_x] != 0;
+      }
+      nonzeros += n;
+
+      for (unsigned int u = 0; u < DenseLayer::Units; u++) {
+        const number_t *weights = &fc_kernel[u][k * ConvLayer::OutputSamples];
+        long_number_t acc = fc_acc[u];
+        for (unsigned int i = 0; i < n; i++)
+          acc = acc + conv_row[nonzero[i]] * weights[nonzero[i]];
+        fc_acc[u] = acc;
+      }
+    }
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_bias[u]);
+    return nonzeros;
+  }
+};
+
+// Dense with the zero weights left out of the kernel. Each unit stores its nonzero weights in input order, with the
+// distance from the previous one (from input 0 for the first) in one byte: a longer gap is bridged by zero weights
+// 255 inputs apart. counts[u] entries belong to unit u, the units follow each other in values and deltas
+template<unsigned int InSamples, unsigned int FcUnits, Activation Act>
+struct SparseDense {
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Units = FcUnits;
+  static constexpr unsigned int MaxDelta = 255;
+  static constexpr uint32_t MACs = InSamples * FcUnits; // Upper bound, one per stored entry
+
+  typedef number_t input_type[InSamples];
+  typedef uint16_t count_type[FcUnits];
+  typedef number_t bias_type[FcUnits];
+  typedef number_t output_type[FcUnits];
+
+  static inline number_t output_value(long_number_t output_acc, number_t bias) {
+    return activate<Act>(scale_number_t(output_acc) + bias);
+  }
+
+  static inline void forward(const input_type input, const number_t values[], const uint8_t deltas[], const count_type counts, const bias_type bias, output_type output) {
+    for (unsigned int u = 0; u < FcUnits; u++) {
+      long_number_t output_acc = 0;
+      unsigned int index = 0;
+
+      for (unsigned int i = 0; i < counts[u]; i++) {
+        index += deltas[i];
+        output_acc = output_acc + values[i] * input[index];
+      }
+      output[u] = output_value(output_acc, bias[u]);
+      values += counts[u];
+      deltas += counts[u];
+    }
+  }
+
+  // Batched variant, each entry is decoded once per tile of MAC_MAX_ROWS samples
+  static inline void forward_batch(unsigned int batch, const input_type input[], const number_t values[], const uint8_t deltas[], const count_type counts, const bias_type bias, output_type output[]) {
+    long_number_t output_acc[MAC_MAX_ROWS];
+
+    for (unsigned int b0 = 0; b0 < batch; b0 += MAC_MAX_ROWS) {
+      unsigned int tile = batch - b0 < MAC_MAX_ROWS ? batch - b0 : MAC_MAX_ROWS;
+      const number_t *unit_values = values;
+      const uint8_t *unit_deltas = deltas;
+
+      for (unsigned int u = 0; u < FcUnits; u++) {
+        unsigned int index = 0;
+
+        for (unsigned int b = 0; b < tile; b++)
+          output_acc[b] = 0;
+        for (unsigned int i = 0; i < counts[u]; i++) {
+          index += unit_deltas[i];
+          for (unsigned int b = 0; b < tile; b++)
+            output_acc[b] = output_acc[b] + unit_values[i] * input[b0 + b][index];
         }
+        for (unsigned int b = 0; b < tile; b++)
+          output[b0 + b][u] = output_value(output_acc[b], bias[u]);
+        unit_values += counts[u];
+        unit_deltas += counts[u];
+      }
+    }
+  }
+};
+
+// Conv1D -> Flatten -> SparseDense fused like ConvDense. The entries of each unit are consumed in input order as the
+// conv rows are produced, and a filter is not computed at all when none of its outputs has a weight left
+template<typename ConvLayer, typename DenseLayer>
+struct ConvSparseDense {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs; // Upper bound
+
+  static inline void forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const number_t fc_values[],
+    const uint8_t fc_deltas[],
+    const typename DenseLayer::count_type fc_counts,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output) {
+
+    number_t conv_row[ConvLayer::OutputSamples];
+    long_number_t fc_acc[DenseLayer::Units];
+    const number_t *values[DenseLayer::Units];
+    const uint8_t *deltas[DenseLayer::Units], *deltas_end[DenseLayer::Units];
+    unsigned int index[DenseLayer::Units]; // Input of the last entry consumed
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++) {
+      fc_acc[u] = 0;
+      values[u] = fc_values;
+      deltas[u] = fc_deltas;
+      deltas_end[u] = fc_deltas + fc_counts[u];
+      index[u] = 0;
+      fc_values += fc_counts[u];
+      fc_deltas += fc_counts[u];
+    }
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      unsigned int row_begin = k * ConvLayer::OutputSamples, row_end = row_begin + ConvLayer::OutputSamples;
 
-	      output_acc[pos_x] = output_acc[pos_x] + kernel_mac; 
+      bool used = false;
+      for (unsigned int u = 0; u < DenseLayer::Units; u++)
+        used = used || (deltas[u] != deltas_end[u] && index[u] + *deltas[u] < row_end);
+      if (!used)
+        continue;
+
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+
+      for (unsigned int u = 0; u < DenseLayer::Units; u++) {
+        // Cursor in locals, the compiler cannot keep the arrays in registers
+        const number_t *value = values[u];
+        const uint8_t *delta = deltas[u];
+        unsigned int pos = index[u];
+        long_number_t acc = fc_acc[u];
+
+        while (delta != deltas_end[u] && pos + *delta < row_end) {
+          pos += *delta++;
+          acc = acc + *value++ * conv_row[pos - row_begin];
+        }
+        values[u] = value;
+        deltas[u] = delta;
+        index[u] = pos;
+        fc_acc[u] = acc;
       }
-      output_acc[pos_x] = scale_number_t(output_acc[pos_x]);
+    }
 
-      output_acc[pos_x] = output_acc[pos_x] + bias[k]; 
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_bias[u]);
+  }
+};
+
+// ConvDense for a single unit that is only compared with a threshold: rows are produced in the given filter order and
+// the accumulation stops as soon as the rows left can no longer move the output across the threshold. The row of
+// filter k adds between row_max * fc_negative[k] and row_max * fc_positive[k] (sums of the negative and positive dense
+// weights of its outputs), where row_max bounds its outputs from the input range and the sums of its negative and
+// positive kernel weights. The decision is the one of ConvDense as long as neither accumulates past long_number_t
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDenseEarlyExit {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+  static_assert(DenseLayer::Units == 1, "Only a single unit decides on a threshold");
+  static_assert(ConvLayer::OutputActivation == Activation::ReLU, "Bounds assume non-negative conv outputs");
+  static_assert(ConvLayer::Filters <= 256, "Filter order is stored in bytes");
+  static_assert(FIXED_POINT > 0, "Bounds are computed on fixed-point accumulators");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs; // Upper bound
+  static constexpr uint32_t RowMACs = MACs / ConvLayer::Filters; // Per conv row and its dense terms
+
+  typedef uint8_t order_type[ConvLayer::Filters];
+  typedef int32_t bound_type[ConvLayer::Filters];
+
+  // Whether the output of ConvDense is at least threshold, rows is set to the number of conv rows computed
+  static inline bool forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    const order_type order,
+    const bound_type conv_negative,
+    const bound_type conv_positive,
+    const bound_type fc_negative,
+    const bound_type fc_positive,
+    number_t threshold,
+    unsigned int *rows) {
+
+    *rows = 0;
+    if (threshold <= NUMBER_MIN) // Clamped outputs are never below
+      return true;
+    // Output at least threshold <=> scale_number_t(acc) + bias >= threshold, the shift rounds down
+    const int64_t target = ((int64_t)threshold - fc_bias[0]) * (1 << FIXED_POINT);
+
+    number_t input_min = input[0][0], input_max = input[0][0];
+    for (unsigned int z = 0; z < ConvLayer::InputChannels; z++)
+      for (unsigned int x = 0; x < ConvLayer::InputSamples; x++) {
+        input_min = input[z][x] < input_min ? input[z][x] : input_min;
+        input_max = input[z][x] > input_max ? input[z][x] : input_max;
+      }
 
+    number_t row_max[ConvLayer::Filters];
+    int64_t low = 0, high = 0; // What the rows left can add
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      int64_t conv_acc = (int64_t)conv_positive[k] * input_max + (int64_t)conv_negative[k] * input_min;
+      int64_t value = (conv_acc >> FIXED_POINT) + conv_bias[k];
+      row_max[k] = value < 0 ? 0 : value > NUMBER_MAX ? NUMBER_MAX : value;
+      low += (int64_t)row_max[k] * fc_negative[k];
+      high += (int64_t)row_max[k] * fc_positive[k];
     }
 
-    for (pos_x = 0; pos_x < CONV_OUTSAMPLES; pos_x++) {
-#ifdef ACTIVATION_LINEAR
-      output[k][pos_x] = clamp_to_number_t(output_acc[pos_x]);
-#elif defined(ACTIVATION_RELU)
-      // Activation function: ReLU
-      if (output_acc[pos_x] < 0)
-        output[k][pos_x] = 0;
-      else
-        output[k][pos_x] = clamp_to_number_t(output_acc[pos_x]);
-#endif
+    number_t conv_row[ConvLayer::OutputSamples];
+    int64_t fc_acc = 0;
+    for (unsigned int i = 0; i < ConvLayer::Filters; i++) {
+      if (fc_acc + low >= target)
+        return true;
+      if (fc_acc + high < target)
+        return false;
+
+      unsigned int k = order[i];
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+      fc_acc += mac_dot(conv_row, &fc_kernel[0][k * ConvLayer::OutputSamples], ConvLayer::OutputSamples);
+      low -= (int64_t)row_max[k] * fc_negative[k];
+      high -= (int64_t)row_max[k] * fc_positive[k];
+      (*rows)++;
     }
+    return fc_acc >= target;
+  }
+};
+
+// MaxPool1D -> Conv1D -> Flatten -> Dense on a window that slides by Hop input samples between calls: pooled and
+// conv columns still inside the window are shifted instead of recomputed, only the dense layer sees the whole window
+template<typename PoolLayer, typename ConvLayer, typename DenseLayer, unsigned int Hop>
+struct SlidingPoolConvDense {
+  static_assert(Hop % PoolLayer::Stride == 0, "Hop must be a multiple of the pooling stride");
+  static_assert(ConvLayer::InputSamples == PoolLayer::OutputSamples, "Conv input must be the pooled output");
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  // Columns entering the window at each hop, nothing can be reused when the hop is as wide as the conv output
+  static constexpr unsigned int NewColumns = Hop / PoolLayer::Stride;
+  static constexpr bool Reuse = NewColumns < ConvLayer::OutputSamples;
+
+  // Persistent between calls, unlike the activation arena
+  typedef struct {
+    typename PoolLayer::output_type pooled;
+    typename ConvLayer::output_type conv;
+    bool primed; // pooled and conv hold the previous window
+  } state_type;
+
+  static inline void reset(state_type *state) {
+    state->primed = false;
+  }
+
+  static inline void forward(
+    const typename PoolLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output,
+    state_type *state) {
+
+    unsigned int pooled_first = 0, conv_first = 0;
+
+    if (state->primed && Reuse) {
+      for (unsigned int z = 0; z < ConvLayer::InputChannels; z++)
+        for (unsigned int pos_x = 0; pos_x + NewColumns < PoolLayer::OutputSamples; pos_x++)
+          state->pooled[z][pos_x] = state->pooled[z][pos_x + NewColumns];
+      for (unsigned int k = 0; k < ConvLayer::Filters; k++)
+        for (unsigned int pos_x = 0; pos_x + NewColumns < ConvLayer::OutputSamples; pos_x++)
+          state->conv[k][pos_x] = state->conv[k][pos_x + NewColumns];
+      pooled_first = PoolLayer::OutputSamples - NewColumns;
+      conv_first = ConvLayer::OutputSamples - NewColumns;
+    }
+
+    PoolLayer::forward_columns(input, state->pooled, pooled_first, PoolLayer::OutputSamples - pooled_first);
+    ConvLayer::forward_columns(state->pooled, conv_kernel, conv_bias, state->conv, conv_first, ConvLayer::OutputSamples - conv_first);
+    // Flatten is a noop, the dense layer reads the conv columns in place
+    DenseLayer::forward(reinterpret_cast<const typename DenseLayer::input_type &>(state->conv), fc_kernel, fc_bias, output);
+
+    state->primed = true;
+  }
+};
+
+#endif//__LAYERS_H__
+
+/**
+  ******************************************************************************
+  * @file    arena.h
+  * @brief   Static placement of the intermediate activations of a chain of layers into a single arena
+  */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_ALIGNMENT 4 // Every tensor starts on a word boundary
+
+// Tensor i is written by layer i and read by layer i + 1, so only neighbours are ever live at the same time.
+// Even tensors are placed at the bottom of the arena and odd tensors at the top (ping-pong), which gives an
+// arena of max(size[i] + size[i + 1]) bytes: the minimum for a chain, computed at compile time.
+template<size_t... TensorSizes>
+struct ArenaPlan {
+  static_assert(sizeof...(TensorSizes) > 0, "Empty arena plan");
+
+  static constexpr unsigned int tensors = sizeof...(TensorSizes);
+  static constexpr size_t sizes[sizeof...(TensorSizes)] = {TensorSizes...};
+
+  static constexpr size_t aligned(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+  }
+
+  static constexpr size_t peak(unsigned int i = 0) {
+    return i + 1 >= tensors ? aligned(sizes[i])
+         : aligned(sizes[i]) + aligned(sizes[i + 1]) > peak(i + 1) ? aligned(sizes[i]) + aligned(sizes[i + 1])
+         : peak(i + 1);
   }
+
+  static constexpr size_t bytes = peak();
+
+  static constexpr size_t offset(unsigned int i) {
+    return i % 2 ? bytes - aligned(sizes[i]) : 0;
+  }
+};
+
+template<size_t... TensorSizes>
+constexpr size_t ArenaPlan<TensorSizes...>::sizes[sizeof...(TensorSizes)];
+
+// View of one planned tensor inside an arena
+template<typename T>
+static inline T &arena_tensor(uint8_t *arena, size_t offset) {
+  return *reinterpret_cast<T *>(arena + offset);
 }
 
-#undef INPUT_CHANNELS
-#undef INPUT_SAMPLES
-#undef CONV_FILTERS
-#undef CONV_KERNEL_SIZE
-#undef CONV_STRIDE
-#undef ZEROPADDING_LEFT
-#undef ZEROPADDING_RIGHT
-#undef CONV_OUTSAMPLES
-#undef ACTIVATION_RELU
+#endif//__ARENA_H__
+
+/**
+  ******************************************************************************
+  * @file    profile.h
+  * @brief   Opt-in per-layer timing of the inference, build with -DMODEL_PROFILE=1. Otherwise the macros expand to nothing
+  */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#ifndef MODEL_PROFILE
+#define MODEL_PROFILE 0
+#endif
+
+#if MODEL_PROFILE
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+// DWT cycle counter of the Cortex-M3/M4, 32-bit so a layer must take less than 53 s at 80 MHz
+#define PROFILE_UNIT "cycles"
+#define PROFILE_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define PROFILE_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define PROFILE_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+typedef uint32_t profile_time_t;
+
+static inline void profile_init(void) {
+  PROFILE_DEMCR |= 1UL << 24; // TRCENA: enable the DWT
+  PROFILE_DWT_CYCCNT = 0;
+  PROFILE_DWT_CTRL |= 1; // CYCCNTENA
+}
+
+static inline profile_time_t profile_now(void) {
+  return PROFILE_DWT_CYCCNT;
+}
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+// Time stamp counter, constant rate on current CPUs: close to but not exactly core cycles
+#define PROFILE_UNIT "TSC ticks"
+
+typedef uint64_t profile_time_t;
+
+static inline void profile_init(void) {
+}
+
+static inline profile_time_t profile_now(void) {
+  return __rdtsc();
+}
+#else
+#include <chrono>
+
+#define PROFILE_UNIT "ns"
+
+typedef uint64_t profile_time_t;
+
+static inline void profile_init(void) {
+}
+
+static inline profile_time_t profile_now(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+typedef struct {
+  const char *name;
+  uint32_t macs; // Per call
+  uint32_t calls;
+  profile_time_t min;
+  profile_time_t max;
+  uint64_t total;
+} profile_layer_t;
+
+static inline void profile_record(profile_layer_t *layer, profile_time_t elapsed) {
+  if (layer->calls == 0 || elapsed < layer->min)
+    layer->min = elapsed;
+  if (elapsed > layer->max)
+    layer->max = elapsed;
+  layer->total += elapsed;
+  layer->calls++;
+}
+
+static inline void profile_reset(profile_layer_t *layers, unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    layers[i].calls = 0;
+    layers[i].min = 0;
+    layers[i].max = 0;
+    layers[i].total = 0;
+  }
+}
+
+// One line per layer: name, calls, min/mean/max time and MACs per 1000 time units. No floating point so that it
+// works with the reduced printf of embedded C libraries
+static inline int profile_format(char *buffer, size_t size, const profile_layer_t *layer) {
+  unsigned long mean = layer->calls ? (unsigned long)(layer->total / layer->calls) : 0;
+  return snprintf(buffer, size, "%s: %lu calls, min %lu mean %lu max %lu " PROFILE_UNIT ", %lu MACs, %lu MACs/k" PROFILE_UNIT,
+    layer->name, (unsigned long)layer->calls, (unsigned long)layer->min, mean, (unsigned long)layer->max,
+    (unsigned long)layer->macs, mean ? (unsigned long)((uint64_t)layer->macs * 1000 / mean) : 0UL);
+}
+
+// Time the statements between PROFILE_BEGIN(id) and PROFILE_END(id, layer) into the profile_layer_t *layer
+#define PROFILE_BEGIN(id) profile_time_t profile_start_##id = profile_now()
+#define PROFILE_END(id, layer) profile_record(layer, profile_now() - profile_start_##id)
+#else
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id, layer)
+#endif
+
+#endif//__PROFILE_H__
+
+/**
+  ******************************************************************************
+  * @file    model.hh
+  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
+  * @version 1.0.0
+  * @date    08 july 2020
+  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
+  */
+
+#ifndef __MODEL_H__
+#define __MODEL_H__
+
+#ifndef SINGLE_FILE
+#include "number.h"
+#include "layers.h"
+#include "arena.h"
+#include "profile.h"
+#endif
+
+#define MODEL_OUTPUT_SAMPLES 1
+#define MODEL_INPUT_SAMPLES 100 // node 0 is InputLayer so use its output shape as input shape of the model
+#define MODEL_INPUT_CHANNELS 1
+
+// Run conv1d_6, flatten_2 and dense_4 as one fused kernel so that the conv output is never stored,
+// build with -DMODEL_FUSED_CONV_DENSE=0 to run the layers separately
+#ifndef MODEL_FUSED_CONV_DENSE
+#define MODEL_FUSED_CONV_DENSE 1
+#endif
+
+// Run dense_4 on the magnitude-pruned weights of weights/dense_4_sparse.c (main --prune) so that only the nonzero
+// weights are read, fused it also skips the conv1d_6 filters left without weights. cnn_stream() keeps dense_4_kernel
+#ifndef MODEL_SPARSE_DENSE
+#define MODEL_SPARSE_DENSE 0
+#endif
+
+// Fused conv1d_6 -> dense_4 that skips the zero outputs of the ReLU instead of multiplying them, and counts them in
+// model_density. Build with -DMODEL_ACTIVATION_SPARSE=1
+#ifndef MODEL_ACTIVATION_SPARSE
+#define MODEL_ACTIVATION_SPARSE 0
+#endif
+
+// cnn_decide(): the fused conv1d_6 -> dense_4 stopped as soon as the decision is known, with the filter order and
+// bounds of weights/conv1d_6_dense_4_bounds.c (main --early-exit). Build with -DMODEL_EARLY_EXIT=1
+#ifndef MODEL_EARLY_EXIT
+#define MODEL_EARLY_EXIT 0
+#endif
+
+#if MODEL_ACTIVATION_SPARSE && (!MODEL_FUSED_CONV_DENSE || MODEL_SPARSE_DENSE)
+#error "MODEL_ACTIVATION_SPARSE needs MODEL_FUSED_CONV_DENSE and dense weights"
+#endif
+
+// Model layers, InputLayer is excluded
+typedef MaxPool1D<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES, 4, 3> max_pooling1d_6_t;
+typedef Conv1D<1, max_pooling1d_6_t::OutputSamples, 64, 8, 1, Activation::ReLU> conv1d_6_t;
+typedef Flatten<conv1d_6_t::Filters, conv1d_6_t::OutputSamples> flatten_2_t;
+typedef Dense<flatten_2_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_4_t;
+typedef ConvDense<conv1d_6_t, dense_4_t> conv1d_6_dense_4_t;
+typedef ConvDenseNonzero<conv1d_6_t, dense_4_t> conv1d_6_dense_4_nonzero_t;
+typedef ConvDenseEarlyExit<conv1d_6_t, dense_4_t> conv1d_6_dense_4_early_exit_t;
+typedef SparseDense<flatten_2_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_4_sparse_t;
+typedef ConvSparseDense<conv1d_6_t, dense_4_sparse_t> conv1d_6_dense_4_sparse_t;
+
+// Layer calls of cnn() and cnn_r() timed when built with -DMODEL_PROFILE=1
+enum {
+  PROFILE_MAX_POOLING1D_6,
+#if MODEL_FUSED_CONV_DENSE
+  PROFILE_CONV1D_6_DENSE_4,
+#else
+  PROFILE_CONV1D_6,
+  PROFILE_FLATTEN_2,
+  PROFILE_DENSE_4,
+#endif
+  MODEL_PROFILE_LAYERS
+};
+
+#if MODEL_PROFILE
+// Not thread-safe: profile a single thread of inferences
+extern profile_layer_t model_profile[MODEL_PROFILE_LAYERS];
+
+void model_profile_reset(void);
+#endif
+
+#if MODEL_ACTIVATION_SPARSE
+// Nonzero conv1d_6 outputs seen by cnn() and cnn_r(), out of flatten_2_t::OutputSamples per inference
+typedef struct {
+  uint32_t inferences;
+  uint32_t min; // Per inference
+  uint32_t max;
+  uint64_t total;
+} model_density_t;
+
+// Not thread-safe: count a single thread of inferences
+extern model_density_t model_density;
+
+void model_density_reset(void);
+#endif
+
+#if MODEL_EARLY_EXIT
+// conv1d_6 rows computed by cnn_decide(), out of conv1d_6_t::Filters per inference
+typedef struct {
+  uint32_t inferences;
+  uint64_t rows;
+} model_early_exit_t;
+
+// Not thread-safe: count a single thread of inferences
+extern model_early_exit_t model_early_exit;
+
+void model_early_exit_reset(void);
+#endif
+
+// Maximum number of samples processed together by one step of cnn_batch()
+#define MODEL_BATCH_SIZE 16
+
+// Intermediate tensors in execution order, flatten_2 is a noop that reads conv1d_6_output in place
+enum {
+  MAX_POOLING1D_6_OUTPUT,
+  CONV1D_6_OUTPUT,
+};
+
+static const char *const model_tensor_names[] = {"max_pooling1d_6_output", "conv1d_6_output"};
+
+// Offsets of the tensors in the activation arena, conv1d_6_output is never stored when fused
+typedef ArenaPlan<
+  sizeof(max_pooling1d_6_t::output_type)
+#if !MODEL_FUSED_CONV_DENSE
+, sizeof(conv1d_6_t::output_type)
+#endif
+> model_arena_plan_t;
+
+typedef ArenaPlan<
+  MODEL_BATCH_SIZE * sizeof(max_pooling1d_6_t::output_type),
+  MODEL_BATCH_SIZE * sizeof(conv1d_6_t::output_type)
+> model_batch_arena_plan_t;
+
+#define MODEL_ARENA_SIZE (model_arena_plan_t::bytes)
+#define MODEL_BATCH_ARENA_SIZE (model_batch_arena_plan_t::bytes)
+
+// Intermediate activations of one inference, cnn() uses its own static instance
+// while cnn_r() lets the caller provide one per thread
+typedef struct {
+  alignas(ARENA_ALIGNMENT) uint8_t arena[MODEL_ARENA_SIZE];
+} cnn_activations_t;
+
+typedef struct {
+  alignas(ARENA_ALIGNMENT) uint8_t arena[MODEL_BATCH_ARENA_SIZE];
+} cnn_batch_activations_t;
+
+// Sliding window hop of cnn_stream() in input samples, must be a multiple of the max_pooling1d_6 stride
+#ifndef MODEL_STREAM_HOP
+#define MODEL_STREAM_HOP 48
+#endif
+
+typedef SlidingPoolConvDense<max_pooling1d_6_t, conv1d_6_t, dense_4_t, MODEL_STREAM_HOP> cnn_stream_layers_t;
+typedef cnn_stream_layers_t::state_type cnn_stream_t;
+
+// Class of an output: the sign of a single output, the logit of the positive class, or the highest of several
+static inline unsigned int model_decision(const number_t output[MODEL_OUTPUT_SAMPLES]) {
+  unsigned int decision = 0;
+  for (unsigned int i = 1; i < MODEL_OUTPUT_SAMPLES; i++)
+    if (output[i] > output[decision])
+      decision = i;
+  return MODEL_OUTPUT_SAMPLES == 1 ? output[0] >= 0 : decision;
+}
+
+void cnn(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  //dense_4_output_type dense_4_output);
+  number_t output[MODEL_OUTPUT_SAMPLES]);
+
+void cnn_r(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_activations_t *activations);
+
+// conv1d_6 -> dense_4 fused on an input already through max_pooling1d_6, always on the dense weights: the second half
+// of the conv1d_6 entry of model_registry.c, which runs on the weights of this file rather than a copy of its own
+void cnn_pooled(
+  const max_pooling1d_6_t::output_type max_pooling1d_6_output,
+  number_t output[MODEL_OUTPUT_SAMPLES]);
+
+// Run batch inferences, layer weights are loaded once per step of MODEL_BATCH_SIZE samples
+void cnn_batch(
+  unsigned int batch,
+  const number_t input[][MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[][MODEL_OUTPUT_SAMPLES],
+  cnn_batch_activations_t *activations);
+
+// Same output as cnn() on the window, which must have moved by exactly MODEL_STREAM_HOP samples since the previous
+// call: only the pooled and conv columns of the newest samples are computed. Call cnn_stream_reset() after a gap
+void cnn_stream(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_stream_t *stream);
+
+void cnn_stream_reset(cnn_stream_t *stream);
+
+#if MODEL_EARLY_EXIT
+// Whether cnn() would output at least threshold, computing only the conv1d_6 rows needed to know
+bool cnn_decide(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t threshold);
+#endif
+
+#endif//__MODEL_H__
 /**
   ******************************************************************************
   * @file    weights/conv.cc
@@ -216,7 +1444,7 @@ static inline void conv1d_6(
 const int16_t conv1d_6_bias[CONV_FILTERS] = {-69, 12, 76, -30, 9, 108, 71, -22, 58, -40, -25, 37, -23, 65, 3, 32, 43, 33, -28, 12, 16, 5, 35, -30, 15, 12, -10, 89, -20, 54, -14, 35, -19, 96, -68, 49, 55, 32, -23, -16, -2, 36, -22, -53, 109, 37, -2, 53, 12, 35, 15, 55, 18, 16, 50, 68, 11, 46, 34, 49, -3, 36, -31, 112}
 ;
 
-const int16_t conv1d_6_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] = {{{19, 59, 44, -15, -27, 14, -34, -5}
+const int16_t conv1d_6_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] NUMBER_ALIGN = {{{19, 59, 44, -15, -27, 14, -34, -5}
 }
 , {{-34, -75, 61, -56, 43, 38, 13, 62}
 }
@@ -352,31 +1580,80 @@ const int16_t conv1d_6_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] =
 #undef CONV_KERNEL_SIZE
 /**
   ******************************************************************************
-  * @file    flatten.cc
+  * @file    weights/fc.cc
   * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
   * @version 1.0.0
   * @date    24 march 2020
   * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
   */
 
-#ifndef SINGLE_FILE
-#include "number.h"
-#endif
+#define INPUT_SAMPLES 1664
+#define FC_UNITS 1
+
+
+const int16_t dense_4_bias[FC_UNITS] = {-29}
+;
+
+const int16_t dense_4_kernel[FC_UNITS][INPUT_SAMPLES] NUMBER_ALIGN = {{-22, -8, 1, -41, -24, 40, 41, 24, 20, 1, -39, -4, -15, 14, 0, 0, -19, 45, 16, -8, 9, 39, 3, -2, 26, 28, -73, -21, 67, -58, -39, 11, -6, -17, 19, 22, -20, -39, -30, -60, 33, 33, -14, 37, 1, -48, -5, 40, 57, 148, -13, -35, -64, 25, -16, 32, -128, 49, -38, 29, -62, 24, 27, -78, -26, 89, 54, 40, -68, -47, 71, -135, -140, 117, 100, 28, -77, 11, 66, 38, -13, 11, -17, -12, 5, -12, -20, -34, 24, 28, 19, 17, -10, -1, 50, -35, -25, -6, 14, 64, 12, 7, -28, 56, -24, 5, 20, 17, -15, -11, 30, 10, 58, 63, 10, 35, 19, -53, 26, 33, 51, 103, 45, -58, -119, -109, 17, 23, 0, 65, -9, 31, -65, -44, 66, -38, 27, -33, 56, -32, -23, 52, -82, -73, 33, 10, 27, -81, 18, 32, 55, -57, 31, 73, -90, -48, 1, -31, -81, -9, -27, -37, 61, -15, 39, 35, -60, 62, -1, -58, -25, -41, -40, -30, -76, 66, 93, 82, -56, 24, -80, -161, 3, -16, -24, -30, 13, -30, 12, 37, 7, -10, 19, -17, 11, 12, -2, 1, -20, -21, 16, 69, 8, 39, 19, -46, 71, 42, 70, -118, -25, -6, 53, 10, 0, -46, 44, -45, -30, -80, 0, 99, 2, 24, -99, 55, -21, -127, 84, 118, 64, -76, -118, 49, -11, -1, -6, -8, -5, 1, -3, 18, 7, -29, 26, 28, 24, -20, -42, 16, 16, -25, -39, 6, 35, 26, 12, 0, 12, -6, -20, 19, -17, 12, 10, -20, 16, 24, -16, 9, -28, -10, 43, 4, -13, -23, 18, -2, -35, 14, 11, -22, 34, -12, -38, 25, 20, 1, 2, -3, -12, 19, -9, -40, 11, 3, -13, 1, 26, -25, -43, -45, -14, 19, -18, -9, 16, -5, 11, -1, -14, 5, 16, 14, 6, -33, -7, 23, 15, 13, -26, 44, -13, -8, 7, 25, 43, 6, -55, -11, 37, -40, -15, 11, -14, 37, -15, -11, -24, 34, 10, 2, -5, 15, 11, 8, 28, 16, 16, -8, -26, -28, -69, 32, -11, -50, -29, -29, 10, 7, -17, -46, 28, 6, -20, 103, -79, -5, 22, -38, 0, 3, 4, 43, 7, -70, 8, -84, -10, 42, -37, 22, 33, -55, -74, -35, 10, 30, 145, 41, 145, -41, -24, -80, 107, 3, -42, 23, 104, -132, 5, 13, -36, -12, -3, 11, 130, 10, -96, -30, -89, -108, 76, -56, 106, 21, -3, 38, -6, 30, 20, 16, -15, 6, 14, 29, -7, 26, -26, -30, -53, -18, 28, -10, -5, -30, -19, -16, 10, -6, -14, -22, 22, 10, 16, -27, 26, -2, -18, -45, 6, 21, 26, -15, -38, -20, -2, 29, -7, -34, -25, -20, -40, -4, 0, 45, 1, -50, -21, 15, 18, 15, 1, -50, 11, 18, 10, 16, 30, 0, -35, -7, 24, 0, 3, -67, 33, 12, 4, 35, -5, -7, -8, 49, -17, 1, 7, 11, -28, -29, -15, -31, 14, 21, 18, -7, -28, -26, 9, 19, 15, -23, -10, 18, 20, -4, -7, -7, 8, 14, 92, 69, -3, 10, -76, 16, -26, -10, 5, -47, 31, 13, -13, 32, -62, -3, 29, 6, 15, -15, -64, 25, -3, 20, 72, -120, -18, -25, -5, 8, -20, 19, -5, -6, -33, 13, 17, -25, 39, 7, 15, 21, 11, -24, 29, 11, -5, 2, 28, 38, 7, -55, 17, 12, 38, -34, -7, -10, -26, 56, -22, -4, 14, -22, -30, -4, 87, -43, -5, 56, -149, 69, -15, 42, -7, -86, -1, -77, -10, -10, 17, 26, 23, -21, -33, -5, -11, -38, 7, 35, -38, 57, -23, -8, 19, -17, -27, 38, 24, -19, 56, 56, 6, 56, 34, 14, -31, 8, 33, 6, -39, 79, -49, 16, -9, 28, 23, -47, 4, 20, -68, -3, 66, -88, -36, 12, -129, 110, 17, -35, 15, -33, -129, -4, 16, 3, -3, -16, -9, -35, -34, -43, -28, -9, -80, -42, -30, -57, 0, 10, 26, 32, -84, -129, -47, -61, -9, -28, 21, -58, -25, -7, 10, -41, -21, -12, -13, 6, 96, 4, -9, 0, 10, 86, 2, -12, 50, -46, 42, 61, -45, 3, -5, 72, 0, 16, 16, -18, -68, -10, 36, 47, -13, -53, 99, -61, 99, 71, 0, 0, -161, -105, -53, -53, -24, 92, -23, -78, 22, -1, 22, 23, 38, 34, -39, 29, 20, -36, 25, 30, 45, -5, 3, -27, 55, -22, -18, 1, -6, -17, 13, 0, 7, 78, -19, 58, -16, -36, -55, -16, -13, 3, 72, -17, 4, -42, 10, -47, 3, 3, 19, -17, 62, -61, -35, 39, -24, 0, 104, -1, 23, 5, -64, -46, 21, 5, 24, -4, 23, -3, -12, -11, -41, -49, -49, -110, -72, -97, -104, 8, 28, 54, -132, -81, -72, -101, 75, -33, -36, 20, 63, -13, -68, -57, 57, -40, 0, -73, 3, 8, -4, -4, -46, -39, -8, -56, 108, 66, 24, -103, -154, -55, -92, 68, -39, 0, 5, 17, -14, -12, 15, 27, 39, -26, 23, -62, 35, 51, -25, -16, 16, -41, -86, -32, 38, 64, 68, 20, 18, -1, -76, -49, 28, 41, 6, 20, 59, -29, -42, -22, 20, 24, -13, -10, 3, 21, -33, -13, 21, 61, 72, 31, 28, -73, 38, -23, 39, 10, -37, 32, -6, -12, -8, 20, 20, -30, 18, 8, 20, 21, 32, 70, -39, -4, -16, 7, 47, -5, -17, -1, 20, -10, -38, -16, 2, -52, 3, 21, 38, -43, 12, -27, -13, -6, 5, -42, -3, -40, -53, 25, -7, -4, 45, -41, 50, 33, -110, 16, 33, 13, -15, -32, -6, 42, 24, 20, 6, 11, -4, -62, -4, -10, 23, 9, -28, -29, 6, 35, -7, -19, 0, 16, -94, 65, -29, 51, -49, -13, -45, -38, 5, 0, -13, -13, -33, -14, 2, 28, 22, -85, -24, -80, -100, -51, 75, 38, -70, -60, -4, -15, -7, -23, 24, -10, -11, 41, -2, -27, 6, -6, 23, -7, -8, -13, 60, 5, -24, 16, 29, 0, 38, -31, -36, 48, 34, 29, -22, 14, 5, 12, -1, 27, 22, 30, 24, 12, -10, 19, 5, 31, 17, -6, 52, 22, -22, 26, 32, 58, 27, -3, -28, -14, 19, -26, -6, -10, 49, 13, 13, 24, -33, 5, 22, 16, 35, 15, 5, 44, -2, -62, 25, 20, -27, 50, -30, -34, 33, 48, -25, -12, 38, 11, -17, -2, -31, 11, 8, -19, -8, -29, -3, -19, 16, -36, 0, -8, -28, 27, 25, -20, 0, -9, -29, 10, 34, 17, 26, -11, 25, 2, 8, 68, 16, 11, 29, -4, 47, -49, 18, 38, 20, -15, -16, -27, 0, 44, -7, -6, -63, 64, -30, 55, 25, 11, -15, 29, 16, 5, 30, 13, 18, -7, -4, 22, 12, 13, 20, 22, -59, -32, 21, 33, 31, 28, -62, 53, 45, 17, -27, 11, -41, 4, 14, 41, -19, 4, 40, 120, -39, 12, 73, -87, 134, 91, 5, -24, -197, -63, -10, -55, -25, 13, 21, 27, 11, -3, 14, -36, -27, 26, -34, -22, -25, 16, 4, -22, -5, -26, 20, 0, 10, -41, -24, -8, -17, -31, -47, 5, 40, 29, 3, 5, -8, 29, 54, 40, -5, -43, -37, 41, -34, 8, 35, 17, 31, 26, -7, 1, 7, 40, 21, 65, -50, -23, 78, 1, 61, -34, 22, -6, 40, 20, -21, -9, 34, -22, -2, -76, 40, 58, 12, 104, 128, 46, 32, -139, -36, 28, 5, -1, -6, -19, -9, -37, 26, 18, 41, -37, 0, -30, 12, 4, -16, 22, 12, 17, -8, 19, -28, -47, 36, 25, 38, -4, -20, -11, 34, 23, -22, -13, 6, 18, 12, -46, 12, -48, -15, 112, 8, -4, -88, -35, 56, -28, -44, 21, -5, -64, -14, -21, 114, -13, 32, -63, 44, 21, 25, -5, 94, -102, 27, 43, -45, -25, -21, 10, 99, 97, -22, -36, -90, -31, -6, -21, 131, 28, 16, 21, 14, -15, -16, 8, 4, 11, -11, -41, -16, 4, 49, -28, 16, 35, -172, 84, 42, 71, -13, -85, 18, -97, -87, -63, -9, 29, -5, -40, -30, 3, -22, 5, -15, -26, -5, -17, 10, 29, -10, -52, -30, -22, -53, 12, -25, -22, 1, 34, -3, 19, 18, -15, -7, 7, -3, -22, 13, 1, -32, -5, 1, -35, 25, 25, -30, 30, -39, -10, 40, 18, -50, 8, 40, -63, 50, -3, 37, -77, -48, 66, -88, -21, -42, 57, -100, -12, 36, -12, 32, 86, -137, 8, -20, -13, 16, 68, 13, 26, -40, 74, -47, 89, -8, 22, 34, -14, -62, -27, -31, -26, 37, 99, 34, 0, 12, 81, 21, 42, -24, 42, 35, -87, -145, -36, 16, -29, 29, 24, 20, -26, 9, 26, -27, -36, -25, 15, -7, -23, 13, 11, 14, 36, 32, 2, 9, 27, -53, 61, 16, -23, 30, 5, -23, 76, -44, -28, -24, 24, -84, 10, -13, -9, -20, -18, -30, -16, 11, 75, -12, 12, 20, -55, 90, 11, -56, 33, -60, -32, 0, -71, -68, -58, 11, -69, -51, 17, -16, -40, 6, 46, -25, 7, -22, -5, -54, -13, -4, -23, -46, -40, 19, -43, -30, 64, -101, 45, 25, 14, 2, -15, 39, -79, 48, -32, -57, 2, 29, 2, -16, 58, 109, 46, -34, 78, -64, 102, -31, -62, 40, -9, 4, -66, -25, -5, 19, 9, -29, 0, 7, 58, -46, -16, -8, -22, 12, 8, 11, 18, 56, -21, 31, 11, -26, 63, -55, 57, -37, -78, -19, -30, 1, 30, -13, -29, 3, -15, -2, 8, -16, -26, -19, 2, -33, -6, -3, -49, 35, -30, -4, -5, -9, -28, 18, -11, -148, -22, 45, -16, -57, 19, 8, 4, 5, 51, 8, -19, 35, 48, -68, 44, 8, -3, 9, 57, 20, -58, 14, -30, 20, 60, 59, 68, -75, 74, 25, -34, -10, 103, -143, -22, 53, -19, 40, -61, -18, 142, 114, 15, 54, -11, -54, -17, -135, 39, -35, -68}
+}
+;
+
+#undef INPUT_SAMPLES
+#undef FC_UNITS
+/**
+  ******************************************************************************
+  * @file    weights/dense_4_sparse.c
+  * @brief   dense_4 magnitude-pruned to 50% zero weights, nonzero weights with one-byte index deltas
+  *          Generated by main --prune, do not edit
+  */
+
+#define FC_UNITS 1
+#define SPARSE_ENTRIES 832
+
+// 832/1664 weights left out, magnitudes up to 24 pruned, 0 zero entries bridge long gaps
+const uint16_t dense_4_sparse_counts[FC_UNITS] = {832}
+;
+
+const int16_t dense_4_sparse_values[SPARSE_ENTRIES] NUMBER_ALIGN = {-41, 40, 41, -39, 45, 39, 26, 28, -73, 67, -58, -39, -39, -30, -60, 33, 33, 37, -48, 40, 57, 148, -35, -64, 25, 32, -128, 49, -38, 29, -62, 27, -78, -26, 89, 54, 40, -68, -47, 71, -135, -140, 117, 100, 28, -77, 66, 38, -34, 28, 50, -35, -25, 64, -28, 56, 30, 58, 63, 35, -53, 26, 33, 51, 103, 45, -58, -119, -109, 65, 31, -65, -44, 66, -38, 27, -33, 56, -32, 52, -82, -73, 33, 27, -81, 32, 55, -57, 31, 73, -90, -48, -31, -81, -27, -37, 61, 39, 35, -60, 62, -58, -25, -41, -40, -30, -76, 66, 93, 82, -56, -80, -161, -30, -30, 37, 69, 39, -46, 71, 42, 70, -118, -25, 53, -46, 44, -45, -30, -80, 99, -99, 55, -127, 84, 118, 64, -76, -118, 49, -29, 26, 28, -42, -25, -39, 35, 26, -28, 43, -35, 34, -38, 25, -40, 26, -25, -43, -45, -33, -26, 44, 25, 43, -55, 37, -40, 37, -24, 34, 28, -26, -28, -69, 32, -50, -29, -29, -46, 28, 103, -79, -38, 43, -70, -84, 42, -37, 33, -55, -74, -35, 30, 145, 41, 145, -41, -24, -80, 107, -42, 104, -132, -36, 130, -96, -30, -89, -108, 76, -56, 106, 38, 30, 29, 26, -26, -30, -53, 28, -30, -27, 26, -45, 26, -38, 29, -34, -25, -40, 45, -50, -50, 30, -35, 24, -67, 33, 35, 49, -28, -29, -31, -28, -26, 92, 69, -76, -26, -47, 31, 32, -62, 29, -64, 25, 72, -120, -25, -33, -25, 39, -24, 29, 28, 38, -55, 38, -34, -26, 56, -30, 87, -43, 56, -149, 69, 42, -86, -77, 26, -33, -38, 35, -38, 57, -27, 38, 24, 56, 56, 56, 34, -31, 33, -39, 79, -49, 28, -47, -68, 66, -88, -36, -129, 110, -35, -33, -129, -35, -34, -43, -28, -80, -42, -30, -57, 26, 32, -84, -129, -47, -61, -28, -58, -25, -41, 96, 86, 50, -46, 42, 61, -45, 72, -68, 36, 47, -53, 99, -61, 99, 71, -161, -105, -53, -53, -24, 92, -78, 38, 34, -39, 29, -36, 25, 30, 45, -27, 55, 78, 58, -36, -55, 72, -42, -47, 62, -61, -35, 39, -24, 104, -64, -46, 24, -41, -49, -49, -110, -72, -97, -104, 28, 54, -132, -81, -72, -101, 75, -33, -36, 63, -68, -57, 57, -40, -73, -46, -39, -56, 108, 66, 24, -103, -154, -55, -92, 68, -39, 27, 39, -26, -62, 35, 51, -25, -41, -86, -32, 38, 64, 68, -76, -49, 28, 41, 59, -29, -42, 24, -33, 61, 72, 31, 28, -73, 38, 39, -37, 32, -30, 32, 70, -39, 47, -38, -52, 38, -43, -27, -42, -40, -53, 25, 45, -41, 50, 33, -110, 33, -32, 42, 24, -62, -28, -29, 35, -94, 65, -29, 51, -49, -45, -38, -33, 28, -85, -24, -80, -100, -51, 75, 38, -70, -60, 24, 41, -27, 60, -24, 29, 38, -31, -36, 48, 34, 29, 27, 30, 24, 31, 52, 26, 32, 58, 27, -28, -26, 49, 24, -33, 35, 44, -62, 25, -27, 50, -30, -34, 33, 48, -25, 38, -31, -29, -36, -28, 27, 25, -29, 34, 26, 25, 68, 29, 47, -49, 38, -27, 44, -63, 64, -30, 55, 25, 29, 30, -59, -32, 33, 31, 28, -62, 53, 45, -27, -41, 41, 40, 120, -39, 73, -87, 134, 91, -24, -197, -63, -55, -25, 27, -36, -27, 26, -34, -25, -26, -41, -24, -31, -47, 40, 29, 29, 54, 40, -43, -37, 41, -34, 35, 31, 26, 40, 65, -50, 78, 61, -34, 40, 34, -76, 40, 58, 104, 128, 46, 32, -139, -36, 28, -37, 26, 41, -37, -30, -28, -47, 36, 25, 38, 34, -46, -48, 112, -88, -35, 56, -28, -44, -64, 114, 32, -63, 44, 25, 94, -102, 27, 43, -45, -25, 99, 97, -36, -90, -31, 131, 28, -41, 49, -28, 35, -172, 84, 42, 71, -85, -97, -87, -63, 29, -40, -30, -26, 29, -52, -30, -53, -25, 34, -32, -35, 25, 25, -30, 30, -39, 40, -50, 40, -63, 50, 37, -77, -48, 66, -88, -42, 57, -100, 36, 32, 86, -137, 68, 26, -40, 74, -47, 89, 34, -62, -27, -31, -26, 37, 99, 34, 81, 42, -24, 42, 35, -87, -145, -36, -29, 29, 24, -26, 26, -27, -36, -25, 36, 32, 27, -53, 61, 30, 76, -44, -28, -24, 24, -84, -30, 75, -55, 90, -56, 33, -60, -32, -71, -68, -58, -69, -51, -40, 46, -25, -54, -46, -40, -43, -30, 64, -101, 45, 25, 39, -79, 48, -32, -57, 29, 58, 109, 46, -34, 78, -64, 102, -31, -62, 40, -66, -25, -29, 58, -46, 56, 31, -26, 63, -55, 57, -37, -78, -30, 30, -29, -26, -33, -49, 35, -30, -28, -148, 45, -57, 51, 35, 48, -68, 44, 57, -58, -30, 60, 59, 68, -75, 74, 25, -34, 103, -143, 53, 40, -61, 142, 114, 54, -54, -135, 39, -35, -68}
+;
+
+const uint8_t dense_4_sparse_deltas[SPARSE_ENTRIES] = {3, 2, 1, 4, 7, 4, 3, 1, 1, 2, 1, 1, 7, 1, 1, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 2, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 8, 2, 5, 1, 1, 3, 3, 1, 7, 2, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 4, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 1, 2, 1, 2, 1, 1, 2, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 4, 2, 2, 12, 2, 2, 1, 1, 1, 1, 1, 2, 3, 1, 1, 1, 1, 2, 3, 1, 2, 1, 1, 1, 1, 1, 1, 10, 1, 1, 3, 3, 1, 2, 1, 15, 2, 6, 4, 2, 1, 8, 5, 1, 1, 1, 14, 5, 1, 4, 1, 2, 2, 1, 4, 3, 1, 7, 4, 1, 1, 1, 2, 1, 1, 4, 1, 3, 1, 3, 4, 2, 2, 2, 1, 2, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1, 3, 4, 2, 1, 1, 1, 1, 1, 1, 3, 2, 6, 2, 1, 1, 1, 2, 3, 10, 1, 3, 3, 2, 3, 2, 1, 2, 3, 2, 6, 5, 2, 2, 3, 1, 3, 4, 5, 1, 2, 5, 1, 13, 1, 3, 2, 3, 1, 3, 1, 2, 4, 1, 3, 1, 2, 7, 3, 1, 5, 1, 4, 1, 2, 3, 1, 3, 1, 5, 2, 1, 2, 1, 1, 2, 2, 2, 4, 3, 3, 2, 1, 1, 5, 1, 1, 2, 1, 2, 1, 2, 2, 2, 1, 1, 3, 2, 3, 2, 1, 1, 2, 1, 2, 2, 1, 7, 1, 1, 1, 2, 1, 1, 1, 3, 1, 1, 1, 1, 1, 2, 2, 1, 3, 5, 5, 3, 1, 1, 1, 1, 3, 5, 2, 1, 2, 1, 1, 1, 1, 3, 1, 1, 1, 1, 1, 2, 5, 1, 1, 1, 2, 1, 1, 1, 3, 1, 9, 2, 2, 1, 4, 3, 2, 5, 1, 1, 1, 1, 2, 4, 1, 3, 6, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1, 1, 1, 2, 5, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 7, 1, 1, 2, 1, 1, 1, 3, 1, 1, 1, 1, 1, 4, 1, 1, 1, 3, 1, 1, 3, 5, 3, 1, 1, 1, 1, 1, 2, 2, 1, 6, 5, 1, 1, 4, 6, 3, 3, 1, 2, 4, 2, 1, 1, 3, 1, 1, 1, 1, 2, 3, 2, 1, 5, 5, 1, 2, 5, 1, 1, 1, 1, 2, 1, 5, 3, 2, 1, 1, 1, 1, 1, 1, 1, 1, 5, 3, 2, 7, 2, 2, 2, 1, 1, 1, 1, 1, 6, 2, 1, 5, 3, 3, 1, 1, 1, 2, 3, 3, 3, 1, 4, 3, 2, 1, 2, 1, 1, 1, 1, 1, 1, 2, 4, 5, 4, 3, 1, 1, 4, 2, 2, 2, 3, 3, 2, 1, 2, 4, 2, 3, 1, 1, 1, 1, 3, 3, 10, 1, 2, 1, 1, 1, 1, 1, 2, 2, 3, 3, 1, 1, 2, 1, 1, 1, 2, 1, 1, 2, 1, 3, 4, 1, 1, 1, 2, 5, 4, 1, 3, 1, 2, 1, 4, 1, 1, 2, 1, 1, 1, 2, 2, 1, 4, 2, 1, 2, 2, 1, 3, 4, 3, 1, 1, 2, 1, 1, 1, 1, 1, 1, 6, 1, 2, 1, 2, 9, 1, 1, 1, 1, 4, 7, 2, 2, 3, 1, 1, 1, 1, 3, 3, 2, 1, 1, 2, 2, 1, 1, 1, 1, 1, 3, 1, 2, 1, 1, 3, 1, 10, 3, 1, 2, 1, 1, 1, 1, 2, 2, 1, 1, 2, 2, 1, 5, 4, 2, 1, 2, 2, 3, 11, 3, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 1, 1, 2, 1, 1, 2, 2, 1, 1, 5, 2, 1, 1, 1, 1, 3, 2, 1, 1, 1, 1, 1, 1, 3, 2, 1, 1, 1, 1, 1, 1, 2, 1, 1, 2, 2, 1, 1, 1, 7, 1, 3, 1, 1, 3, 3, 1, 1, 1, 1, 1, 6, 3, 4, 1, 2, 1, 1, 1, 2, 1, 1, 2, 1, 3, 2, 1, 4, 4, 1, 2, 1, 1, 1, 1, 1, 4, 1, 1, 1, 1, 2, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 1, 4, 3, 1, 8, 2, 2, 1, 1, 1, 1, 1, 2, 2, 2, 6, 3, 3, 1, 1, 4, 3, 2, 2, 5, 3, 1, 1, 1, 4, 2, 2, 2, 1, 1, 1, 1, 1, 1, 2, 1, 2, 2, 1, 2, 1, 2, 2, 2, 1, 1, 1}
+;
+
+#undef FC_UNITS
+#undef SPARSE_ENTRIES
+
+/**
+  ******************************************************************************
+  * @file    weights/conv1d_6_dense_4_bounds.c
+  * @brief   Filter order and per-filter sums of the negative and positive weights of conv1d_6 and dense_4 for
+  *          cnn_decide(). Generated by main --early-exit, do not edit
+  */
+
+#define CONV_FILTERS 64
+
+// Filters by decreasing range of their contribution to dense_4
+const uint8_t conv1d_6_dense_4_order[CONV_FILTERS] = {2, 15, 50, 27, 54, 63, 47, 30, 31, 44, 37, 6, 25, 8, 14, 5, 62, 24, 32, 55, 1, 51, 33, 20, 58, 22, 60, 59, 7, 26, 23, 49, 3, 57, 29, 43, 36, 53, 56, 35, 4, 40, 46, 28, 42, 48, 34, 39, 16, 13, 17, 10, 45, 18, 41, 12, 11, 0, 52, 61, 38, 21, 9, 19}
+;
 
-#define INPUT_DIM [26][64]
-#define OUTPUT_DIM 1664
+const int32_t conv1d_6_negative[CONV_FILTERS] = {-81, -165, -471, -149, -142, -272, -342, -172, -230, -47, -65, -82, -103, -110, -203, -481, -109, -140, -126, -43, -183, -77, -186, -156, -298, -520, -162, -337, -119, -117, -426, -384, -177, -303, -105, -118, -95, -237, -71, -93, -130, -91, -141, -126, -283, -127, -89, -413, -108, -148, -480, -206, -49, -145, -303, -221, -148, -132, -169, -160, -154, -71, -156, -302}
+;
+
+const int32_t conv1d_6_positive[CONV_FILTERS] = {136, 217, 304, 233, 62, 121, 51, 276, 114, 155, 235, 217, 151, 169, 263, 224, 220, 138, 168, 146, 199, 101, 149, 201, 86, 0, 189, 229, 180, 176, 6, 54, 220, 139, 184, 204, 285, 227, 129, 201, 175, 200, 173, 200, 116, 161, 183, 113, 234, 158, 158, 142, 150, 216, 202, 138, 178, 140, 170, 91, 217, 164, 289, 103}
+;
 
-//typedef number_t *flatten_2_output_type;
-typedef number_t flatten_2_output_type[OUTPUT_DIM];
+// Over the dense_4 inputs of each filter
+const int32_t dense_4_negative[CONV_FILTERS] = {-182, -478, -879, -213, -389, -675, -828, -216, -791, -195, -256, -251, -248, -342, -507, -749, -280, -347, -200, -232, -442, -221, -542, -260, -534, -873, -326, -725, -171, -399, -1048, -789, -445, -361, -198, -395, -326, -811, -224, -64, -272, -266, -164, -210, -624, -346, -181, -418, -242, -478, -480, -644, -386, -314, -657, -489, -243, -572, -708, -465, -368, -347, -421, -702}
+;
 
-#define flatten_2 //noop (IN, OUT)  OUT = (number_t*)IN
+const int32_t dense_4_positive[CONV_FILTERS] = {307, 468, 696, 411, 630, 511, 463, 379, 672, 227, 239, 134, 297, 223, 513, 754, 217, 202, 294, 175, 435, 265, 391, 420, 470, 102, 391, 548, 445, 377, 191, 424, 486, 453, 382, 254, 254, 286, 290, 498, 355, 217, 413, 468, 664, 162, 497, 704, 275, 302, 765, 393, 142, 276, 608, 528, 402, 286, 215, 598, 360, 97, 455, 786}
+;
 
-#undef INPUT_DIM
-#undef OUTPUT_DIM
+#undef CONV_FILTERS
 
 /**
   ******************************************************************************
-  * @file    fc.cc
+  * @file    model.cc
   * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
   * @version 1.0.0
   * @date    24 march 2020
@@ -385,177 +1662,812 @@ typedef number_t flatten_2_output_type[OUTPUT_DIM];
 
 #ifndef SINGLE_FILE
 #include "number.h"
+#include "model.h" // Layer types
+
+#include "weights/conv1d_6.c"
+#include "weights/dense_4.c"
+#if MODEL_SPARSE_DENSE
+#include "weights/dense_4_sparse.c"
+#endif
+#if MODEL_EARLY_EXIT
+#include "weights/conv1d_6_dense_4_bounds.c"
+#endif
 #endif
 
-#define INPUT_SAMPLES 1664
-#define FC_UNITS 1
-#define ACTIVATION_LINEAR
+#if MODEL_PROFILE
+profile_layer_t model_profile[MODEL_PROFILE_LAYERS] = {
+  {"max_pooling1d_6", max_pooling1d_6_t::MACs, 0, 0, 0, 0},
+#if MODEL_FUSED_CONV_DENSE
+#if MODEL_ACTIVATION_SPARSE
+  {"conv1d_6+flatten_2+dense_4 (nonzero)", conv1d_6_dense_4_nonzero_t::MACs, 0, 0, 0, 0},
+#elif MODEL_SPARSE_DENSE
+  {"conv1d_6+flatten_2+dense_4 (sparse)", conv1d_6_dense_4_sparse_t::MACs, 0, 0, 0, 0},
+#else
+  {"conv1d_6+flatten_2+dense_4", conv1d_6_dense_4_t::MACs, 0, 0, 0, 0},
+#endif
+#else
+  {"conv1d_6", conv1d_6_t::MACs, 0, 0, 0, 0},
+  {"flatten_2", flatten_2_t::MACs, 0, 0, 0, 0},
+#if MODEL_SPARSE_DENSE
+  {"dense_4 (sparse)", dense_4_sparse_t::MACs, 0, 0, 0, 0},
+#else
+  {"dense_4", dense_4_t::MACs, 0, 0, 0, 0},
+#endif
+#endif
+};
+
+void model_profile_reset(void) {
+  profile_reset(model_profile, MODEL_PROFILE_LAYERS);
+}
+#endif
+
+#if MODEL_ACTIVATION_SPARSE
+model_density_t model_density;
+
+void model_density_reset(void) {
+  model_density.inferences = 0;
+  model_density.min = 0;
+  model_density.max = 0;
+  model_density.total = 0;
+}
+
+static inline void model_density_record(uint32_t nonzeros) {
+  if (model_density.inferences == 0 || nonzeros < model_density.min)
+    model_density.min = nonzeros;
+  if (nonzeros > model_density.max)
+    model_density.max = nonzeros;
+  model_density.total += nonzeros;
+  model_density.inferences++;
+}
+#endif
 
-typedef number_t dense_4_output_type[FC_UNITS];
+void cnn_r(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  dense_4_t::output_type dense_4_output,
+  cnn_activations_t *activations) {
+
+  max_pooling1d_6_t::output_type &max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(MAX_POOLING1D_6_OUTPUT));
+#if !MODEL_FUSED_CONV_DENSE
+  conv1d_6_t::output_type &conv1d_6_output =
+    arena_tensor<conv1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(CONV1D_6_OUTPUT));
+  flatten_2_t::output_type &flatten_2_output =
+    arena_tensor<flatten_2_t::output_type>(activations->arena, model_arena_plan_t::offset(CONV1D_6_OUTPUT));
+#endif
 
-static inline void dense_4(
-  const number_t input[INPUT_SAMPLES], 			      // IN
-	const number_t kernel[FC_UNITS][INPUT_SAMPLES],  // IN
+  // Model layers call chain
+ // InputLayer is excluded 
+  PROFILE_BEGIN(max_pooling1d_6);
+  max_pooling1d_6_t::forward(
+     // First layer uses input passed as model parameter
+    input,
+    max_pooling1d_6_output
+  );
+  PROFILE_END(max_pooling1d_6, &model_profile[PROFILE_MAX_POOLING1D_6]);
+#if MODEL_FUSED_CONV_DENSE
+ // conv1d_6 -> flatten_2 -> dense_4 fused, the conv output is never stored
+  PROFILE_BEGIN(conv1d_6_dense_4);
+#if MODEL_ACTIVATION_SPARSE
+  model_density_record(conv1d_6_dense_4_nonzero_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
+  ));
+#elif MODEL_SPARSE_DENSE
+  conv1d_6_dense_4_sparse_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_sparse_values,
+    dense_4_sparse_deltas,
+    dense_4_sparse_counts,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
+  );
+#else
+  conv1d_6_dense_4_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
+  );
+#endif
+  PROFILE_END(conv1d_6_dense_4, &model_profile[PROFILE_CONV1D_6_DENSE_4]);
+#else
+ // InputLayer is excluded 
+  PROFILE_BEGIN(conv1d_6);
+  conv1d_6_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    conv1d_6_output
+  );
+  PROFILE_END(conv1d_6, &model_profile[PROFILE_CONV1D_6]);
+ // flatten_2 is a noop, conv1d_6_output and flatten_2_output share storage
+  PROFILE_BEGIN(flatten_2);
+  PROFILE_END(flatten_2, &model_profile[PROFILE_FLATTEN_2]);
+  PROFILE_BEGIN(dense_4);
+#if MODEL_SPARSE_DENSE
+  dense_4_sparse_t::forward(
+    flatten_2_output,
+    dense_4_sparse_values,
+    dense_4_sparse_deltas,
+    dense_4_sparse_counts,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
+  );
+#else
+  dense_4_t::forward(
+    flatten_2_output,
+    dense_4_kernel,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
+  );
+#endif
+  PROFILE_END(dense_4, &model_profile[PROFILE_DENSE_4]);
+#endif
 
-	const number_t bias[FC_UNITS],			              // IN
+}
 
-	number_t output[FC_UNITS]) {			                // OUT
+void cnn(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  dense_4_t::output_type dense_4_output) {
 
-  unsigned short k, z; 
-  long_number_t output_acc; 
+  // Output array allocation
+  static cnn_activations_t activations;
 
-  for (k = 0; k < FC_UNITS; k++) { 
-    output_acc = 0; 
-    for (z = 0; z < INPUT_SAMPLES; z++) 
-      output_acc = output_acc + ( kernel[k][z] * input[z] ); 
+  cnn_r(input, dense_4_output, &activations);
+}
 
-    output_acc = scale_number_t(output_acc);
+void cnn_pooled(
+  const max_pooling1d_6_t::output_type max_pooling1d_6_output,
+  dense_4_t::output_type dense_4_output) {
 
-    output_acc = output_acc + bias[k]; 
+  conv1d_6_dense_4_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias,
+    dense_4_output
+  );
+}
 
+void cnn_batch(
+  unsigned int batch,
+  const number_t input[][MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[][MODEL_OUTPUT_SAMPLES],
+  cnn_batch_activations_t *activations) {
+
+  unsigned int b, step;
+  max_pooling1d_6_t::output_type *max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type[MODEL_BATCH_SIZE]>(activations->arena, model_batch_arena_plan_t::offset(MAX_POOLING1D_6_OUTPUT));
+  conv1d_6_t::output_type *conv1d_6_output =
+    arena_tensor<conv1d_6_t::output_type[MODEL_BATCH_SIZE]>(activations->arena, model_batch_arena_plan_t::offset(CONV1D_6_OUTPUT));
+  flatten_2_t::output_type *flatten_2_output =
+    arena_tensor<flatten_2_t::output_type[MODEL_BATCH_SIZE]>(activations->arena, model_batch_arena_plan_t::offset(CONV1D_6_OUTPUT));
+
+  for (; batch > 0; batch -= step, input += step, output += step) {
+    step = batch < MODEL_BATCH_SIZE ? batch : MODEL_BATCH_SIZE;
+
+    for (b = 0; b < step; b++) {
+      max_pooling1d_6_t::forward(
+        input[b],
+        max_pooling1d_6_output[b]
+      );
+    }
 
-    // Activation function
-#ifdef ACTIVATION_LINEAR
-    // Linear (MEANS NONE)
-    output[k] = clamp_to_number_t(output_acc);
-#elif defined(ACTIVATION_RELU)
-    // ReLU
-    if (output_acc < 0)
-      output[k] = 0;
-    else
-      output[k] = clamp_to_number_t(output_acc);
+    conv1d_6_t::forward_batch(
+      step,
+      max_pooling1d_6_output,
+      conv1d_6_kernel,
+      conv1d_6_bias,
+      conv1d_6_output
+    );
+
+    // flatten_2 is a noop, conv1d_6_output and flatten_2_output share storage
+
+#if MODEL_SPARSE_DENSE
+    dense_4_sparse_t::forward_batch(
+      step,
+      flatten_2_output,
+      dense_4_sparse_values,
+      dense_4_sparse_deltas,
+      dense_4_sparse_counts,
+      dense_4_bias,
+      output
+    );
+#else
+    dense_4_t::forward_batch(
+      step,
+      flatten_2_output,
+      dense_4_kernel,
+      dense_4_bias,
+      output
+    );
 #endif
   }
 }
 
-#undef INPUT_SAMPLES
-#undef FC_UNITS
-#undef ACTIVATION_LINEAR
+#if MODEL_EARLY_EXIT
+model_early_exit_t model_early_exit;
+
+void model_early_exit_reset(void) {
+  model_early_exit.inferences = 0;
+  model_early_exit.rows = 0;
+}
+
+bool cnn_decide(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t threshold) {
+
+  max_pooling1d_6_t::output_type max_pooling1d_6_output;
+  unsigned int rows;
+
+  max_pooling1d_6_t::forward(input, max_pooling1d_6_output);
+  bool decision = conv1d_6_dense_4_early_exit_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias,
+    conv1d_6_dense_4_order,
+    conv1d_6_negative,
+    conv1d_6_positive,
+    dense_4_negative,
+    dense_4_positive,
+    threshold,
+    &rows
+  );
+  model_early_exit.inferences++;
+  model_early_exit.rows += rows;
+  return decision;
+}
+#endif
+
+void cnn_stream(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_stream_t *stream) {
+
+  cnn_stream_layers_t::forward(
+    input,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias,
+    output,
+    stream
+  );
+}
+
+void cnn_stream_reset(cnn_stream_t *stream) {
+  cnn_stream_layers_t::reset(stream);
+}
+
 /**
   ******************************************************************************
-  * @file    weights/fc.cc
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    24 march 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
+  * @file    layers_int8.h
+  * @brief   int8 counterpart of layers.h: int8 weights and activations, int32 accumulation and a requantization
+  *          multiplier and shift per output channel, derived from activation statistics by main --calibrate
   */
 
-#define INPUT_SAMPLES 1664
-#define FC_UNITS 1
+#ifndef __LAYERS_INT8_H__
+#define __LAYERS_INT8_H__
 
+#ifndef SINGLE_FILE
+#include "number.h"
+#include "mac.h"
+#include "layers.h"
+#endif
 
-const int16_t dense_4_bias[FC_UNITS] = {-29}
-;
+// Activations and weights stay in [-127, 127] so that mac_dot_int8() can use its vectorized paths
+#define INT8_MAX_VALUE 127
 
-const int16_t dense_4_kernel[FC_UNITS][INPUT_SAMPLES] = {{-22, -8, 1, -41, -24, 40, 41, 24, 20, 1, -39, -4, -15, 14, 0, 0, -19, 45, 16, -8, 9, 39, 3, -2, 26, 28, -73, -21, 67, -58, -39, 11, -6, -17, 19, 22, -20, -39, -30, -60, 33, 33, -14, 37, 1, -48, -5, 40, 57, 148, -13, -35, -64, 25, -16, 32, -128, 49, -38, 29, -62, 24, 27, -78, -26, 89, 54, 40, -68, -47, 71, -135, -140, 117, 100, 28, -77, 11, 66, 38, -13, 11, -17, -12, 5, -12, -20, -34, 24, 28, 19, 17, -10, -1, 50, -35, -25, -6, 14, 64, 12, 7, -28, 56, -24, 5, 20, 17, -15, -11, 30, 10, 58, 63, 10, 35, 19, -53, 26, 33, 51, 103, 45, -58, -119, -109, 17, 23, 0, 65, -9, 31, -65, -44, 66, -38, 27, -33, 56, -32, -23, 52, -82, -73, 33, 10, 27, -81, 18, 32, 55, -57, 31, 73, -90, -48, 1, -31, -81, -9, -27, -37, 61, -15, 39, 35, -60, 62, -1, -58, -25, -41, -40, -30, -76, 66, 93, 82, -56, 24, -80, -161, 3, -16, -24, -30, 13, -30, 12, 37, 7, -10, 19, -17, 11, 12, -2, 1, -20, -21, 16, 69, 8, 39, 19, -46, 71, 42, 70, -118, -25, -6, 53, 10, 0, -46, 44, -45, -30, -80, 0, 99, 2, 24, -99, 55, -21, -127, 84, 118, 64, -76, -118, 49, -11, -1, -6, -8, -5, 1, -3, 18, 7, -29, 26, 28, 24, -20, -42, 16, 16, -25, -39, 6, 35, 26, 12, 0, 12, -6, -20, 19, -17, 12, 10, -20, 16, 24, -16, 9, -28, -10, 43, 4, -13, -23, 18, -2, -35, 14, 11, -22, 34, -12, -38, 25, 20, 1, 2, -3, -12, 19, -9, -40, 11, 3, -13, 1, 26, -25, -43, -45, -14, 19, -18, -9, 16, -5, 11, -1, -14, 5, 16, 14, 6, -33, -7, 23, 15, 13, -26, 44, -13, -8, 7, 25, 43, 6, -55, -11, 37, -40, -15, 11, -14, 37, -15, -11, -24, 34, 10, 2, -5, 15, 11, 8, 28, 16, 16, -8, -26, -28, -69, 32, -11, -50, -29, -29, 10, 7, -17, -46, 28, 6, -20, 103, -79, -5, 22, -38, 0, 3, 4, 43, 7, -70, 8, -84, -10, 42, -37, 22, 33, -55, -74, -35, 10, 30, 145, 41, 145, -41, -24, -80, 107, 3, -42, 23, 104, -132, 5, 13, -36, -12, -3, 11, 130, 10, -96, -30, -89, -108, 76, -56, 106, 21, -3, 38, -6, 30, 20, 16, -15, 6, 14, 29, -7, 26, -26, -30, -53, -18, 28, -10, -5, -30, -19, -16, 10, -6, -14, -22, 22, 10, 16, -27, 26, -2, -18, -45, 6, 21, 26, -15, -38, -20, -2, 29, -7, -34, -25, -20, -40, -4, 0, 45, 1, -50, -21, 15, 18, 15, 1, -50, 11, 18, 10, 16, 30, 0, -35, -7, 24, 0, 3, -67, 33, 12, 4, 35, -5, -7, -8, 49, -17, 1, 7, 11, -28, -29, -15, -31, 14, 21, 18, -7, -28, -26, 9, 19, 15, -23, -10, 18, 20, -4, -7, -7, 8, 14, 92, 69, -3, 10, -76, 16, -26, -10, 5, -47, 31, 13, -13, 32, -62, -3, 29, 6, 15, -15, -64, 25, -3, 20, 72, -120, -18, -25, -5, 8, -20, 19, -5, -6, -33, 13, 17, -25, 39, 7, 15, 21, 11, -24, 29, 11, -5, 2, 28, 38, 7, -55, 17, 12, 38, -34, -7, -10, -26, 56, -22, -4, 14, -22, -30, -4, 87, -43, -5, 56, -149, 69, -15, 42, -7, -86, -1, -77, -10, -10, 17, 26, 23, -21, -33, -5, -11, -38, 7, 35, -38, 57, -23, -8, 19, -17, -27, 38, 24, -19, 56, 56, 6, 56, 34, 14, -31, 8, 33, 6, -39, 79, -49, 16, -9, 28, 23, -47, 4, 20, -68, -3, 66, -88, -36, 12, -129, 110, 17, -35, 15, -33, -129, -4, 16, 3, -3, -16, -9, -35, -34, -43, -28, -9, -80, -42, -30, -57, 0, 10, 26, 32, -84, -129, -47, -61, -9, -28, 21, -58, -25, -7, 10, -41, -21, -12, -13, 6, 96, 4, -9, 0, 10, 86, 2, -12, 50, -46, 42, 61, -45, 3, -5, 72, 0, 16, 16, -18, -68, -10, 36, 47, -13, -53, 99, -61, 99, 71, 0, 0, -161, -105, -53, -53, -24, 92, -23, -78, 22, -1, 22, 23, 38, 34, -39, 29, 20, -36, 25, 30, 45, -5, 3, -27, 55, -22, -18, 1, -6, -17, 13, 0, 7, 78, -19, 58, -16, -36, -55, -16, -13, 3, 72, -17, 4, -42, 10, -47, 3, 3, 19, -17, 62, -61, -35, 39, -24, 0, 104, -1, 23, 5, -64, -46, 21, 5, 24, -4, 23, -3, -12, -11, -41, -49, -49, -110, -72, -97, -104, 8, 28, 54, -132, -81, -72, -101, 75, -33, -36, 20, 63, -13, -68, -57, 57, -40, 0, -73, 3, 8, -4, -4, -46, -39, -8, -56, 108, 66, 24, -103, -154, -55, -92, 68, -39, 0, 5, 17, -14, -12, 15, 27, 39, -26, 23, -62, 35, 51, -25, -16, 16, -41, -86, -32, 38, 64, 68, 20, 18, -1, -76, -49, 28, 41, 6, 20, 59, -29, -42, -22, 20, 24, -13, -10, 3, 21, -33, -13, 21, 61, 72, 31, 28, -73, 38, -23, 39, 10, -37, 32, -6, -12, -8, 20, 20, -30, 18, 8, 20, 21, 32, 70, -39, -4, -16, 7, 47, -5, -17, -1, 20, -10, -38, -16, 2, -52, 3, 21, 38, -43, 12, -27, -13, -6, 5, -42, -3, -40, -53, 25, -7, -4, 45, -41, 50, 33, -110, 16, 33, 13, -15, -32, -6, 42, 24, 20, 6, 11, -4, -62, -4, -10, 23, 9, -28, -29, 6, 35, -7, -19, 0, 16, -94, 65, -29, 51, -49, -13, -45, -38, 5, 0, -13, -13, -33, -14, 2, 28, 22, -85, -24, -80, -100, -51, 75, 38, -70, -60, -4, -15, -7, -23, 24, -10, -11, 41, -2, -27, 6, -6, 23, -7, -8, -13, 60, 5, -24, 16, 29, 0, 38, -31, -36, 48, 34, 29, -22, 14, 5, 12, -1, 27, 22, 30, 24, 12, -10, 19, 5, 31, 17, -6, 52, 22, -22, 26, 32, 58, 27, -3, -28, -14, 19, -26, -6, -10, 49, 13, 13, 24, -33, 5, 22, 16, 35, 15, 5, 44, -2, -62, 25, 20, -27, 50, -30, -34, 33, 48, -25, -12, 38, 11, -17, -2, -31, 11, 8, -19, -8, -29, -3, -19, 16, -36, 0, -8, -28, 27, 25, -20, 0, -9, -29, 10, 34, 17, 26, -11, 25, 2, 8, 68, 16, 11, 29, -4, 47, -49, 18, 38, 20, -15, -16, -27, 0, 44, -7, -6, -63, 64, -30, 55, 25, 11, -15, 29, 16, 5, 30, 13, 18, -7, -4, 22, 12, 13, 20, 22, -59, -32, 21, 33, 31, 28, -62, 53, 45, 17, -27, 11, -41, 4, 14, 41, -19, 4, 40, 120, -39, 12, 73, -87, 134, 91, 5, -24, -197, -63, -10, -55, -25, 13, 21, 27, 11, -3, 14, -36, -27, 26, -34, -22, -25, 16, 4, -22, -5, -26, 20, 0, 10, -41, -24, -8, -17, -31, -47, 5, 40, 29, 3, 5, -8, 29, 54, 40, -5, -43, -37, 41, -34, 8, 35, 17, 31, 26, -7, 1, 7, 40, 21, 65, -50, -23, 78, 1, 61, -34, 22, -6, 40, 20, -21, -9, 34, -22, -2, -76, 40, 58, 12, 104, 128, 46, 32, -139, -36, 28, 5, -1, -6, -19, -9, -37, 26, 18, 41, -37, 0, -30, 12, 4, -16, 22, 12, 17, -8, 19, -28, -47, 36, 25, 38, -4, -20, -11, 34, 23, -22, -13, 6, 18, 12, -46, 12, -48, -15, 112, 8, -4, -88, -35, 56, -28, -44, 21, -5, -64, -14, -21, 114, -13, 32, -63, 44, 21, 25, -5, 94, -102, 27, 43, -45, -25, -21, 10, 99, 97, -22, -36, -90, -31, -6, -21, 131, 28, 16, 21, 14, -15, -16, 8, 4, 11, -11, -41, -16, 4, 49, -28, 16, 35, -172, 84, 42, 71, -13, -85, 18, -97, -87, -63, -9, 29, -5, -40, -30, 3, -22, 5, -15, -26, -5, -17, 10, 29, -10, -52, -30, -22, -53, 12, -25, -22, 1, 34, -3, 19, 18, -15, -7, 7, -3, -22, 13, 1, -32, -5, 1, -35, 25, 25, -30, 30, -39, -10, 40, 18, -50, 8, 40, -63, 50, -3, 37, -77, -48, 66, -88, -21, -42, 57, -100, -12, 36, -12, 32, 86, -137, 8, -20, -13, 16, 68, 13, 26, -40, 74, -47, 89, -8, 22, 34, -14, -62, -27, -31, -26, 37, 99, 34, 0, 12, 81, 21, 42, -24, 42, 35, -87, -145, -36, 16, -29, 29, 24, 20, -26, 9, 26, -27, -36, -25, 15, -7, -23, 13, 11, 14, 36, 32, 2, 9, 27, -53, 61, 16, -23, 30, 5, -23, 76, -44, -28, -24, 24, -84, 10, -13, -9, -20, -18, -30, -16, 11, 75, -12, 12, 20, -55, 90, 11, -56, 33, -60, -32, 0, -71, -68, -58, 11, -69, -51, 17, -16, -40, 6, 46, -25, 7, -22, -5, -54, -13, -4, -23, -46, -40, 19, -43, -30, 64, -101, 45, 25, 14, 2, -15, 39, -79, 48, -32, -57, 2, 29, 2, -16, 58, 109, 46, -34, 78, -64, 102, -31, -62, 40, -9, 4, -66, -25, -5, 19, 9, -29, 0, 7, 58, -46, -16, -8, -22, 12, 8, 11, 18, 56, -21, 31, 11, -26, 63, -55, 57, -37, -78, -19, -30, 1, 30, -13, -29, 3, -15, -2, 8, -16, -26, -19, 2, -33, -6, -3, -49, 35, -30, -4, -5, -9, -28, 18, -11, -148, -22, 45, -16, -57, 19, 8, 4, 5, 51, 8, -19, 35, 48, -68, 44, 8, -3, 9, 57, 20, -58, 14, -30, 20, 60, 59, 68, -75, 74, 25, -34, -10, 103, -143, -22, 53, -19, 40, -61, -18, 142, 114, 15, 54, -11, -54, -17, -135, 39, -35, -68}
+// acc * multiplier * 2^(shift - 31) rounded to nearest, multiplier in [2^30, 2^31) and shift in [-31, 30].
+// Same arithmetic as the calibration so that the host and the MCU agree bit for bit
+static inline int32_t requantize(int32_t acc, int32_t multiplier, int shift) {
+  int total = 31 - shift;
+  return (int32_t)(((int64_t)acc * multiplier + ((int64_t)1 << (total - 1))) >> total);
 }
-;
 
-#undef INPUT_SAMPLES
-#undef FC_UNITS
+template<Activation Act>
+static inline int8_t activate_int8(int32_t acc) {
+  int32_t low = Act == Activation::ReLU ? 0 : -INT8_MAX_VALUE;
+  return (int8_t)(acc < low ? low : acc > INT8_MAX_VALUE ? INT8_MAX_VALUE : acc);
+}
+
+// number_t activations to int8 with one scale for the whole tensor
+template<unsigned int Channels, unsigned int Samples>
+struct QuantizeInt8 {
+  typedef number_t input_type[Channels][Samples];
+  typedef int8_t output_type[Channels][Samples];
+
+  static inline void forward(const input_type input, int32_t multiplier, int shift, output_type output) {
+    for (unsigned int c = 0; c < Channels; c++)
+      for (unsigned int x = 0; x < Samples; x++)
+        output[c][x] = activate_int8<Activation::Linear>(requantize(input[c][x], multiplier, shift));
+  }
+};
+
+// Unpadded unit-stride convolution, the int32 bias is already at the scale of the accumulator of its filter
+template<unsigned int InChannels, unsigned int InSamples, unsigned int ConvFilters, unsigned int KernelSize, Activation Act>
+struct Conv1DInt8 {
+  static constexpr unsigned int InputChannels = InChannels;
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Filters = ConvFilters;
+  static constexpr unsigned int OutputSamples = InSamples - KernelSize + 1;
+  static constexpr uint32_t MACs = ConvFilters * OutputSamples * InChannels * KernelSize;
+
+  typedef int8_t input_type[InChannels][InSamples];
+  typedef int8_t kernel_type[ConvFilters][InChannels][KernelSize];
+  typedef int32_t bias_type[ConvFilters];
+  typedef int32_t multiplier_type[ConvFilters];
+  typedef int8_t shift_type[ConvFilters];
+  typedef int8_t output_type[ConvFilters][OutputSamples];
+
+  static inline void forward_row(const input_type input, const int8_t kernel[InChannels][KernelSize], int32_t bias, int32_t multiplier, int shift, int8_t output[OutputSamples]) {
+    int32_t output_acc[OutputSamples];
+
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output_acc[pos_x] = bias;
+    for (unsigned int z = 0; z < InChannels; z++)
+      mac_conv1d_int8(input[z], kernel[z], KernelSize, OutputSamples, output_acc);
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output[pos_x] = activate_int8<Act>(requantize(output_acc[pos_x], multiplier, shift));
+  }
+
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, const multiplier_type multiplier, const shift_type shift, output_type output) {
+    for (unsigned int k = 0; k < ConvFilters; k++)
+      forward_row(input, kernel[k], bias[k], multiplier[k], shift[k], output[k]);
+  }
+};
+
+// The output is requantized to number_t: this is the last layer and the model output keeps its format
+template<unsigned int InSamples, unsigned int FcUnits, Activation Act>
+struct DenseInt8 {
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Units = FcUnits;
+  static constexpr uint32_t MACs = InSamples * FcUnits;
+
+  typedef int8_t input_type[InSamples];
+  typedef int8_t kernel_type[FcUnits][InSamples];
+  typedef int32_t bias_type[FcUnits];
+  typedef int32_t multiplier_type[FcUnits];
+  typedef int8_t shift_type[FcUnits];
+  typedef number_t output_type[FcUnits];
+
+  static inline number_t output_value(int32_t acc, int32_t multiplier, int shift) {
+    return activate<Act>(requantize(acc, multiplier, shift));
+  }
+
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, const multiplier_type multiplier, const shift_type shift, output_type output) {
+    for (unsigned int k = 0; k < FcUnits; k++)
+      output[k] = output_value(bias[k] + mac_dot_int8(input, kernel[k], InSamples), multiplier[k], shift[k]);
+  }
+};
+
+// Conv1DInt8 -> Flatten -> DenseInt8 fused like ConvDense, one row of int8 conv outputs at a time
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDenseInt8 {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs;
+
+  static inline void forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename ConvLayer::multiplier_type conv_multiplier,
+    const typename ConvLayer::shift_type conv_shift,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    const typename DenseLayer::multiplier_type fc_multiplier,
+    const typename DenseLayer::shift_type fc_shift,
+    typename DenseLayer::output_type output) {
+
+    int8_t conv_row[ConvLayer::OutputSamples];
+    int32_t fc_acc[DenseLayer::Units];
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      fc_acc[u] = fc_bias[u];
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_multiplier[k], conv_shift[k], conv_row);
+      for (unsigned int u = 0; u < DenseLayer::Units; u++)
+        fc_acc[u] += mac_dot_int8(conv_row, &fc_kernel[u][k * ConvLayer::OutputSamples], ConvLayer::OutputSamples);
+    }
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_multiplier[u], fc_shift[u]);
+  }
+};
+
+#endif//__LAYERS_INT8_H__
+
 /**
   ******************************************************************************
-  * @file    model.hh
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    08 july 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
+  * @file    model_int8.h
+  * @brief   int8 variant of the model of model.h, weights from weights/conv1d_6_int8.c and weights/dense_4_int8.c
+  *          written by main --calibrate on the training set. They are not committed: cnn_int8() and cnn_int8_r()
+  *          only exist once they are generated, which sets MODEL_INT8_CALIBRATED
   */
 
-#ifndef __MODEL_H__
-#define __MODEL_H__
+#ifndef __MODEL_INT8_H__
+#define __MODEL_INT8_H__
 
 #ifndef SINGLE_FILE
-#include "number.h"
+#include "model.h"
+#include "layers_int8.h"
+
+#if defined(__has_include)
+#if __has_include("weights/conv1d_6_int8.c") && __has_include("weights/dense_4_int8.c")
+#define MODEL_INT8_CALIBRATED 1 // Also defined by weights/conv1d_6_int8.c for single-file builds
+#endif
+#endif
 #endif
 
-#define MODEL_OUTPUT_SAMPLES 1
-#define MODEL_INPUT_SAMPLES 100 // node 0 is InputLayer so use its output shape as input shape of the model
-#define MODEL_INPUT_CHANNELS 1
+// Model layers, the input is pooled as number_t then quantized: max pooling commutes with the rounding
+typedef QuantizeInt8<MODEL_INPUT_CHANNELS, max_pooling1d_6_t::OutputSamples> quantize_int8_t;
+typedef Conv1DInt8<MODEL_INPUT_CHANNELS, max_pooling1d_6_t::OutputSamples, 64, 8, Activation::ReLU> conv1d_6_int8_t;
+typedef DenseInt8<conv1d_6_int8_t::Filters * conv1d_6_int8_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_4_int8_t;
+typedef ConvDenseInt8<conv1d_6_int8_t, dense_4_int8_t> conv1d_6_dense_4_int8_t;
 
-void cnn(
+// conv1d_6 and dense_4 always run fused, only the pooled and quantized inputs are stored
+typedef ArenaPlan<
+  sizeof(max_pooling1d_6_t::output_type),
+  sizeof(quantize_int8_t::output_type)
+> model_int8_arena_plan_t;
+
+#define MODEL_INT8_ARENA_SIZE (model_int8_arena_plan_t::bytes)
+
+typedef struct {
+  alignas(ARENA_ALIGNMENT) uint8_t arena[MODEL_INT8_ARENA_SIZE];
+} cnn_int8_activations_t;
+
+// Same input and output format as cnn(), the output is requantized to number_t
+void cnn_int8(
   const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
-  //dense_4_output_type dense_4_output);
   number_t output[MODEL_OUTPUT_SAMPLES]);
 
-#endif//__MODEL_H__
+void cnn_int8_r(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_int8_activations_t *activations);
+
+#endif//__MODEL_INT8_H__
+
 /**
   ******************************************************************************
-  * @file    model.cc
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    24 march 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
+  * @file    model_int8.c
+  * @brief   int8 inference with the calibrated weights of weights/conv1d_6_int8.c and weights/dense_4_int8.c
   */
 
 #ifndef SINGLE_FILE
-#include "number.h"
+#include "model_int8.h"
+#endif
+
+#if MODEL_INT8_CALIBRATED
+#ifndef SINGLE_FILE
+#include "weights/conv1d_6_int8.c"
+#include "weights/dense_4_int8.c"
+#endif
+
+void cnn_int8_r(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_int8_activations_t *activations) {
+
+  max_pooling1d_6_t::output_type &max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type>(activations->arena, model_int8_arena_plan_t::offset(0));
+  quantize_int8_t::output_type &quantize_output =
+    arena_tensor<quantize_int8_t::output_type>(activations->arena, model_int8_arena_plan_t::offset(1));
+
+  max_pooling1d_6_t::forward(
+    input,
+    max_pooling1d_6_output
+  );
+  quantize_int8_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_int8_input_multiplier,
+    conv1d_6_int8_input_shift,
+    quantize_output
+  );
+  // conv1d_6 -> flatten_2 -> dense_4 fused, output requantized to number_t
+  conv1d_6_dense_4_int8_t::forward(
+    quantize_output,
+    conv1d_6_int8_kernel,
+    conv1d_6_int8_bias,
+    conv1d_6_int8_multiplier,
+    conv1d_6_int8_shift,
+    dense_4_int8_kernel,
+    dense_4_int8_bias,
+    dense_4_int8_multiplier,
+    dense_4_int8_shift,
+    output
+  );
+}
+
+void cnn_int8(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES]) {
+
+  static cnn_int8_activations_t activations;
+
+  cnn_int8_r(input, output, &activations);
+}
+#endif//MODEL_INT8_CALIBRATED
+
+/**
+  ******************************************************************************
+  * @file    model_blob.h
+  * @brief   Versioned binary model: a header, one descriptor per layer and aligned weight sections, so that retrained
+  *          weights of the architecture of model.h can be loaded at run time instead of being compiled in. The
+  *          inference reads the weights where the blob lies, mapped from a file on Linux or in flash on the board
+  */
+
+#ifndef __MODEL_BLOB_H__
+#define __MODEL_BLOB_H__
+
+#include <stddef.h>
+
+#ifndef SINGLE_FILE
 #include "model.h"
+#endif
 
- // InputLayer is excluded
-#include "max_pooling1d_6.c" // InputLayer is excluded
-#include "conv1d_6.c"
-#include "weights/conv1d_6.c" // InputLayer is excluded
-#include "flatten_2.c" // InputLayer is excluded
-#include "dense_4.c"
-#include "weights/dense_4.c"
+#define MODEL_BLOB_MAGIC "GSCM"
+#define MODEL_BLOB_VERSION 1
+#define MODEL_BLOB_ALIGNMENT 16 // Of the blob and of every weight section, enough for the vector loads of mac.h
+
+// Values in the byte order of the target, little-endian on both the host and the STM32L4
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t size; // Whole blob in bytes, header included
+  uint32_t checksum; // FNV-1a of the bytes after the header
+  int32_t fixed_point;
+  uint32_t number_size; // sizeof(number_t) of the weights
+  uint32_t input_channels;
+  uint32_t input_samples;
+  uint32_t output_samples;
+  uint32_t layers; // Descriptors following the header, in execution order
+  char name[24]; // NUL-terminated, for logs
+} model_blob_header_t;
+
+typedef enum {
+  MODEL_BLOB_MAX_POOLING1D = 1,
+  MODEL_BLOB_CONV1D = 2,
+  MODEL_BLOB_FLATTEN = 3,
+  MODEL_BLOB_DENSE = 4,
+} model_blob_layer_type_t;
+
+// Unused fields are 0, sections are given by their offset from the start of the blob
+typedef struct {
+  uint32_t type; // model_blob_layer_type_t
+  uint32_t activation; // 0 linear, 1 ReLU
+  uint32_t input_channels; // Dense: 1
+  uint32_t input_samples;
+  uint32_t units; // Conv filters or dense units
+  uint32_t size; // Pool or kernel size
+  uint32_t stride;
+  uint32_t padding_left;
+  uint32_t padding_right;
+  uint32_t weights_offset;
+  uint32_t weights_bytes;
+  uint32_t bias_offset;
+  uint32_t bias_bytes;
+  uint32_t reserved[3];
+} model_blob_layer_t;
+
+// Descriptors of the layers of layers.h, without their sections
+template<typename PoolLayer>
+static inline model_blob_layer_t model_blob_pool_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_MAX_POOLING1D;
+  layer.activation = PoolLayer::OutputActivation == Activation::ReLU;
+  layer.input_channels = PoolLayer::InputChannels;
+  layer.input_samples = PoolLayer::InputSamples;
+  layer.size = PoolLayer::Size;
+  layer.stride = PoolLayer::Stride;
+  return layer;
+}
+
+template<typename ConvLayer>
+static inline model_blob_layer_t model_blob_conv_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_CONV1D;
+  layer.activation = ConvLayer::OutputActivation == Activation::ReLU;
+  layer.input_channels = ConvLayer::InputChannels;
+  layer.input_samples = ConvLayer::InputSamples;
+  layer.units = ConvLayer::Filters;
+  layer.size = ConvLayer::Size;
+  layer.stride = ConvLayer::Stride;
+  layer.padding_left = ConvLayer::PaddingLeft;
+  layer.padding_right = ConvLayer::PaddingRight;
+  layer.weights_bytes = sizeof(typename ConvLayer::kernel_type);
+  layer.bias_bytes = sizeof(typename ConvLayer::bias_type);
+  return layer;
+}
+
+// Flatten of the output of ConvLayer
+template<typename ConvLayer>
+static inline model_blob_layer_t model_blob_flatten_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_FLATTEN;
+  layer.input_channels = ConvLayer::Filters;
+  layer.input_samples = ConvLayer::OutputSamples;
+  return layer;
+}
+
+template<typename DenseLayer>
+static inline model_blob_layer_t model_blob_dense_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_DENSE;
+  layer.activation = DenseLayer::OutputActivation == Activation::ReLU;
+  layer.input_channels = 1;
+  layer.input_samples = DenseLayer::InputSamples;
+  layer.units = DenseLayer::Units;
+  layer.weights_bytes = sizeof(typename DenseLayer::kernel_type);
+  layer.bias_bytes = sizeof(typename DenseLayer::bias_type);
+  return layer;
+}
+
+// Weights of a validated blob, pointers into the blob itself
+typedef struct {
+  const model_blob_header_t *header;
+  const conv1d_6_t::kernel_type *conv1d_6_kernel;
+  const conv1d_6_t::bias_type *conv1d_6_bias;
+  const dense_4_t::kernel_type *dense_4_kernel;
+  const dense_4_t::bias_type *dense_4_bias;
+} model_blob_t;
+
+// FNV-1a, 32 bits
+uint32_t model_blob_checksum(const void *data, size_t size);
+
+// Layer descriptors of the architecture compiled into model.h, without their sections
+void model_blob_expected_layers(model_blob_layer_t layers[4]);
+
+// Check that the blob at data is complete, uncorrupted and has exactly the layers of model.h, then point model at its
+// weights. Returns an error message or NULL on success. The blob must stay in place while model is used
+const char *model_blob_open(const void *data, size_t size, model_blob_t *model);
+
+// cnn_r() with the weights of the blob
+void cnn_blob_r(
+  const model_blob_t *model,
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_activations_t *activations);
+
+#endif//__MODEL_BLOB_H__
+
+/**
+  ******************************************************************************
+  * @file    model_blob.c
+  * @brief   Validation of model blobs against the architecture of model.h and inference on their weights
+  */
+
+#include <string.h>
+
+#ifndef SINGLE_FILE
+#include "model_blob.h"
 #endif
 
-void cnn(
+static_assert(sizeof(model_blob_header_t) == 64, "model_blob_header_t is part of the file format");
+static_assert(sizeof(model_blob_layer_t) == 64, "model_blob_layer_t is part of the file format");
+
+uint32_t model_blob_checksum(const void *data, size_t size) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++)
+    hash = (hash ^ p[i]) * 16777619u;
+  return hash;
+}
+
+void model_blob_expected_layers(model_blob_layer_t layers[4]) {
+  layers[0] = model_blob_pool_layer<max_pooling1d_6_t>();
+  layers[1] = model_blob_conv_layer<conv1d_6_t>();
+  layers[2] = model_blob_flatten_layer<conv1d_6_t>();
+  layers[3] = model_blob_dense_layer<dense_4_t>();
+}
+
+// Section inside the blob and aligned, empty ones must have a zero offset
+static bool model_blob_section_valid(uint32_t offset, uint32_t bytes, uint32_t size) {
+  if (bytes == 0)
+    return offset == 0;
+  return offset % MODEL_BLOB_ALIGNMENT == 0 && offset >= sizeof(model_blob_header_t) && offset <= size && bytes <= size - offset;
+}
+
+const char *model_blob_open(const void *data, size_t size, model_blob_t *model) {
+  const uint8_t *base = (const uint8_t *)data;
+  const model_blob_header_t *header = (const model_blob_header_t *)data;
+  model_blob_layer_t expected[4];
+
+  if ((uintptr_t)data % MODEL_BLOB_ALIGNMENT)
+    return "misaligned blob";
+  if (size < sizeof(model_blob_header_t))
+    return "truncated header";
+  if (memcmp(header->magic, MODEL_BLOB_MAGIC, sizeof(header->magic)))
+    return "not a model blob";
+  if (header->version != MODEL_BLOB_VERSION)
+    return "unsupported model blob version";
+  if (header->size < sizeof(model_blob_header_t) || header->size > size)
+    return "truncated blob";
+  if (header->checksum != model_blob_checksum(base + sizeof(model_blob_header_t), header->size - sizeof(model_blob_header_t)))
+    return "checksum mismatch";
+  if (header->fixed_point != FIXED_POINT || header->number_size != sizeof(number_t))
+    return "fixed-point format does not match the model";
+  if (header->input_channels != MODEL_INPUT_CHANNELS || header->input_samples != MODEL_INPUT_SAMPLES
+      || header->output_samples != MODEL_OUTPUT_SAMPLES)
+    return "input or output shape does not match the model";
+  if (header->layers != 4 || (header->size - sizeof(model_blob_header_t)) / sizeof(model_blob_layer_t) < 4)
+    return "layers do not match the model";
+
+  const model_blob_layer_t *layers = (const model_blob_layer_t *)(base + sizeof(model_blob_header_t));
+  model_blob_expected_layers(expected);
+  for (unsigned int i = 0; i < 4; i++) {
+    if (!model_blob_section_valid(layers[i].weights_offset, layers[i].weights_bytes, header->size)
+        || !model_blob_section_valid(layers[i].bias_offset, layers[i].bias_bytes, header->size))
+      return "invalid weight section";
+
+    // Same descriptor once the section offsets, which depend on the file, are left out
+    model_blob_layer_t layer = layers[i];
+    layer.weights_offset = 0;
+    layer.bias_offset = 0;
+    if (memcmp(&layer, &expected[i], sizeof(layer)))
+      return "layers do not match the model";
+  }
+
+  model->header = header;
+  model->conv1d_6_kernel = (const conv1d_6_t::kernel_type *)(base + layers[1].weights_offset);
+  model->conv1d_6_bias = (const conv1d_6_t::bias_type *)(base + layers[1].bias_offset);
+  model->dense_4_kernel = (const dense_4_t::kernel_type *)(base + layers[3].weights_offset);
+  model->dense_4_bias = (const dense_4_t::bias_type *)(base + layers[3].bias_offset);
+  return NULL;
+}
+
+void cnn_blob_r(
+  const model_blob_t *model,
   const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
-  dense_4_output_type dense_4_output) {
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_activations_t *activations) {
 
-  // Output array allocation
-  static union {
-    max_pooling1d_6_output_type max_pooling1d_6_output;
-  } activations1;
-
-  static union {
-    conv1d_6_output_type conv1d_6_output;
-    flatten_2_output_type flatten_2_output;
-  } activations2;
-
-
-  //static union {
-//
-//    static input_5_output_type input_5_output;
-//
-//    static max_pooling1d_6_output_type max_pooling1d_6_output;
-//
-//    static conv1d_6_output_type conv1d_6_output;
-//
-//    static flatten_2_output_type flatten_2_output;
-//
-  //} activations;
+  max_pooling1d_6_t::output_type &max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(MAX_POOLING1D_6_OUTPUT));
 
-  // Model layers call chain
- // InputLayer is excluded 
-  max_pooling1d_6(
-     // First layer uses input passed as model parameter
+  max_pooling1d_6_t::forward(
     input,
-    activations1.max_pooling1d_6_output
+    max_pooling1d_6_output
   );
- // InputLayer is excluded 
-  conv1d_6(
-    
-    activations1.max_pooling1d_6_output,
-    conv1d_6_kernel,
-    conv1d_6_bias,
-    activations2.conv1d_6_output
+#if MODEL_FUSED_CONV_DENSE
+  conv1d_6_dense_4_t::forward(
+    max_pooling1d_6_output,
+    *model->conv1d_6_kernel,
+    *model->conv1d_6_bias,
+    *model->dense_4_kernel,
+    *model->dense_4_bias,
+    output
   );
- // InputLayer is excluded 
-  flatten_2(
-    
-    activations2.conv1d_6_output,
-    activations2.flatten_2_output
+#else
+  conv1d_6_t::output_type &conv1d_6_output =
+    arena_tensor<conv1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(CONV1D_6_OUTPUT));
+
+  conv1d_6_t::forward(
+    max_pooling1d_6_output,
+    *model->conv1d_6_kernel,
+    *model->conv1d_6_bias,
+    conv1d_6_output
   );
- // InputLayer is excluded 
-  dense_4(
-    
-    activations2.flatten_2_output,
-    dense_4_kernel,
-    dense_4_bias, // Last layer uses output passed as model parameter
-    dense_4_output
+  // flatten_2 is a noop, dense_4 reads conv1d_6_output in place
+  dense_4_t::forward(
+    reinterpret_cast<const flatten_2_t::output_type &>(conv1d_6_output),
+    *model->dense_4_kernel,
+    *model->dense_4_bias,
+    output
   );
-
+#endif
 }
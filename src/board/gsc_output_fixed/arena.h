@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file    arena.h
+  * @brief   Static placement of the intermediate activations of a chain of layers into a single arena
+  */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARENA_ALIGNMENT 4 // Every tensor starts on a word boundary
+
+// Tensor i is written by layer i and read by layer i + 1, so only neighbours are ever live at the same time.
+// Even tensors are placed at the bottom of the arena and odd tensors at the top (ping-pong), which gives an
+// arena of max(size[i] + size[i + 1]) bytes: the minimum for a chain, computed at compile time.
+template<size_t... TensorSizes>
+struct ArenaPlan {
+  static_assert(sizeof...(TensorSizes) > 0, "Empty arena plan");
+
+  static constexpr unsigned int tensors = sizeof...(TensorSizes);
+  static constexpr size_t sizes[sizeof...(TensorSizes)] = {TensorSizes...};
+
+  static constexpr size_t aligned(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+  }
+
+  static constexpr size_t peak(unsigned int i = 0) {
+    return i + 1 >= tensors ? aligned(sizes[i])
+         : aligned(sizes[i]) + aligned(sizes[i + 1]) > peak(i + 1) ? aligned(sizes[i]) + aligned(sizes[i + 1])
+         : peak(i + 1);
+  }
+
+  static constexpr size_t bytes = peak();
+
+  static constexpr size_t offset(unsigned int i) {
+    return i % 2 ? bytes - aligned(sizes[i]) : 0;
+  }
+};
+
+template<size_t... TensorSizes>
+constexpr size_t ArenaPlan<TensorSizes...>::sizes[sizeof...(TensorSizes)];
+
+// View of one planned tensor inside an arena
+template<typename T>
+static inline T &arena_tensor(uint8_t *arena, size_t offset) {
+  return *reinterpret_cast<T *>(arena + offset);
+}
+
+#endif//__ARENA_H__
@@ -1,89 +0,0 @@
-/**
-  ******************************************************************************
-  * @file    conv.cc
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    24 march 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
-  */
-
-#ifndef SINGLE_FILE
-#include "number.h"
-#endif
-
-#define INPUT_CHANNELS      1
-#define INPUT_SAMPLES       33
-#define CONV_FILTERS        64
-#define CONV_KERNEL_SIZE    8
-#define CONV_STRIDE         1
-
-#define ZEROPADDING_LEFT    0
-#define ZEROPADDING_RIGHT   0
-
-#define CONV_OUTSAMPLES     ( ( (INPUT_SAMPLES - CONV_KERNEL_SIZE + ZEROPADDING_LEFT + ZEROPADDING_RIGHT) / CONV_STRIDE ) + 1 )
-
-#define ACTIVATION_RELU
-
-typedef number_t conv1d_6_output_type[CONV_FILTERS][CONV_OUTSAMPLES];
-
-static inline void conv1d_6(
-  const number_t input[INPUT_CHANNELS][INPUT_SAMPLES],               // IN
-  const number_t kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE], // IN
-
-  const number_t bias[CONV_FILTERS],						                // IN
-
-  number_t output[CONV_FILTERS][CONV_OUTSAMPLES]) {               // OUT
-
-  unsigned short pos_x, z, k; 	// loop indexes for output volume
-  unsigned short x;
-  short input_x;
-  long_number_t	kernel_mac;
-  static long_number_t	output_acc[CONV_OUTSAMPLES];
-  long_number_t tmp;
-
-  for (k = 0; k < CONV_FILTERS; k++) { 
-    for (pos_x = 0; pos_x < CONV_OUTSAMPLES; pos_x++) { 
-      output_acc[pos_x] = 0;
-	    for (z = 0; z < INPUT_CHANNELS; z++) {
-
-        kernel_mac = 0; 
-        for (x = 0; x < CONV_KERNEL_SIZE; x++) {
-          input_x = pos_x * CONV_STRIDE - ZEROPADDING_LEFT + x;
-          if (input_x < 0 || input_x >= INPUT_SAMPLES) // ZeroPadding1D
-            tmp = 0;
-          else
-            tmp = input[z][input_x] * kernel[k][z][x]; 
-          kernel_mac = kernel_mac + tmp; 
-        }
-
-	      output_acc[pos_x] = output_acc[pos_x] + kernel_mac; 
-      }
-      output_acc[pos_x] = scale_number_t(output_acc[pos_x]);
-
-      output_acc[pos_x] = output_acc[pos_x] + bias[k]; 
-
-    }
-
-    for (pos_x = 0; pos_x < CONV_OUTSAMPLES; pos_x++) {
-#ifdef ACTIVATION_LINEAR
-      output[k][pos_x] = clamp_to_number_t(output_acc[pos_x]);
-#elif defined(ACTIVATION_RELU)
-      // Activation function: ReLU
-      if (output_acc[pos_x] < 0)
-        output[k][pos_x] = 0;
-      else
-        output[k][pos_x] = clamp_to_number_t(output_acc[pos_x]);
-#endif
-    }
-  }
-}
-
-#undef INPUT_CHANNELS
-#undef INPUT_SAMPLES
-#undef CONV_FILTERS
-#undef CONV_KERNEL_SIZE
-#undef CONV_STRIDE
-#undef ZEROPADDING_LEFT
-#undef ZEROPADDING_RIGHT
-#undef CONV_OUTSAMPLES
-#undef ACTIVATION_RELU
\ No newline at end of file
@@ -1,57 +0,0 @@
-/**
-  ******************************************************************************
-  * @file    fc.cc
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    24 march 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
-  */
-
-#ifndef SINGLE_FILE
-#include "number.h"
-#endif
-
-#define INPUT_SAMPLES 832
-#define FC_UNITS 1
-#define ACTIVATION_LINEAR
-
-typedef number_t dense_2_output_type[FC_UNITS];
-
-static inline void dense_2(
-  const number_t input[INPUT_SAMPLES], 			      // IN
-	const number_t kernel[FC_UNITS][INPUT_SAMPLES],  // IN
-
-	const number_t bias[FC_UNITS],			              // IN
-
-	number_t output[FC_UNITS]) {			                // OUT
-
-  unsigned short k, z; 
-  long_number_t output_acc; 
-
-  for (k = 0; k < FC_UNITS; k++) { 
-    output_acc = 0; 
-    for (z = 0; z < INPUT_SAMPLES; z++) 
-      output_acc = output_acc + ( kernel[k][z] * input[z] ); 
-
-    output_acc = scale_number_t(output_acc);
-
-    output_acc = output_acc + bias[k]; 
-
-
-    // Activation function
-#ifdef ACTIVATION_LINEAR
-    // Linear (MEANS NONE)
-    output[k] = clamp_to_number_t(output_acc);
-#elif defined(ACTIVATION_RELU)
-    // ReLU
-    if (output_acc < 0)
-      output[k] = 0;
-    else
-      output[k] = clamp_to_number_t(output_acc);
-#endif
-  }
-}
-
-#undef INPUT_SAMPLES
-#undef FC_UNITS
-#undef ACTIVATION_LINEAR
\ No newline at end of file
@@ -1,23 +0,0 @@
-/**
-  ******************************************************************************
-  * @file    flatten.cc
-  * @author  Pierre-Emmanuel Novac <penovac@unice.fr>, LEAT, CNRS, Université Côte d'Azur, France
-  * @version 1.0.0
-  * @date    24 march 2020
-  * @brief   Template generating plain C code for the implementation of Convolutional Neural Networks on MCU
-  */
-
-#ifndef SINGLE_FILE
-#include "number.h"
-#endif
-
-#define INPUT_DIM [26][64]
-#define OUTPUT_DIM 1664
-
-//typedef number_t *flatten_output_type;
-typedef number_t flatten_output_type[OUTPUT_DIM];
-
-#define flatten //noop (IN, OUT)  OUT = (number_t*)IN
-
-#undef INPUT_DIM
-#undef OUTPUT_DIM
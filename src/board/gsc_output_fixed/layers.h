@@ -0,0 +1,535 @@
+/**
+  ******************************************************************************
+  * @file    layers.h
+  * @brief   Header-only fixed-point layer library, shapes and activations are template parameters so that the
+  *          compiler can unroll the kernels and drop the padding and activation branches that do not apply
+  */
+
+#ifndef __LAYERS_H__
+#define __LAYERS_H__
+
+#ifndef SINGLE_FILE
+#include "number.h"
+#include "mac.h"
+#endif
+
+enum class Activation {
+  Linear, // Linear (MEANS NONE)
+  ReLU,
+};
+
+template<Activation Act>
+static inline number_t activate(long_number_t acc) {
+  if (Act == Activation::ReLU && acc < 0)
+    return 0;
+  return clamp_to_number_t(acc);
+}
+
+template<unsigned int Channels, unsigned int InSamples, unsigned int PoolSize, unsigned int PoolStride, Activation Act = Activation::Linear>
+struct MaxPool1D {
+  static constexpr unsigned int InputChannels = Channels;
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Size = PoolSize;
+  static constexpr unsigned int Stride = PoolStride;
+  static constexpr unsigned int OutputSamples = (InSamples - PoolSize) / PoolStride + 1; // POOL_PAD unsupported
+  static constexpr uint32_t MACs = 0; // Comparisons only
+  static constexpr Activation OutputActivation = Act;
+
+  typedef number_t input_type[Channels][InSamples];
+  typedef number_t output_type[Channels][OutputSamples];
+
+  static inline void forward(const input_type input, output_type output) {
+    forward_columns(input, output, 0, OutputSamples);
+  }
+
+  // Outputs [first, first + count) only, for sliding windows that keep their older columns
+  static inline void forward_columns(const input_type input, output_type output, unsigned int first, unsigned int count) {
+    for (unsigned int k = 0; k < Channels; k++)
+      for (unsigned int pos_x = first; pos_x < first + count; pos_x++) {
+        // ReLU starts from 0 so that negative maxima are clipped
+        number_t max = Act == Activation::ReLU ? 0 : input[k][pos_x * PoolStride];
+        for (unsigned int x = Act == Activation::ReLU ? 0 : 1; x < PoolSize; x++) {
+          number_t tmp = input[k][pos_x * PoolStride + x];
+          if (max < tmp)
+            max = tmp;
+        }
+        output[k][pos_x] = max;
+      }
+  }
+};
+
+template<unsigned int InChannels, unsigned int InSamples, unsigned int ConvFilters, unsigned int KernelSize, unsigned int ConvStride, Activation Act,
+         unsigned int ZeroPaddingLeft = 0, unsigned int ZeroPaddingRight = 0>
+struct Conv1D {
+  static constexpr unsigned int InputChannels = InChannels;
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Filters = ConvFilters;
+  static constexpr unsigned int Size = KernelSize;
+  static constexpr unsigned int Stride = ConvStride;
+  static constexpr unsigned int PaddingLeft = ZeroPaddingLeft;
+  static constexpr unsigned int PaddingRight = ZeroPaddingRight;
+  static constexpr unsigned int OutputSamples = (InSamples - KernelSize + ZeroPaddingLeft + ZeroPaddingRight) / ConvStride + 1;
+  static constexpr uint32_t MACs = ConvFilters * OutputSamples * InChannels * KernelSize; // Padding included
+  static constexpr Activation OutputActivation = Act;
+
+  typedef number_t input_type[InChannels][InSamples];
+  typedef number_t kernel_type[ConvFilters][InChannels][KernelSize];
+  typedef number_t bias_type[ConvFilters];
+  typedef number_t output_type[ConvFilters][OutputSamples];
+
+  // Activated outputs of one filter
+  static inline void forward_row(const input_type input, const number_t kernel[InChannels][KernelSize], number_t bias, number_t output[OutputSamples]) {
+    long_number_t output_acc[OutputSamples];
+
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output_acc[pos_x] = 0;
+
+    for (unsigned int z = 0; z < InChannels; z++) {
+      if (ZeroPaddingLeft == 0 && ZeroPaddingRight == 0 && ConvStride == 1) {
+        // Windows never leave the input, accumulate the whole row with the vectorized primitive
+        mac_conv1d(input[z], kernel[z], KernelSize, OutputSamples, output_acc);
+      } else {
+        for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+          for (unsigned int x = 0; x < KernelSize; x++) {
+            int input_x = (int)(pos_x * ConvStride + x) - (int)ZeroPaddingLeft;
+            if (input_x >= 0 && input_x < (int)InSamples) // ZeroPadding1D
+              output_acc[pos_x] = output_acc[pos_x] + input[z][input_x] * kernel[z][x];
+          }
+      }
+    }
+
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output[pos_x] = activate<Act>(scale_number_t(output_acc[pos_x]) + bias);
+  }
+
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, output_type output) {
+    for (unsigned int k = 0; k < ConvFilters; k++)
+      forward_row(input, kernel[k], bias[k], output[k]);
+  }
+
+  // Outputs [first, first + count) of every filter only, for sliding windows that keep their older columns
+  static inline void forward_columns(const input_type input, const kernel_type kernel, const bias_type bias, output_type output, unsigned int first, unsigned int count) {
+    static_assert(ZeroPaddingLeft == 0 && ZeroPaddingRight == 0 && ConvStride == 1, "Column updates need an unpadded unit-stride convolution");
+    long_number_t output_acc[OutputSamples];
+
+    for (unsigned int k = 0; k < ConvFilters; k++) {
+      for (unsigned int pos_x = 0; pos_x < count; pos_x++)
+        output_acc[pos_x] = 0;
+      for (unsigned int z = 0; z < InChannels; z++)
+        mac_conv1d(&input[z][first], kernel[k][z], KernelSize, count, output_acc);
+      for (unsigned int pos_x = 0; pos_x < count; pos_x++)
+        output[k][first + pos_x] = activate<Act>(scale_number_t(output_acc[pos_x]) + bias[k]);
+    }
+  }
+
+  // Batched variant, the kernel of each filter is loaded once and applied to every sample of the batch
+  static inline void forward_batch(unsigned int batch, const input_type input[], const kernel_type kernel, const bias_type bias, output_type output[]) {
+    number_t weights[InChannels][KernelSize];
+
+    for (unsigned int k = 0; k < ConvFilters; k++) {
+      for (unsigned int z = 0; z < InChannels; z++)
+        for (unsigned int x = 0; x < KernelSize; x++)
+          weights[z][x] = kernel[k][z][x];
+
+      for (unsigned int b = 0; b < batch; b++)
+        forward_row(input[b], weights, bias[k], output[b][k]);
+    }
+  }
+};
+
+// Flatten is a noop: input and output share storage, OUT = (number_t*)IN
+template<unsigned int Channels, unsigned int Samples>
+struct Flatten {
+  static constexpr unsigned int OutputSamples = Channels * Samples;
+  static constexpr uint32_t MACs = 0;
+
+  typedef number_t input_type[Channels][Samples];
+  typedef number_t output_type[OutputSamples];
+};
+
+template<unsigned int InSamples, unsigned int FcUnits, Activation Act>
+struct Dense {
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Units = FcUnits;
+  static constexpr uint32_t MACs = InSamples * FcUnits;
+  static constexpr Activation OutputActivation = Act;
+
+  typedef number_t input_type[InSamples];
+  typedef number_t kernel_type[FcUnits][InSamples];
+  typedef number_t bias_type[FcUnits];
+  typedef number_t output_type[FcUnits];
+
+  // Scale, bias and activation of one accumulated unit
+  static inline number_t output_value(long_number_t output_acc, number_t bias) {
+    return activate<Act>(scale_number_t(output_acc) + bias);
+  }
+
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, output_type output) {
+    for (unsigned int k = 0; k < FcUnits; k++)
+      output[k] = output_value(mac_dot(kernel[k], input, InSamples), bias[k]);
+  }
+
+  // Batched variant, each weight is loaded once per tile of MAC_MAX_ROWS samples
+  static inline void forward_batch(unsigned int batch, const input_type input[], const kernel_type kernel, const bias_type bias, output_type output[]) {
+    long_number_t output_acc[MAC_MAX_ROWS];
+
+    for (unsigned int b0 = 0; b0 < batch; b0 += MAC_MAX_ROWS) {
+      unsigned int tile = batch - b0 < MAC_MAX_ROWS ? batch - b0 : MAC_MAX_ROWS;
+
+      for (unsigned int k = 0; k < FcUnits; k++) {
+        mac_dot_rows(kernel[k], input[b0], InSamples, tile, InSamples, output_acc);
+        for (unsigned int b = 0; b < tile; b++)
+          output[b0 + b][k] = output_value(output_acc[b], bias[k]);
+      }
+    }
+  }
+};
+
+// Conv1D -> Flatten -> Dense fused: each row of conv outputs is accumulated into the dense units as soon as it is
+// produced, so the flattened conv output is never stored
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDense {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs;
+
+  static inline void forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output) {
+
+    number_t conv_row[ConvLayer::OutputSamples]; // One slice of the flattened conv output
+    long_number_t fc_acc[DenseLayer::Units];
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      fc_acc[u] = 0;
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+
+      // Flatten keeps the [filter][sample] order, this row is dense input k * OutputSamples onwards
+      for (unsigned int u = 0; u < DenseLayer::Units; u++)
+        fc_acc[u] = fc_acc[u] + mac_dot(conv_row, &fc_kernel[u][k * ConvLayer::OutputSamples], ConvLayer::OutputSamples);
+    }
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_bias[u]);
+  }
+};
+
+// ConvDense for a ReLU conv: each row of conv outputs is compacted to the positions of its nonzero values and the dense
+// units only accumulate those, the weights of the zero outputs are never loaded. Returns the nonzero conv outputs
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDenseNonzero {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+  static_assert(ConvLayer::OutputActivation == Activation::ReLU, "Only a ReLU conv has outputs that are zero often enough");
+  static_assert(ConvLayer::OutputSamples <= 256, "Positions in a row are stored in a byte");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs; // Upper bound
+
+  static inline uint32_t forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output) {
+
+    number_t conv_row[ConvLayer::OutputSamples];
+    uint8_t nonzero[ConvLayer::OutputSamples]; // Positions of the nonzero outputs of conv_row
+    long_number_t fc_acc[DenseLayer::Units];
+    uint32_t nonzeros = 0;
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      fc_acc[u] = 0;
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+
+      // Branchless compaction: every position is written, only the nonzero ones are kept
+      unsigned int n = 0;
+      for (unsigned int pos_x = 0; pos_x < ConvLayer::OutputSamples; pos_x++) {
+        nonzero[n] = pos_x;
+        n += conv_row[pos_x] != 0;
+      }
+      nonzeros += n;
+
+      for (unsigned int u = 0; u < DenseLayer::Units; u++) {
+        const number_t *weights = &fc_kernel[u][k * ConvLayer::OutputSamples];
+        long_number_t acc = fc_acc[u];
+        for (unsigned int i = 0; i < n; i++)
+          acc = acc + conv_row[nonzero[i]] * weights[nonzero[i]];
+        fc_acc[u] = acc;
+      }
+    }
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_bias[u]);
+    return nonzeros;
+  }
+};
+
+// Dense with the zero weights left out of the kernel. Each unit stores its nonzero weights in input order, with the
+// distance from the previous one (from input 0 for the first) in one byte: a longer gap is bridged by zero weights
+// 255 inputs apart. counts[u] entries belong to unit u, the units follow each other in values and deltas
+template<unsigned int InSamples, unsigned int FcUnits, Activation Act>
+struct SparseDense {
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Units = FcUnits;
+  static constexpr unsigned int MaxDelta = 255;
+  static constexpr uint32_t MACs = InSamples * FcUnits; // Upper bound, one per stored entry
+
+  typedef number_t input_type[InSamples];
+  typedef uint16_t count_type[FcUnits];
+  typedef number_t bias_type[FcUnits];
+  typedef number_t output_type[FcUnits];
+
+  static inline number_t output_value(long_number_t output_acc, number_t bias) {
+    return activate<Act>(scale_number_t(output_acc) + bias);
+  }
+
+  static inline void forward(const input_type input, const number_t values[], const uint8_t deltas[], const count_type counts, const bias_type bias, output_type output) {
+    for (unsigned int u = 0; u < FcUnits; u++) {
+      long_number_t output_acc = 0;
+      unsigned int index = 0;
+
+      for (unsigned int i = 0; i < counts[u]; i++) {
+        index += deltas[i];
+        output_acc = output_acc + values[i] * input[index];
+      }
+      output[u] = output_value(output_acc, bias[u]);
+      values += counts[u];
+      deltas += counts[u];
+    }
+  }
+
+  // Batched variant, each entry is decoded once per tile of MAC_MAX_ROWS samples
+  static inline void forward_batch(unsigned int batch, const input_type input[], const number_t values[], const uint8_t deltas[], const count_type counts, const bias_type bias, output_type output[]) {
+    long_number_t output_acc[MAC_MAX_ROWS];
+
+    for (unsigned int b0 = 0; b0 < batch; b0 += MAC_MAX_ROWS) {
+      unsigned int tile = batch - b0 < MAC_MAX_ROWS ? batch - b0 : MAC_MAX_ROWS;
+      const number_t *unit_values = values;
+      const uint8_t *unit_deltas = deltas;
+
+      for (unsigned int u = 0; u < FcUnits; u++) {
+        unsigned int index = 0;
+
+        for (unsigned int b = 0; b < tile; b++)
+          output_acc[b] = 0;
+        for (unsigned int i = 0; i < counts[u]; i++) {
+          index += unit_deltas[i];
+          for (unsigned int b = 0; b < tile; b++)
+            output_acc[b] = output_acc[b] + unit_values[i] * input[b0 + b][index];
+        }
+        for (unsigned int b = 0; b < tile; b++)
+          output[b0 + b][u] = output_value(output_acc[b], bias[u]);
+        unit_values += counts[u];
+        unit_deltas += counts[u];
+      }
+    }
+  }
+};
+
+// Conv1D -> Flatten -> SparseDense fused like ConvDense. The entries of each unit are consumed in input order as the
+// conv rows are produced, and a filter is not computed at all when none of its outputs has a weight left
+template<typename ConvLayer, typename DenseLayer>
+struct ConvSparseDense {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs; // Upper bound
+
+  static inline void forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const number_t fc_values[],
+    const uint8_t fc_deltas[],
+    const typename DenseLayer::count_type fc_counts,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output) {
+
+    number_t conv_row[ConvLayer::OutputSamples];
+    long_number_t fc_acc[DenseLayer::Units];
+    const number_t *values[DenseLayer::Units];
+    const uint8_t *deltas[DenseLayer::Units], *deltas_end[DenseLayer::Units];
+    unsigned int index[DenseLayer::Units]; // Input of the last entry consumed
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++) {
+      fc_acc[u] = 0;
+      values[u] = fc_values;
+      deltas[u] = fc_deltas;
+      deltas_end[u] = fc_deltas + fc_counts[u];
+      index[u] = 0;
+      fc_values += fc_counts[u];
+      fc_deltas += fc_counts[u];
+    }
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      unsigned int row_begin = k * ConvLayer::OutputSamples, row_end = row_begin + ConvLayer::OutputSamples;
+
+      bool used = false;
+      for (unsigned int u = 0; u < DenseLayer::Units; u++)
+        used = used || (deltas[u] != deltas_end[u] && index[u] + *deltas[u] < row_end);
+      if (!used)
+        continue;
+
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+
+      for (unsigned int u = 0; u < DenseLayer::Units; u++) {
+        // Cursor in locals, the compiler cannot keep the arrays in registers
+        const number_t *value = values[u];
+        const uint8_t *delta = deltas[u];
+        unsigned int pos = index[u];
+        long_number_t acc = fc_acc[u];
+
+        while (delta != deltas_end[u] && pos + *delta < row_end) {
+          pos += *delta++;
+          acc = acc + *value++ * conv_row[pos - row_begin];
+        }
+        values[u] = value;
+        deltas[u] = delta;
+        index[u] = pos;
+        fc_acc[u] = acc;
+      }
+    }
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_bias[u]);
+  }
+};
+
+// ConvDense for a single unit that is only compared with a threshold: rows are produced in the given filter order and
+// the accumulation stops as soon as the rows left can no longer move the output across the threshold. The row of
+// filter k adds between row_max * fc_negative[k] and row_max * fc_positive[k] (sums of the negative and positive dense
+// weights of its outputs), where row_max bounds its outputs from the input range and the sums of its negative and
+// positive kernel weights. The decision is the one of ConvDense as long as neither accumulates past long_number_t
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDenseEarlyExit {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+  static_assert(DenseLayer::Units == 1, "Only a single unit decides on a threshold");
+  static_assert(ConvLayer::OutputActivation == Activation::ReLU, "Bounds assume non-negative conv outputs");
+  static_assert(ConvLayer::Filters <= 256, "Filter order is stored in bytes");
+  static_assert(FIXED_POINT > 0, "Bounds are computed on fixed-point accumulators");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs; // Upper bound
+  static constexpr uint32_t RowMACs = MACs / ConvLayer::Filters; // Per conv row and its dense terms
+
+  typedef uint8_t order_type[ConvLayer::Filters];
+  typedef int32_t bound_type[ConvLayer::Filters];
+
+  // Whether the output of ConvDense is at least threshold, rows is set to the number of conv rows computed
+  static inline bool forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    const order_type order,
+    const bound_type conv_negative,
+    const bound_type conv_positive,
+    const bound_type fc_negative,
+    const bound_type fc_positive,
+    number_t threshold,
+    unsigned int *rows) {
+
+    *rows = 0;
+    if (threshold <= NUMBER_MIN) // Clamped outputs are never below
+      return true;
+    // Output at least threshold <=> scale_number_t(acc) + bias >= threshold, the shift rounds down
+    const int64_t target = ((int64_t)threshold - fc_bias[0]) * (1 << FIXED_POINT);
+
+    number_t input_min = input[0][0], input_max = input[0][0];
+    for (unsigned int z = 0; z < ConvLayer::InputChannels; z++)
+      for (unsigned int x = 0; x < ConvLayer::InputSamples; x++) {
+        input_min = input[z][x] < input_min ? input[z][x] : input_min;
+        input_max = input[z][x] > input_max ? input[z][x] : input_max;
+      }
+
+    number_t row_max[ConvLayer::Filters];
+    int64_t low = 0, high = 0; // What the rows left can add
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      int64_t conv_acc = (int64_t)conv_positive[k] * input_max + (int64_t)conv_negative[k] * input_min;
+      int64_t value = (conv_acc >> FIXED_POINT) + conv_bias[k];
+      row_max[k] = value < 0 ? 0 : value > NUMBER_MAX ? NUMBER_MAX : value;
+      low += (int64_t)row_max[k] * fc_negative[k];
+      high += (int64_t)row_max[k] * fc_positive[k];
+    }
+
+    number_t conv_row[ConvLayer::OutputSamples];
+    int64_t fc_acc = 0;
+    for (unsigned int i = 0; i < ConvLayer::Filters; i++) {
+      if (fc_acc + low >= target)
+        return true;
+      if (fc_acc + high < target)
+        return false;
+
+      unsigned int k = order[i];
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_row);
+      fc_acc += mac_dot(conv_row, &fc_kernel[0][k * ConvLayer::OutputSamples], ConvLayer::OutputSamples);
+      low -= (int64_t)row_max[k] * fc_negative[k];
+      high -= (int64_t)row_max[k] * fc_positive[k];
+      (*rows)++;
+    }
+    return fc_acc >= target;
+  }
+};
+
+// MaxPool1D -> Conv1D -> Flatten -> Dense on a window that slides by Hop input samples between calls: pooled and
+// conv columns still inside the window are shifted instead of recomputed, only the dense layer sees the whole window
+template<typename PoolLayer, typename ConvLayer, typename DenseLayer, unsigned int Hop>
+struct SlidingPoolConvDense {
+  static_assert(Hop % PoolLayer::Stride == 0, "Hop must be a multiple of the pooling stride");
+  static_assert(ConvLayer::InputSamples == PoolLayer::OutputSamples, "Conv input must be the pooled output");
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  // Columns entering the window at each hop, nothing can be reused when the hop is as wide as the conv output
+  static constexpr unsigned int NewColumns = Hop / PoolLayer::Stride;
+  static constexpr bool Reuse = NewColumns < ConvLayer::OutputSamples;
+
+  // Persistent between calls, unlike the activation arena
+  typedef struct {
+    typename PoolLayer::output_type pooled;
+    typename ConvLayer::output_type conv;
+    bool primed; // pooled and conv hold the previous window
+  } state_type;
+
+  static inline void reset(state_type *state) {
+    state->primed = false;
+  }
+
+  static inline void forward(
+    const typename PoolLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    typename DenseLayer::output_type output,
+    state_type *state) {
+
+    unsigned int pooled_first = 0, conv_first = 0;
+
+    if (state->primed && Reuse) {
+      for (unsigned int z = 0; z < ConvLayer::InputChannels; z++)
+        for (unsigned int pos_x = 0; pos_x + NewColumns < PoolLayer::OutputSamples; pos_x++)
+          state->pooled[z][pos_x] = state->pooled[z][pos_x + NewColumns];
+      for (unsigned int k = 0; k < ConvLayer::Filters; k++)
+        for (unsigned int pos_x = 0; pos_x + NewColumns < ConvLayer::OutputSamples; pos_x++)
+          state->conv[k][pos_x] = state->conv[k][pos_x + NewColumns];
+      pooled_first = PoolLayer::OutputSamples - NewColumns;
+      conv_first = ConvLayer::OutputSamples - NewColumns;
+    }
+
+    PoolLayer::forward_columns(input, state->pooled, pooled_first, PoolLayer::OutputSamples - pooled_first);
+    ConvLayer::forward_columns(state->pooled, conv_kernel, conv_bias, state->conv, conv_first, ConvLayer::OutputSamples - conv_first);
+    // Flatten is a noop, the dense layer reads the conv columns in place
+    DenseLayer::forward(reinterpret_cast<const typename DenseLayer::input_type &>(state->conv), fc_kernel, fc_bias, output);
+
+    state->primed = true;
+  }
+};
+
+#endif//__LAYERS_H__
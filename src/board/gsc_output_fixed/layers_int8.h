@@ -0,0 +1,139 @@
+/**
+  ******************************************************************************
+  * @file    layers_int8.h
+  * @brief   int8 counterpart of layers.h: int8 weights and activations, int32 accumulation and a requantization
+  *          multiplier and shift per output channel, derived from activation statistics by main --calibrate
+  */
+
+#ifndef __LAYERS_INT8_H__
+#define __LAYERS_INT8_H__
+
+#ifndef SINGLE_FILE
+#include "number.h"
+#include "mac.h"
+#include "layers.h"
+#endif
+
+// Activations and weights stay in [-127, 127] so that mac_dot_int8() can use its vectorized paths
+#define INT8_MAX_VALUE 127
+
+// acc * multiplier * 2^(shift - 31) rounded to nearest, multiplier in [2^30, 2^31) and shift in [-31, 30].
+// Same arithmetic as the calibration so that the host and the MCU agree bit for bit
+static inline int32_t requantize(int32_t acc, int32_t multiplier, int shift) {
+  int total = 31 - shift;
+  return (int32_t)(((int64_t)acc * multiplier + ((int64_t)1 << (total - 1))) >> total);
+}
+
+template<Activation Act>
+static inline int8_t activate_int8(int32_t acc) {
+  int32_t low = Act == Activation::ReLU ? 0 : -INT8_MAX_VALUE;
+  return (int8_t)(acc < low ? low : acc > INT8_MAX_VALUE ? INT8_MAX_VALUE : acc);
+}
+
+// number_t activations to int8 with one scale for the whole tensor
+template<unsigned int Channels, unsigned int Samples>
+struct QuantizeInt8 {
+  typedef number_t input_type[Channels][Samples];
+  typedef int8_t output_type[Channels][Samples];
+
+  static inline void forward(const input_type input, int32_t multiplier, int shift, output_type output) {
+    for (unsigned int c = 0; c < Channels; c++)
+      for (unsigned int x = 0; x < Samples; x++)
+        output[c][x] = activate_int8<Activation::Linear>(requantize(input[c][x], multiplier, shift));
+  }
+};
+
+// Unpadded unit-stride convolution, the int32 bias is already at the scale of the accumulator of its filter
+template<unsigned int InChannels, unsigned int InSamples, unsigned int ConvFilters, unsigned int KernelSize, Activation Act>
+struct Conv1DInt8 {
+  static constexpr unsigned int InputChannels = InChannels;
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Filters = ConvFilters;
+  static constexpr unsigned int OutputSamples = InSamples - KernelSize + 1;
+  static constexpr uint32_t MACs = ConvFilters * OutputSamples * InChannels * KernelSize;
+
+  typedef int8_t input_type[InChannels][InSamples];
+  typedef int8_t kernel_type[ConvFilters][InChannels][KernelSize];
+  typedef int32_t bias_type[ConvFilters];
+  typedef int32_t multiplier_type[ConvFilters];
+  typedef int8_t shift_type[ConvFilters];
+  typedef int8_t output_type[ConvFilters][OutputSamples];
+
+  static inline void forward_row(const input_type input, const int8_t kernel[InChannels][KernelSize], int32_t bias, int32_t multiplier, int shift, int8_t output[OutputSamples]) {
+    int32_t output_acc[OutputSamples];
+
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output_acc[pos_x] = bias;
+    for (unsigned int z = 0; z < InChannels; z++)
+      mac_conv1d_int8(input[z], kernel[z], KernelSize, OutputSamples, output_acc);
+    for (unsigned int pos_x = 0; pos_x < OutputSamples; pos_x++)
+      output[pos_x] = activate_int8<Act>(requantize(output_acc[pos_x], multiplier, shift));
+  }
+
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, const multiplier_type multiplier, const shift_type shift, output_type output) {
+    for (unsigned int k = 0; k < ConvFilters; k++)
+      forward_row(input, kernel[k], bias[k], multiplier[k], shift[k], output[k]);
+  }
+};
+
+// The output is requantized to number_t: this is the last layer and the model output keeps its format
+template<unsigned int InSamples, unsigned int FcUnits, Activation Act>
+struct DenseInt8 {
+  static constexpr unsigned int InputSamples = InSamples;
+  static constexpr unsigned int Units = FcUnits;
+  static constexpr uint32_t MACs = InSamples * FcUnits;
+
+  typedef int8_t input_type[InSamples];
+  typedef int8_t kernel_type[FcUnits][InSamples];
+  typedef int32_t bias_type[FcUnits];
+  typedef int32_t multiplier_type[FcUnits];
+  typedef int8_t shift_type[FcUnits];
+  typedef number_t output_type[FcUnits];
+
+  static inline number_t output_value(int32_t acc, int32_t multiplier, int shift) {
+    return activate<Act>(requantize(acc, multiplier, shift));
+  }
+
+  static inline void forward(const input_type input, const kernel_type kernel, const bias_type bias, const multiplier_type multiplier, const shift_type shift, output_type output) {
+    for (unsigned int k = 0; k < FcUnits; k++)
+      output[k] = output_value(bias[k] + mac_dot_int8(input, kernel[k], InSamples), multiplier[k], shift[k]);
+  }
+};
+
+// Conv1DInt8 -> Flatten -> DenseInt8 fused like ConvDense, one row of int8 conv outputs at a time
+template<typename ConvLayer, typename DenseLayer>
+struct ConvDenseInt8 {
+  static_assert(DenseLayer::InputSamples == ConvLayer::Filters * ConvLayer::OutputSamples, "Dense input must be the flattened conv output");
+
+  static constexpr uint32_t MACs = ConvLayer::MACs + DenseLayer::MACs;
+
+  static inline void forward(
+    const typename ConvLayer::input_type input,
+    const typename ConvLayer::kernel_type conv_kernel,
+    const typename ConvLayer::bias_type conv_bias,
+    const typename ConvLayer::multiplier_type conv_multiplier,
+    const typename ConvLayer::shift_type conv_shift,
+    const typename DenseLayer::kernel_type fc_kernel,
+    const typename DenseLayer::bias_type fc_bias,
+    const typename DenseLayer::multiplier_type fc_multiplier,
+    const typename DenseLayer::shift_type fc_shift,
+    typename DenseLayer::output_type output) {
+
+    int8_t conv_row[ConvLayer::OutputSamples];
+    int32_t fc_acc[DenseLayer::Units];
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      fc_acc[u] = fc_bias[u];
+
+    for (unsigned int k = 0; k < ConvLayer::Filters; k++) {
+      ConvLayer::forward_row(input, conv_kernel[k], conv_bias[k], conv_multiplier[k], conv_shift[k], conv_row);
+      for (unsigned int u = 0; u < DenseLayer::Units; u++)
+        fc_acc[u] += mac_dot_int8(conv_row, &fc_kernel[u][k * ConvLayer::OutputSamples], ConvLayer::OutputSamples);
+    }
+
+    for (unsigned int u = 0; u < DenseLayer::Units; u++)
+      output[u] = DenseLayer::output_value(fc_acc[u], fc_multiplier[u], fc_shift[u]);
+  }
+};
+
+#endif//__LAYERS_INT8_H__
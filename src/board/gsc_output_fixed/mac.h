@@ -0,0 +1,464 @@
+/**
+  ******************************************************************************
+  * @file    mac.h
+  * @brief   Multiply-accumulate and data movement primitives for the fixed-point kernels, vectorized with AVX2, NEON
+  *          or Cortex-M SMLAD when available
+  */
+
+#ifndef __MAC_H__
+#define __MAC_H__
+
+#ifndef SINGLE_FILE
+#include "number.h"
+#endif
+
+// Select the implementation at compile time, define MAC_SCALAR to force the portable reference
+// or MAC_SMLAD_EMULATE to run the Cortex-M dual-MAC path with emulated intrinsics on the host
+#if !defined(MAC_SCALAR) && NUMBER_MIN == -32768 && NUMBER_MAX == 32767
+#if defined(MAC_SMLAD_EMULATE)
+#define MAC_SMLAD
+#elif defined(__AVX2__)
+#define MAC_AVX2
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define MAC_NEON
+#include <arm_neon.h>
+#elif defined(__ARM_FEATURE_DSP)
+#define MAC_SMLAD
+#endif
+#endif
+
+#define MAC_MAX_ROWS 8 // Maximum number of rows handled by one mac_dot_rows() call
+
+#ifdef MAC_SMLAD
+#include <string.h>
+
+// Two consecutive number_t as one word, first element in the bottom half (little-endian packing)
+static inline uint32_t mac_read_q15x2(const number_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v)); // Single LDR, unaligned accesses are allowed on Cortex-M4
+  return v;
+}
+
+#ifdef MAC_SMLAD_EMULATE
+// Bit-exact SMLAD: acc + x.bottom * y.bottom + x.top * y.top, wrapping like the instruction
+static inline long_number_t mac_smlad(uint32_t x, uint32_t y, long_number_t acc) {
+  int32_t bottom = (int32_t)(int16_t)(x & 0xFFFF) * (int16_t)(y & 0xFFFF);
+  int32_t top = (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+  return (long_number_t)((uint32_t)acc + (uint32_t)bottom + (uint32_t)top);
+}
+
+// Bit-exact PKHBT with LSL #16: bottom half of x, bottom half of y in the top half
+static inline uint32_t mac_pkhbt(uint32_t x, uint32_t y) {
+  return (x & 0xFFFF) | (y << 16);
+}
+#else
+// Same instruction as CMSIS __SMLAD() without depending on the CMSIS headers
+static inline long_number_t mac_smlad(uint32_t x, uint32_t y, long_number_t acc) {
+  long_number_t result;
+  __asm__ ("smlad %0, %1, %2, %3" : "=r" (result) : "r" (x), "r" (y), "r" (acc));
+  return result;
+}
+
+static inline uint32_t mac_pkhbt(uint32_t x, uint32_t y) {
+  uint32_t result;
+  __asm__ ("pkhbt %0, %1, %2, lsl #16" : "=r" (result) : "r" (x), "r" (y));
+  return result;
+}
+#endif
+
+#ifdef MAC_SMLAD_EMULATE
+// Bit-exact SXTB16: bytes 0 and 2 of x sign-extended into the bottom and top halves
+static inline uint32_t mac_sxtb16(uint32_t x) {
+  return (uint32_t)(uint16_t)(int16_t)(int8_t)(x & 0xFF) | ((uint32_t)(uint16_t)(int16_t)(int8_t)((x >> 16) & 0xFF) << 16);
+}
+#else
+static inline uint32_t mac_sxtb16(uint32_t x) {
+  uint32_t result;
+  __asm__ ("sxtb16 %0, %1" : "=r" (result) : "r" (x));
+  return result;
+}
+#endif
+
+// Bytes 1 and 3 of x sign-extended, the ROR #8 of SXTB16
+static inline uint32_t mac_sxtb16_ror8(uint32_t x) {
+  return mac_sxtb16((x >> 8) | (x << 24));
+}
+#endif
+
+#ifdef MAC_AVX2
+static inline long_number_t mac_hsum_128(__m128i acc) {
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(acc);
+}
+
+static inline long_number_t mac_hsum_256(__m256i acc) {
+  return mac_hsum_128(_mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+}
+#endif
+
+#ifdef MAC_NEON
+static inline long_number_t mac_hsum_neon(int32x4_t acc) {
+  int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+  return vget_lane_s32(vpadd_s32(sum, sum), 0);
+}
+#endif
+
+// Sum of a[i] * b[i] for i < n, bit-exact with the scalar loop
+static inline long_number_t mac_dot(const number_t *a, const number_t *b, unsigned int n) {
+  unsigned int i = 0;
+  long_number_t acc = 0;
+
+#if defined(MAC_AVX2)
+  __m256i acc256 = _mm256_setzero_si256();
+  for (; i + 16 <= n; i += 16)
+    acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(
+      _mm256_loadu_si256((const __m256i *)(a + i)),
+      _mm256_loadu_si256((const __m256i *)(b + i))));
+  acc = mac_hsum_256(acc256);
+
+  if (i + 8 <= n) {
+    acc += mac_hsum_128(_mm_madd_epi16(
+      _mm_loadu_si128((const __m128i *)(a + i)),
+      _mm_loadu_si128((const __m128i *)(b + i))));
+    i += 8;
+  }
+#elif defined(MAC_NEON)
+  int32x4_t acc128 = vdupq_n_s32(0);
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t va = vld1q_s16(a + i);
+    int16x8_t vb = vld1q_s16(b + i);
+    acc128 = vmlal_s16(acc128, vget_low_s16(va), vget_low_s16(vb));
+    acc128 = vmlal_s16(acc128, vget_high_s16(va), vget_high_s16(vb));
+  }
+  acc = mac_hsum_neon(acc128);
+#elif defined(MAC_SMLAD)
+  for (; i + 4 <= n; i += 4) {
+    acc = mac_smlad(mac_read_q15x2(a + i), mac_read_q15x2(b + i), acc);
+    acc = mac_smlad(mac_read_q15x2(a + i + 2), mac_read_q15x2(b + i + 2), acc);
+  }
+#endif
+
+  for (; i < n; i++)
+    acc = acc + a[i] * b[i];
+  return acc;
+}
+
+// Sum of a[i] * b[i] for i < n on int8 operands, bit-exact with the scalar loop as long as b holds no -128:
+// the AVX2 path moves the sign of a onto b to use the unsigned by signed byte multiply
+static inline int32_t mac_dot_int8(const int8_t *a, const int8_t *b, unsigned int n) {
+  unsigned int i = 0;
+  int32_t acc = 0;
+
+#if defined(MAC_AVX2)
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i acc256 = _mm256_setzero_si256();
+  for (; i + 32 <= n; i += 32) {
+    __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+    // |a| * (b with the sign of a): pairs of products fit in int16 since |b| <= 127
+    __m256i pairs = _mm256_maddubs_epi16(_mm256_sign_epi8(va, va), _mm256_sign_epi8(vb, va));
+    acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(pairs, ones));
+  }
+  acc = mac_hsum_256(acc256);
+
+  // Last 16 then 8 values, the zeroed upper bytes of a 64-bit load add nothing
+  for (unsigned int width = 16; width >= 8; width /= 2) {
+    if (i + width <= n) {
+      __m128i va = width == 16 ? _mm_loadu_si128((const __m128i *)(a + i)) : _mm_loadl_epi64((const __m128i *)(a + i));
+      __m128i vb = width == 16 ? _mm_loadu_si128((const __m128i *)(b + i)) : _mm_loadl_epi64((const __m128i *)(b + i));
+      acc += mac_hsum_128(_mm_madd_epi16(_mm_maddubs_epi16(_mm_sign_epi8(va, va), _mm_sign_epi8(vb, va)), _mm256_castsi256_si128(ones)));
+      i += width;
+    }
+  }
+#elif defined(MAC_NEON)
+  int32x4_t acc128 = vdupq_n_s32(0);
+  for (; i + 16 <= n; i += 16) {
+    int8x16_t va = vld1q_s8(a + i);
+    int8x16_t vb = vld1q_s8(b + i);
+    acc128 = vpadalq_s16(acc128, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+    acc128 = vpadalq_s16(acc128, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+  }
+  acc = mac_hsum_neon(acc128);
+#elif defined(MAC_SMLAD)
+  // One word holds 4 int8, SXTB16 splits it into the even and odd pairs of two SMLAD
+  for (; i + 4 <= n; i += 4) {
+    uint32_t va, vb;
+    memcpy(&va, a + i, sizeof(va));
+    memcpy(&vb, b + i, sizeof(vb));
+    acc = mac_smlad(mac_sxtb16(va), mac_sxtb16(vb), acc);
+    acc = mac_smlad(mac_sxtb16_ror8(va), mac_sxtb16_ror8(vb), acc);
+  }
+#endif
+
+  for (; i < n; i++)
+    acc = acc + a[i] * b[i];
+  return acc;
+}
+
+// out[r] = sum of w[i] * rows[r * stride + i] for i < n and r < count <= MAC_MAX_ROWS,
+// each vector of weights is loaded once for all the rows
+static inline void mac_dot_rows(const number_t *w, const number_t *rows, unsigned int stride, unsigned int count, unsigned int n, long_number_t out[]) {
+  unsigned int i = 0, r;
+
+#if defined(MAC_AVX2)
+  __m256i acc[MAC_MAX_ROWS];
+  for (r = 0; r < count; r++)
+    acc[r] = _mm256_setzero_si256();
+  for (; i + 16 <= n; i += 16) {
+    __m256i vw = _mm256_loadu_si256((const __m256i *)(w + i));
+    for (r = 0; r < count; r++)
+      acc[r] = _mm256_add_epi32(acc[r], _mm256_madd_epi16(vw, _mm256_loadu_si256((const __m256i *)(rows + r * stride + i))));
+  }
+  for (r = 0; r < count; r++)
+    out[r] = mac_hsum_256(acc[r]);
+#elif defined(MAC_NEON)
+  int32x4_t acc[MAC_MAX_ROWS];
+  for (r = 0; r < count; r++)
+    acc[r] = vdupq_n_s32(0);
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t vw = vld1q_s16(w + i);
+    for (r = 0; r < count; r++) {
+      int16x8_t vr = vld1q_s16(rows + r * stride + i);
+      acc[r] = vmlal_s16(acc[r], vget_low_s16(vw), vget_low_s16(vr));
+      acc[r] = vmlal_s16(acc[r], vget_high_s16(vw), vget_high_s16(vr));
+    }
+  }
+  for (r = 0; r < count; r++)
+    out[r] = mac_hsum_neon(acc[r]);
+#elif defined(MAC_SMLAD)
+  for (r = 0; r < count; r++)
+    out[r] = 0;
+  for (; i + 2 <= n; i += 2) {
+    uint32_t vw = mac_read_q15x2(w + i);
+    for (r = 0; r < count; r++)
+      out[r] = mac_smlad(vw, mac_read_q15x2(rows + r * stride + i), out[r]);
+  }
+#else
+  for (r = 0; r < count; r++)
+    out[r] = 0;
+#endif
+
+  for (; i < n; i++)
+    for (r = 0; r < count; r++)
+      out[r] = out[r] + w[i] * rows[r * stride + i];
+}
+
+#ifdef MAC_AVX2
+// Add 8 consecutive outputs of a unit-stride convolution to acc
+static inline __m256i mac_conv1d_block(const number_t *input, const number_t *kernel, unsigned int taps, __m256i acc) {
+  unsigned int x;
+  // Interleave samples x + i and x + i + 1 so that madd applies two taps per lane
+  for (x = 0; x + 2 <= taps; x += 2) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(input + x));
+    __m128i b = _mm_loadu_si128((const __m128i *)(input + x + 1));
+    __m256i pairs = _mm256_set_m128i(_mm_unpackhi_epi16(a, b), _mm_unpacklo_epi16(a, b));
+    __m256i w = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)kernel[x] | ((uint32_t)(uint16_t)kernel[x + 1] << 16)));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, w));
+  }
+  if (x < taps) { // Odd number of taps
+    __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(input + x)));
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(v, _mm256_set1_epi32(kernel[x])));
+  }
+  return acc;
+}
+#endif
+
+#ifdef MAC_NEON
+// Add 8 consecutive outputs of a unit-stride convolution to lo and hi
+static inline void mac_conv1d_block(const number_t *input, const number_t *kernel, unsigned int taps, int32x4_t *lo, int32x4_t *hi) {
+  unsigned int x;
+  for (x = 0; x < taps; x++) {
+    int16x8_t v = vld1q_s16(input + x);
+    *lo = vmlal_n_s16(*lo, vget_low_s16(v), kernel[x]);
+    *hi = vmlal_n_s16(*hi, vget_high_s16(v), kernel[x]);
+  }
+}
+#endif
+
+// out[pos] += sum of kernel[x] * input[pos + x] for x < taps and pos < outsamples,
+// input holds outsamples + taps - 1 values, vectorized over blocks of 8 output positions
+static inline void mac_conv1d(const number_t *input, const number_t *kernel, unsigned int taps, unsigned int outsamples, long_number_t out[]) {
+  unsigned int pos = 0, x;
+
+#if defined(MAC_AVX2) || defined(MAC_NEON)
+  long_number_t last[8];
+  unsigned int i;
+
+  for (; pos + 8 <= outsamples; pos += 8) {
+#if defined(MAC_AVX2)
+    __m256i acc = mac_conv1d_block(input + pos, kernel, taps, _mm256_loadu_si256((const __m256i *)(out + pos)));
+    _mm256_storeu_si256((__m256i *)(out + pos), acc);
+#else
+    int32x4_t lo = vld1q_s32(out + pos);
+    int32x4_t hi = vld1q_s32(out + pos + 4);
+    mac_conv1d_block(input + pos, kernel, taps, &lo, &hi);
+    vst1q_s32(out + pos, lo);
+    vst1q_s32(out + pos + 4, hi);
+#endif
+  }
+
+  // Remaining outputs come from one more block ending on the last output, overlapping lanes are dropped
+  if (pos < outsamples && outsamples >= 8) {
+#if defined(MAC_AVX2)
+    _mm256_storeu_si256((__m256i *)last, mac_conv1d_block(input + outsamples - 8, kernel, taps, _mm256_setzero_si256()));
+#else
+    int32x4_t lo = vdupq_n_s32(0);
+    int32x4_t hi = vdupq_n_s32(0);
+    mac_conv1d_block(input + outsamples - 8, kernel, taps, &lo, &hi);
+    vst1q_s32(last, lo);
+    vst1q_s32(last + 4, hi);
+#endif
+    for (i = pos + 8 - outsamples; i < 8; i++)
+      out[outsamples - 8 + i] = out[outsamples - 8 + i] + last[i];
+    pos = outsamples;
+  }
+#elif defined(MAC_SMLAD)
+  // Two outputs at a time share each packed pair of taps
+  for (; pos + 2 <= outsamples; pos += 2) {
+    long_number_t acc0 = out[pos];
+    long_number_t acc1 = out[pos + 1];
+    for (x = 0; x + 2 <= taps; x += 2) {
+      uint32_t w = mac_read_q15x2(kernel + x);
+      acc0 = mac_smlad(mac_read_q15x2(input + pos + x), w, acc0);
+      acc1 = mac_smlad(mac_read_q15x2(input + pos + x + 1), w, acc1);
+    }
+    if (x < taps) { // Odd number of taps
+      acc0 = acc0 + input[pos + x] * kernel[x];
+      acc1 = acc1 + input[pos + x + 1] * kernel[x];
+    }
+    out[pos] = acc0;
+    out[pos + 1] = acc1;
+  }
+#endif
+
+  for (x = 0; x < taps; x++)
+    for (unsigned int p = pos; p < outsamples; p++)
+      out[p] = out[p] + input[p + x] * kernel[x];
+}
+
+#ifdef MAC_AVX2
+// Add 8 consecutive outputs of a unit-stride int8 convolution to acc, samples widened to the pairs of mac_conv1d_block()
+static inline __m256i mac_conv1d_int8_block(const int8_t *input, const int8_t *kernel, unsigned int taps, __m256i acc) {
+  unsigned int x;
+  for (x = 0; x + 2 <= taps; x += 2) {
+    __m128i a = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)(input + x)));
+    __m128i b = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)(input + x + 1)));
+    __m256i pairs = _mm256_set_m128i(_mm_unpackhi_epi16(a, b), _mm_unpacklo_epi16(a, b));
+    __m256i w = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)kernel[x] | ((uint32_t)(uint16_t)kernel[x + 1] << 16)));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, w));
+  }
+  if (x < taps) { // Odd number of taps
+    __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(input + x)));
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(v, _mm256_set1_epi32(kernel[x])));
+  }
+  return acc;
+}
+#endif
+
+#ifdef MAC_NEON
+// Add 8 consecutive outputs of a unit-stride int8 convolution to lo and hi
+static inline void mac_conv1d_int8_block(const int8_t *input, const int8_t *kernel, unsigned int taps, int32x4_t *lo, int32x4_t *hi) {
+  unsigned int x;
+  for (x = 0; x < taps; x++) {
+    int16x8_t v = vmovl_s8(vld1_s8(input + x));
+    *lo = vmlal_n_s16(*lo, vget_low_s16(v), kernel[x]);
+    *hi = vmlal_n_s16(*hi, vget_high_s16(v), kernel[x]);
+  }
+}
+#endif
+
+// mac_conv1d() on int8 operands: out[pos] += sum of kernel[x] * input[pos + x] for x < taps and pos < outsamples
+static inline void mac_conv1d_int8(const int8_t *input, const int8_t *kernel, unsigned int taps, unsigned int outsamples, int32_t out[]) {
+  unsigned int pos = 0, x;
+
+#if defined(MAC_AVX2) || defined(MAC_NEON)
+  int32_t last[8];
+  unsigned int i;
+
+  for (; pos + 8 <= outsamples; pos += 8) {
+#if defined(MAC_AVX2)
+    __m256i acc = mac_conv1d_int8_block(input + pos, kernel, taps, _mm256_loadu_si256((const __m256i *)(out + pos)));
+    _mm256_storeu_si256((__m256i *)(out + pos), acc);
+#else
+    int32x4_t lo = vld1q_s32(out + pos);
+    int32x4_t hi = vld1q_s32(out + pos + 4);
+    mac_conv1d_int8_block(input + pos, kernel, taps, &lo, &hi);
+    vst1q_s32(out + pos, lo);
+    vst1q_s32(out + pos + 4, hi);
+#endif
+  }
+
+  // Remaining outputs come from one more block ending on the last output, overlapping lanes are dropped
+  if (pos < outsamples && outsamples >= 8) {
+#if defined(MAC_AVX2)
+    _mm256_storeu_si256((__m256i *)last, mac_conv1d_int8_block(input + outsamples - 8, kernel, taps, _mm256_setzero_si256()));
+#else
+    int32x4_t lo = vdupq_n_s32(0);
+    int32x4_t hi = vdupq_n_s32(0);
+    mac_conv1d_int8_block(input + outsamples - 8, kernel, taps, &lo, &hi);
+    vst1q_s32(last, lo);
+    vst1q_s32(last + 4, hi);
+#endif
+    for (i = pos + 8 - outsamples; i < 8; i++)
+      out[outsamples - 8 + i] = out[outsamples - 8 + i] + last[i];
+    pos = outsamples;
+  }
+#elif defined(MAC_SMLAD)
+  // Taps unpacked once into the even and odd pairs of each word, 4 taps per SXTB16 pair of SMLAD
+  uint32_t even[8], odd[8];
+  unsigned int words = taps / 4 < 8 ? taps / 4 : 8;
+  for (x = 0; x < words; x++) {
+    uint32_t w;
+    memcpy(&w, kernel + 4 * x, sizeof(w));
+    even[x] = mac_sxtb16(w);
+    odd[x] = mac_sxtb16_ror8(w);
+  }
+  for (; pos < outsamples; pos++) {
+    int32_t acc = out[pos];
+    for (x = 0; x < words; x++) {
+      uint32_t v;
+      memcpy(&v, input + pos + 4 * x, sizeof(v));
+      acc = mac_smlad(mac_sxtb16(v), even[x], acc);
+      acc = mac_smlad(mac_sxtb16_ror8(v), odd[x], acc);
+    }
+    for (x = 4 * words; x < taps; x++)
+      acc = acc + input[pos + x] * kernel[x];
+    out[pos] = acc;
+  }
+#endif
+
+  for (x = 0; x < taps; x++)
+    for (unsigned int p = pos; p < outsamples; p++)
+      out[p] = out[p] + input[p + x] * kernel[x];
+}
+
+// out[i] = interleaved[2 * i] for i < n: first channel of interleaved stereo samples
+static inline void mac_deinterleave(const number_t *interleaved, number_t *out, unsigned int n) {
+  unsigned int i = 0;
+
+#if defined(MAC_AVX2)
+  const __m256i low_half = _mm256_set1_epi32(0xFFFF);
+  for (; i + 16 <= n; i += 16) {
+    __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(interleaved + 2 * i)), low_half);
+    __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(interleaved + 2 * i + 16)), low_half);
+    // Zero-extended samples are not saturated by packus, which packs within 128-bit lanes
+    _mm256_storeu_si256((__m256i *)(out + i), _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+#elif defined(MAC_NEON)
+  for (; i + 8 <= n; i += 8)
+    vst1q_s16(out + i, vld2q_s16(interleaved + 2 * i).val[0]);
+#elif defined(MAC_SMLAD)
+  // Two samples per store, one PKHBT packs the first channel of two stereo words
+  for (; i + 2 <= n; i += 2) {
+    uint32_t v = mac_pkhbt(mac_read_q15x2(interleaved + 2 * i), mac_read_q15x2(interleaved + 2 * i + 2));
+    memcpy(out + i, &v, sizeof(v));
+  }
+#endif
+
+  for (; i < n; i++)
+    out[i] = interleaved[2 * i];
+}
+
+#endif//__MAC_H__
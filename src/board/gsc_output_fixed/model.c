@@ -9,72 +9,290 @@
 
 #ifndef SINGLE_FILE
 #include "number.h"
-#include "model.h"
-
- // InputLayer is excluded
-#include "max_pooling1d_6.c" // InputLayer is excluded
-#include "conv1d_6.c"
-#include "weights/conv1d_6.c" // InputLayer is excluded
-#include "flatten_2.c" // InputLayer is excluded
-#include "dense_4.c"
+#include "model.h" // Layer types
+
+#include "weights/conv1d_6.c"
 #include "weights/dense_4.c"
+#if MODEL_SPARSE_DENSE
+#include "weights/dense_4_sparse.c"
+#endif
+#if MODEL_EARLY_EXIT
+#include "weights/conv1d_6_dense_4_bounds.c"
+#endif
 #endif
 
-void cnn(
+#if MODEL_PROFILE
+profile_layer_t model_profile[MODEL_PROFILE_LAYERS] = {
+  {"max_pooling1d_6", max_pooling1d_6_t::MACs, 0, 0, 0, 0},
+#if MODEL_FUSED_CONV_DENSE
+#if MODEL_ACTIVATION_SPARSE
+  {"conv1d_6+flatten_2+dense_4 (nonzero)", conv1d_6_dense_4_nonzero_t::MACs, 0, 0, 0, 0},
+#elif MODEL_SPARSE_DENSE
+  {"conv1d_6+flatten_2+dense_4 (sparse)", conv1d_6_dense_4_sparse_t::MACs, 0, 0, 0, 0},
+#else
+  {"conv1d_6+flatten_2+dense_4", conv1d_6_dense_4_t::MACs, 0, 0, 0, 0},
+#endif
+#else
+  {"conv1d_6", conv1d_6_t::MACs, 0, 0, 0, 0},
+  {"flatten_2", flatten_2_t::MACs, 0, 0, 0, 0},
+#if MODEL_SPARSE_DENSE
+  {"dense_4 (sparse)", dense_4_sparse_t::MACs, 0, 0, 0, 0},
+#else
+  {"dense_4", dense_4_t::MACs, 0, 0, 0, 0},
+#endif
+#endif
+};
+
+void model_profile_reset(void) {
+  profile_reset(model_profile, MODEL_PROFILE_LAYERS);
+}
+#endif
+
+#if MODEL_ACTIVATION_SPARSE
+model_density_t model_density;
+
+void model_density_reset(void) {
+  model_density.inferences = 0;
+  model_density.min = 0;
+  model_density.max = 0;
+  model_density.total = 0;
+}
+
+static inline void model_density_record(uint32_t nonzeros) {
+  if (model_density.inferences == 0 || nonzeros < model_density.min)
+    model_density.min = nonzeros;
+  if (nonzeros > model_density.max)
+    model_density.max = nonzeros;
+  model_density.total += nonzeros;
+  model_density.inferences++;
+}
+#endif
+
+void cnn_r(
   const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
-  dense_4_output_type dense_4_output) {
+  dense_4_t::output_type dense_4_output,
+  cnn_activations_t *activations) {
 
-  // Output array allocation
-  static union {
-    max_pooling1d_6_output_type max_pooling1d_6_output;
-  } activations1;
-
-  static union {
-    conv1d_6_output_type conv1d_6_output;
-    flatten_2_output_type flatten_2_output;
-  } activations2;
-
-
-  //static union {
-//
-//    static input_5_output_type input_5_output;
-//
-//    static max_pooling1d_6_output_type max_pooling1d_6_output;
-//
-//    static conv1d_6_output_type conv1d_6_output;
-//
-//    static flatten_2_output_type flatten_2_output;
-//
-  //} activations;
+  max_pooling1d_6_t::output_type &max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(MAX_POOLING1D_6_OUTPUT));
+#if !MODEL_FUSED_CONV_DENSE
+  conv1d_6_t::output_type &conv1d_6_output =
+    arena_tensor<conv1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(CONV1D_6_OUTPUT));
+  flatten_2_t::output_type &flatten_2_output =
+    arena_tensor<flatten_2_t::output_type>(activations->arena, model_arena_plan_t::offset(CONV1D_6_OUTPUT));
+#endif
 
   // Model layers call chain
  // InputLayer is excluded 
-  max_pooling1d_6(
+  PROFILE_BEGIN(max_pooling1d_6);
+  max_pooling1d_6_t::forward(
      // First layer uses input passed as model parameter
     input,
-    activations1.max_pooling1d_6_output
+    max_pooling1d_6_output
   );
- // InputLayer is excluded 
-  conv1d_6(
-    
-    activations1.max_pooling1d_6_output,
+  PROFILE_END(max_pooling1d_6, &model_profile[PROFILE_MAX_POOLING1D_6]);
+#if MODEL_FUSED_CONV_DENSE
+ // conv1d_6 -> flatten_2 -> dense_4 fused, the conv output is never stored
+  PROFILE_BEGIN(conv1d_6_dense_4);
+#if MODEL_ACTIVATION_SPARSE
+  model_density_record(conv1d_6_dense_4_nonzero_t::forward(
+    max_pooling1d_6_output,
     conv1d_6_kernel,
     conv1d_6_bias,
-    activations2.conv1d_6_output
+    dense_4_kernel,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
+  ));
+#elif MODEL_SPARSE_DENSE
+  conv1d_6_dense_4_sparse_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_sparse_values,
+    dense_4_sparse_deltas,
+    dense_4_sparse_counts,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
   );
- // InputLayer is excluded 
-  flatten_2(
-    
-    activations2.conv1d_6_output,
-    activations2.flatten_2_output
+#else
+  conv1d_6_dense_4_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
   );
+#endif
+  PROFILE_END(conv1d_6_dense_4, &model_profile[PROFILE_CONV1D_6_DENSE_4]);
+#else
  // InputLayer is excluded 
-  dense_4(
-    
-    activations2.flatten_2_output,
+  PROFILE_BEGIN(conv1d_6);
+  conv1d_6_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    conv1d_6_output
+  );
+  PROFILE_END(conv1d_6, &model_profile[PROFILE_CONV1D_6]);
+ // flatten_2 is a noop, conv1d_6_output and flatten_2_output share storage
+  PROFILE_BEGIN(flatten_2);
+  PROFILE_END(flatten_2, &model_profile[PROFILE_FLATTEN_2]);
+  PROFILE_BEGIN(dense_4);
+#if MODEL_SPARSE_DENSE
+  dense_4_sparse_t::forward(
+    flatten_2_output,
+    dense_4_sparse_values,
+    dense_4_sparse_deltas,
+    dense_4_sparse_counts,
+    dense_4_bias, // Last layer uses output passed as model parameter
+    dense_4_output
+  );
+#else
+  dense_4_t::forward(
+    flatten_2_output,
     dense_4_kernel,
     dense_4_bias, // Last layer uses output passed as model parameter
     dense_4_output
   );
+#endif
+  PROFILE_END(dense_4, &model_profile[PROFILE_DENSE_4]);
+#endif
+
+}
+
+void cnn(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  dense_4_t::output_type dense_4_output) {
+
+  // Output array allocation
+  static cnn_activations_t activations;
+
+  cnn_r(input, dense_4_output, &activations);
+}
+
+void cnn_pooled(
+  const max_pooling1d_6_t::output_type max_pooling1d_6_output,
+  dense_4_t::output_type dense_4_output) {
+
+  conv1d_6_dense_4_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias,
+    dense_4_output
+  );
+}
+
+void cnn_batch(
+  unsigned int batch,
+  const number_t input[][MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[][MODEL_OUTPUT_SAMPLES],
+  cnn_batch_activations_t *activations) {
+
+  unsigned int b, step;
+  max_pooling1d_6_t::output_type *max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type[MODEL_BATCH_SIZE]>(activations->arena, model_batch_arena_plan_t::offset(MAX_POOLING1D_6_OUTPUT));
+  conv1d_6_t::output_type *conv1d_6_output =
+    arena_tensor<conv1d_6_t::output_type[MODEL_BATCH_SIZE]>(activations->arena, model_batch_arena_plan_t::offset(CONV1D_6_OUTPUT));
+  flatten_2_t::output_type *flatten_2_output =
+    arena_tensor<flatten_2_t::output_type[MODEL_BATCH_SIZE]>(activations->arena, model_batch_arena_plan_t::offset(CONV1D_6_OUTPUT));
+
+  for (; batch > 0; batch -= step, input += step, output += step) {
+    step = batch < MODEL_BATCH_SIZE ? batch : MODEL_BATCH_SIZE;
+
+    for (b = 0; b < step; b++) {
+      max_pooling1d_6_t::forward(
+        input[b],
+        max_pooling1d_6_output[b]
+      );
+    }
+
+    conv1d_6_t::forward_batch(
+      step,
+      max_pooling1d_6_output,
+      conv1d_6_kernel,
+      conv1d_6_bias,
+      conv1d_6_output
+    );
+
+    // flatten_2 is a noop, conv1d_6_output and flatten_2_output share storage
+
+#if MODEL_SPARSE_DENSE
+    dense_4_sparse_t::forward_batch(
+      step,
+      flatten_2_output,
+      dense_4_sparse_values,
+      dense_4_sparse_deltas,
+      dense_4_sparse_counts,
+      dense_4_bias,
+      output
+    );
+#else
+    dense_4_t::forward_batch(
+      step,
+      flatten_2_output,
+      dense_4_kernel,
+      dense_4_bias,
+      output
+    );
+#endif
+  }
+}
+
+#if MODEL_EARLY_EXIT
+model_early_exit_t model_early_exit;
+
+void model_early_exit_reset(void) {
+  model_early_exit.inferences = 0;
+  model_early_exit.rows = 0;
+}
+
+bool cnn_decide(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t threshold) {
+
+  max_pooling1d_6_t::output_type max_pooling1d_6_output;
+  unsigned int rows;
+
+  max_pooling1d_6_t::forward(input, max_pooling1d_6_output);
+  bool decision = conv1d_6_dense_4_early_exit_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias,
+    conv1d_6_dense_4_order,
+    conv1d_6_negative,
+    conv1d_6_positive,
+    dense_4_negative,
+    dense_4_positive,
+    threshold,
+    &rows
+  );
+  model_early_exit.inferences++;
+  model_early_exit.rows += rows;
+  return decision;
+}
+#endif
+
+void cnn_stream(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_stream_t *stream) {
+
+  cnn_stream_layers_t::forward(
+    input,
+    conv1d_6_kernel,
+    conv1d_6_bias,
+    dense_4_kernel,
+    dense_4_bias,
+    output,
+    stream
+  );
+}
 
+void cnn_stream_reset(cnn_stream_t *stream) {
+  cnn_stream_layers_t::reset(stream);
 }
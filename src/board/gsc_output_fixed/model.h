@@ -12,15 +12,193 @@
 
 #ifndef SINGLE_FILE
 #include "number.h"
+#include "layers.h"
+#include "arena.h"
+#include "profile.h"
 #endif
 
 #define MODEL_OUTPUT_SAMPLES 1
 #define MODEL_INPUT_SAMPLES 100 // node 0 is InputLayer so use its output shape as input shape of the model
 #define MODEL_INPUT_CHANNELS 1
 
+// Run conv1d_6, flatten_2 and dense_4 as one fused kernel so that the conv output is never stored,
+// build with -DMODEL_FUSED_CONV_DENSE=0 to run the layers separately
+#ifndef MODEL_FUSED_CONV_DENSE
+#define MODEL_FUSED_CONV_DENSE 1
+#endif
+
+// Run dense_4 on the magnitude-pruned weights of weights/dense_4_sparse.c (main --prune) so that only the nonzero
+// weights are read, fused it also skips the conv1d_6 filters left without weights. cnn_stream() keeps dense_4_kernel
+#ifndef MODEL_SPARSE_DENSE
+#define MODEL_SPARSE_DENSE 0
+#endif
+
+// Fused conv1d_6 -> dense_4 that skips the zero outputs of the ReLU instead of multiplying them, and counts them in
+// model_density. Build with -DMODEL_ACTIVATION_SPARSE=1
+#ifndef MODEL_ACTIVATION_SPARSE
+#define MODEL_ACTIVATION_SPARSE 0
+#endif
+
+// cnn_decide(): the fused conv1d_6 -> dense_4 stopped as soon as the decision is known, with the filter order and
+// bounds of weights/conv1d_6_dense_4_bounds.c (main --early-exit). Build with -DMODEL_EARLY_EXIT=1
+#ifndef MODEL_EARLY_EXIT
+#define MODEL_EARLY_EXIT 0
+#endif
+
+#if MODEL_ACTIVATION_SPARSE && (!MODEL_FUSED_CONV_DENSE || MODEL_SPARSE_DENSE)
+#error "MODEL_ACTIVATION_SPARSE needs MODEL_FUSED_CONV_DENSE and dense weights"
+#endif
+
+// Model layers, InputLayer is excluded
+typedef MaxPool1D<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES, 4, 3> max_pooling1d_6_t;
+typedef Conv1D<1, max_pooling1d_6_t::OutputSamples, 64, 8, 1, Activation::ReLU> conv1d_6_t;
+typedef Flatten<conv1d_6_t::Filters, conv1d_6_t::OutputSamples> flatten_2_t;
+typedef Dense<flatten_2_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_4_t;
+typedef ConvDense<conv1d_6_t, dense_4_t> conv1d_6_dense_4_t;
+typedef ConvDenseNonzero<conv1d_6_t, dense_4_t> conv1d_6_dense_4_nonzero_t;
+typedef ConvDenseEarlyExit<conv1d_6_t, dense_4_t> conv1d_6_dense_4_early_exit_t;
+typedef SparseDense<flatten_2_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_4_sparse_t;
+typedef ConvSparseDense<conv1d_6_t, dense_4_sparse_t> conv1d_6_dense_4_sparse_t;
+
+// Layer calls of cnn() and cnn_r() timed when built with -DMODEL_PROFILE=1
+enum {
+  PROFILE_MAX_POOLING1D_6,
+#if MODEL_FUSED_CONV_DENSE
+  PROFILE_CONV1D_6_DENSE_4,
+#else
+  PROFILE_CONV1D_6,
+  PROFILE_FLATTEN_2,
+  PROFILE_DENSE_4,
+#endif
+  MODEL_PROFILE_LAYERS
+};
+
+#if MODEL_PROFILE
+// Not thread-safe: profile a single thread of inferences
+extern profile_layer_t model_profile[MODEL_PROFILE_LAYERS];
+
+void model_profile_reset(void);
+#endif
+
+#if MODEL_ACTIVATION_SPARSE
+// Nonzero conv1d_6 outputs seen by cnn() and cnn_r(), out of flatten_2_t::OutputSamples per inference
+typedef struct {
+  uint32_t inferences;
+  uint32_t min; // Per inference
+  uint32_t max;
+  uint64_t total;
+} model_density_t;
+
+// Not thread-safe: count a single thread of inferences
+extern model_density_t model_density;
+
+void model_density_reset(void);
+#endif
+
+#if MODEL_EARLY_EXIT
+// conv1d_6 rows computed by cnn_decide(), out of conv1d_6_t::Filters per inference
+typedef struct {
+  uint32_t inferences;
+  uint64_t rows;
+} model_early_exit_t;
+
+// Not thread-safe: count a single thread of inferences
+extern model_early_exit_t model_early_exit;
+
+void model_early_exit_reset(void);
+#endif
+
+// Maximum number of samples processed together by one step of cnn_batch()
+#define MODEL_BATCH_SIZE 16
+
+// Intermediate tensors in execution order, flatten_2 is a noop that reads conv1d_6_output in place
+enum {
+  MAX_POOLING1D_6_OUTPUT,
+  CONV1D_6_OUTPUT,
+};
+
+static const char *const model_tensor_names[] = {"max_pooling1d_6_output", "conv1d_6_output"};
+
+// Offsets of the tensors in the activation arena, conv1d_6_output is never stored when fused
+typedef ArenaPlan<
+  sizeof(max_pooling1d_6_t::output_type)
+#if !MODEL_FUSED_CONV_DENSE
+, sizeof(conv1d_6_t::output_type)
+#endif
+> model_arena_plan_t;
+
+typedef ArenaPlan<
+  MODEL_BATCH_SIZE * sizeof(max_pooling1d_6_t::output_type),
+  MODEL_BATCH_SIZE * sizeof(conv1d_6_t::output_type)
+> model_batch_arena_plan_t;
+
+#define MODEL_ARENA_SIZE (model_arena_plan_t::bytes)
+#define MODEL_BATCH_ARENA_SIZE (model_batch_arena_plan_t::bytes)
+
+// Intermediate activations of one inference, cnn() uses its own static instance
+// while cnn_r() lets the caller provide one per thread
+typedef struct {
+  alignas(ARENA_ALIGNMENT) uint8_t arena[MODEL_ARENA_SIZE];
+} cnn_activations_t;
+
+typedef struct {
+  alignas(ARENA_ALIGNMENT) uint8_t arena[MODEL_BATCH_ARENA_SIZE];
+} cnn_batch_activations_t;
+
+// Sliding window hop of cnn_stream() in input samples, must be a multiple of the max_pooling1d_6 stride
+#ifndef MODEL_STREAM_HOP
+#define MODEL_STREAM_HOP 48
+#endif
+
+typedef SlidingPoolConvDense<max_pooling1d_6_t, conv1d_6_t, dense_4_t, MODEL_STREAM_HOP> cnn_stream_layers_t;
+typedef cnn_stream_layers_t::state_type cnn_stream_t;
+
+// Class of an output: the sign of a single output, the logit of the positive class, or the highest of several
+static inline unsigned int model_decision(const number_t output[MODEL_OUTPUT_SAMPLES]) {
+  unsigned int decision = 0;
+  for (unsigned int i = 1; i < MODEL_OUTPUT_SAMPLES; i++)
+    if (output[i] > output[decision])
+      decision = i;
+  return MODEL_OUTPUT_SAMPLES == 1 ? output[0] >= 0 : decision;
+}
+
 void cnn(
   const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
   //dense_4_output_type dense_4_output);
   number_t output[MODEL_OUTPUT_SAMPLES]);
 
+void cnn_r(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_activations_t *activations);
+
+// conv1d_6 -> dense_4 fused on an input already through max_pooling1d_6, always on the dense weights: the second half
+// of the conv1d_6 entry of model_registry.c, which runs on the weights of this file rather than a copy of its own
+void cnn_pooled(
+  const max_pooling1d_6_t::output_type max_pooling1d_6_output,
+  number_t output[MODEL_OUTPUT_SAMPLES]);
+
+// Run batch inferences, layer weights are loaded once per step of MODEL_BATCH_SIZE samples
+void cnn_batch(
+  unsigned int batch,
+  const number_t input[][MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[][MODEL_OUTPUT_SAMPLES],
+  cnn_batch_activations_t *activations);
+
+// Same output as cnn() on the window, which must have moved by exactly MODEL_STREAM_HOP samples since the previous
+// call: only the pooled and conv columns of the newest samples are computed. Call cnn_stream_reset() after a gap
+void cnn_stream(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_stream_t *stream);
+
+void cnn_stream_reset(cnn_stream_t *stream);
+
+#if MODEL_EARLY_EXIT
+// Whether cnn() would output at least threshold, computing only the conv1d_6 rows needed to know
+bool cnn_decide(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t threshold);
+#endif
+
 #endif//__MODEL_H__
\ No newline at end of file
@@ -0,0 +1,126 @@
+/**
+  ******************************************************************************
+  * @file    model_blob.c
+  * @brief   Validation of model blobs against the architecture of model.h and inference on their weights
+  */
+
+#include <string.h>
+
+#ifndef SINGLE_FILE
+#include "model_blob.h"
+#endif
+
+static_assert(sizeof(model_blob_header_t) == 64, "model_blob_header_t is part of the file format");
+static_assert(sizeof(model_blob_layer_t) == 64, "model_blob_layer_t is part of the file format");
+
+uint32_t model_blob_checksum(const void *data, size_t size) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++)
+    hash = (hash ^ p[i]) * 16777619u;
+  return hash;
+}
+
+void model_blob_expected_layers(model_blob_layer_t layers[4]) {
+  layers[0] = model_blob_pool_layer<max_pooling1d_6_t>();
+  layers[1] = model_blob_conv_layer<conv1d_6_t>();
+  layers[2] = model_blob_flatten_layer<conv1d_6_t>();
+  layers[3] = model_blob_dense_layer<dense_4_t>();
+}
+
+// Section inside the blob and aligned, empty ones must have a zero offset
+static bool model_blob_section_valid(uint32_t offset, uint32_t bytes, uint32_t size) {
+  if (bytes == 0)
+    return offset == 0;
+  return offset % MODEL_BLOB_ALIGNMENT == 0 && offset >= sizeof(model_blob_header_t) && offset <= size && bytes <= size - offset;
+}
+
+const char *model_blob_open(const void *data, size_t size, model_blob_t *model) {
+  const uint8_t *base = (const uint8_t *)data;
+  const model_blob_header_t *header = (const model_blob_header_t *)data;
+  model_blob_layer_t expected[4];
+
+  if ((uintptr_t)data % MODEL_BLOB_ALIGNMENT)
+    return "misaligned blob";
+  if (size < sizeof(model_blob_header_t))
+    return "truncated header";
+  if (memcmp(header->magic, MODEL_BLOB_MAGIC, sizeof(header->magic)))
+    return "not a model blob";
+  if (header->version != MODEL_BLOB_VERSION)
+    return "unsupported model blob version";
+  if (header->size < sizeof(model_blob_header_t) || header->size > size)
+    return "truncated blob";
+  if (header->checksum != model_blob_checksum(base + sizeof(model_blob_header_t), header->size - sizeof(model_blob_header_t)))
+    return "checksum mismatch";
+  if (header->fixed_point != FIXED_POINT || header->number_size != sizeof(number_t))
+    return "fixed-point format does not match the model";
+  if (header->input_channels != MODEL_INPUT_CHANNELS || header->input_samples != MODEL_INPUT_SAMPLES
+      || header->output_samples != MODEL_OUTPUT_SAMPLES)
+    return "input or output shape does not match the model";
+  if (header->layers != 4 || (header->size - sizeof(model_blob_header_t)) / sizeof(model_blob_layer_t) < 4)
+    return "layers do not match the model";
+
+  const model_blob_layer_t *layers = (const model_blob_layer_t *)(base + sizeof(model_blob_header_t));
+  model_blob_expected_layers(expected);
+  for (unsigned int i = 0; i < 4; i++) {
+    if (!model_blob_section_valid(layers[i].weights_offset, layers[i].weights_bytes, header->size)
+        || !model_blob_section_valid(layers[i].bias_offset, layers[i].bias_bytes, header->size))
+      return "invalid weight section";
+
+    // Same descriptor once the section offsets, which depend on the file, are left out
+    model_blob_layer_t layer = layers[i];
+    layer.weights_offset = 0;
+    layer.bias_offset = 0;
+    if (memcmp(&layer, &expected[i], sizeof(layer)))
+      return "layers do not match the model";
+  }
+
+  model->header = header;
+  model->conv1d_6_kernel = (const conv1d_6_t::kernel_type *)(base + layers[1].weights_offset);
+  model->conv1d_6_bias = (const conv1d_6_t::bias_type *)(base + layers[1].bias_offset);
+  model->dense_4_kernel = (const dense_4_t::kernel_type *)(base + layers[3].weights_offset);
+  model->dense_4_bias = (const dense_4_t::bias_type *)(base + layers[3].bias_offset);
+  return NULL;
+}
+
+void cnn_blob_r(
+  const model_blob_t *model,
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_activations_t *activations) {
+
+  max_pooling1d_6_t::output_type &max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(MAX_POOLING1D_6_OUTPUT));
+
+  max_pooling1d_6_t::forward(
+    input,
+    max_pooling1d_6_output
+  );
+#if MODEL_FUSED_CONV_DENSE
+  conv1d_6_dense_4_t::forward(
+    max_pooling1d_6_output,
+    *model->conv1d_6_kernel,
+    *model->conv1d_6_bias,
+    *model->dense_4_kernel,
+    *model->dense_4_bias,
+    output
+  );
+#else
+  conv1d_6_t::output_type &conv1d_6_output =
+    arena_tensor<conv1d_6_t::output_type>(activations->arena, model_arena_plan_t::offset(CONV1D_6_OUTPUT));
+
+  conv1d_6_t::forward(
+    max_pooling1d_6_output,
+    *model->conv1d_6_kernel,
+    *model->conv1d_6_bias,
+    conv1d_6_output
+  );
+  // flatten_2 is a noop, dense_4 reads conv1d_6_output in place
+  dense_4_t::forward(
+    reinterpret_cast<const flatten_2_t::output_type &>(conv1d_6_output),
+    *model->dense_4_kernel,
+    *model->dense_4_bias,
+    output
+  );
+#endif
+}
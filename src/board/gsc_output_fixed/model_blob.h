@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @file    model_blob.h
+  * @brief   Versioned binary model: a header, one descriptor per layer and aligned weight sections, so that retrained
+  *          weights of the architecture of model.h can be loaded at run time instead of being compiled in. The
+  *          inference reads the weights where the blob lies, mapped from a file on Linux or in flash on the board
+  */
+
+#ifndef __MODEL_BLOB_H__
+#define __MODEL_BLOB_H__
+
+#include <stddef.h>
+
+#ifndef SINGLE_FILE
+#include "model.h"
+#endif
+
+#define MODEL_BLOB_MAGIC "GSCM"
+#define MODEL_BLOB_VERSION 1
+#define MODEL_BLOB_ALIGNMENT 16 // Of the blob and of every weight section, enough for the vector loads of mac.h
+
+// Values in the byte order of the target, little-endian on both the host and the STM32L4
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t size; // Whole blob in bytes, header included
+  uint32_t checksum; // FNV-1a of the bytes after the header
+  int32_t fixed_point;
+  uint32_t number_size; // sizeof(number_t) of the weights
+  uint32_t input_channels;
+  uint32_t input_samples;
+  uint32_t output_samples;
+  uint32_t layers; // Descriptors following the header, in execution order
+  char name[24]; // NUL-terminated, for logs
+} model_blob_header_t;
+
+typedef enum {
+  MODEL_BLOB_MAX_POOLING1D = 1,
+  MODEL_BLOB_CONV1D = 2,
+  MODEL_BLOB_FLATTEN = 3,
+  MODEL_BLOB_DENSE = 4,
+} model_blob_layer_type_t;
+
+// Unused fields are 0, sections are given by their offset from the start of the blob
+typedef struct {
+  uint32_t type; // model_blob_layer_type_t
+  uint32_t activation; // 0 linear, 1 ReLU
+  uint32_t input_channels; // Dense: 1
+  uint32_t input_samples;
+  uint32_t units; // Conv filters or dense units
+  uint32_t size; // Pool or kernel size
+  uint32_t stride;
+  uint32_t padding_left;
+  uint32_t padding_right;
+  uint32_t weights_offset;
+  uint32_t weights_bytes;
+  uint32_t bias_offset;
+  uint32_t bias_bytes;
+  uint32_t reserved[3];
+} model_blob_layer_t;
+
+// Descriptors of the layers of layers.h, without their sections
+template<typename PoolLayer>
+static inline model_blob_layer_t model_blob_pool_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_MAX_POOLING1D;
+  layer.activation = PoolLayer::OutputActivation == Activation::ReLU;
+  layer.input_channels = PoolLayer::InputChannels;
+  layer.input_samples = PoolLayer::InputSamples;
+  layer.size = PoolLayer::Size;
+  layer.stride = PoolLayer::Stride;
+  return layer;
+}
+
+template<typename ConvLayer>
+static inline model_blob_layer_t model_blob_conv_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_CONV1D;
+  layer.activation = ConvLayer::OutputActivation == Activation::ReLU;
+  layer.input_channels = ConvLayer::InputChannels;
+  layer.input_samples = ConvLayer::InputSamples;
+  layer.units = ConvLayer::Filters;
+  layer.size = ConvLayer::Size;
+  layer.stride = ConvLayer::Stride;
+  layer.padding_left = ConvLayer::PaddingLeft;
+  layer.padding_right = ConvLayer::PaddingRight;
+  layer.weights_bytes = sizeof(typename ConvLayer::kernel_type);
+  layer.bias_bytes = sizeof(typename ConvLayer::bias_type);
+  return layer;
+}
+
+// Flatten of the output of ConvLayer
+template<typename ConvLayer>
+static inline model_blob_layer_t model_blob_flatten_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_FLATTEN;
+  layer.input_channels = ConvLayer::Filters;
+  layer.input_samples = ConvLayer::OutputSamples;
+  return layer;
+}
+
+template<typename DenseLayer>
+static inline model_blob_layer_t model_blob_dense_layer() {
+  model_blob_layer_t layer = {};
+  layer.type = MODEL_BLOB_DENSE;
+  layer.activation = DenseLayer::OutputActivation == Activation::ReLU;
+  layer.input_channels = 1;
+  layer.input_samples = DenseLayer::InputSamples;
+  layer.units = DenseLayer::Units;
+  layer.weights_bytes = sizeof(typename DenseLayer::kernel_type);
+  layer.bias_bytes = sizeof(typename DenseLayer::bias_type);
+  return layer;
+}
+
+// Weights of a validated blob, pointers into the blob itself
+typedef struct {
+  const model_blob_header_t *header;
+  const conv1d_6_t::kernel_type *conv1d_6_kernel;
+  const conv1d_6_t::bias_type *conv1d_6_bias;
+  const dense_4_t::kernel_type *dense_4_kernel;
+  const dense_4_t::bias_type *dense_4_bias;
+} model_blob_t;
+
+// FNV-1a, 32 bits
+uint32_t model_blob_checksum(const void *data, size_t size);
+
+// Layer descriptors of the architecture compiled into model.h, without their sections
+void model_blob_expected_layers(model_blob_layer_t layers[4]);
+
+// Check that the blob at data is complete, uncorrupted and has exactly the layers of model.h, then point model at its
+// weights. Returns an error message or NULL on success. The blob must stay in place while model is used
+const char *model_blob_open(const void *data, size_t size, model_blob_t *model);
+
+// cnn_r() with the weights of the blob
+void cnn_blob_r(
+  const model_blob_t *model,
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_activations_t *activations);
+
+#endif//__MODEL_BLOB_H__
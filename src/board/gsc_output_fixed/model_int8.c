@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file    model_int8.c
+  * @brief   int8 inference with the calibrated weights of weights/conv1d_6_int8.c and weights/dense_4_int8.c
+  */
+
+#ifndef SINGLE_FILE
+#include "model_int8.h"
+#endif
+
+#if MODEL_INT8_CALIBRATED
+#ifndef SINGLE_FILE
+#include "weights/conv1d_6_int8.c"
+#include "weights/dense_4_int8.c"
+#endif
+
+void cnn_int8_r(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_int8_activations_t *activations) {
+
+  max_pooling1d_6_t::output_type &max_pooling1d_6_output =
+    arena_tensor<max_pooling1d_6_t::output_type>(activations->arena, model_int8_arena_plan_t::offset(0));
+  quantize_int8_t::output_type &quantize_output =
+    arena_tensor<quantize_int8_t::output_type>(activations->arena, model_int8_arena_plan_t::offset(1));
+
+  max_pooling1d_6_t::forward(
+    input,
+    max_pooling1d_6_output
+  );
+  quantize_int8_t::forward(
+    max_pooling1d_6_output,
+    conv1d_6_int8_input_multiplier,
+    conv1d_6_int8_input_shift,
+    quantize_output
+  );
+  // conv1d_6 -> flatten_2 -> dense_4 fused, output requantized to number_t
+  conv1d_6_dense_4_int8_t::forward(
+    quantize_output,
+    conv1d_6_int8_kernel,
+    conv1d_6_int8_bias,
+    conv1d_6_int8_multiplier,
+    conv1d_6_int8_shift,
+    dense_4_int8_kernel,
+    dense_4_int8_bias,
+    dense_4_int8_multiplier,
+    dense_4_int8_shift,
+    output
+  );
+}
+
+void cnn_int8(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES]) {
+
+  static cnn_int8_activations_t activations;
+
+  cnn_int8_r(input, output, &activations);
+}
+#endif//MODEL_INT8_CALIBRATED
@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file    model_int8.h
+  * @brief   int8 variant of the model of model.h, weights from weights/conv1d_6_int8.c and weights/dense_4_int8.c
+  *          written by main --calibrate on the training set. They are not committed: cnn_int8() and cnn_int8_r()
+  *          only exist once they are generated, which sets MODEL_INT8_CALIBRATED
+  */
+
+#ifndef __MODEL_INT8_H__
+#define __MODEL_INT8_H__
+
+#ifndef SINGLE_FILE
+#include "model.h"
+#include "layers_int8.h"
+
+#if defined(__has_include)
+#if __has_include("weights/conv1d_6_int8.c") && __has_include("weights/dense_4_int8.c")
+#define MODEL_INT8_CALIBRATED 1 // Also defined by weights/conv1d_6_int8.c for single-file builds
+#endif
+#endif
+#endif
+
+// Model layers, the input is pooled as number_t then quantized: max pooling commutes with the rounding
+typedef QuantizeInt8<MODEL_INPUT_CHANNELS, max_pooling1d_6_t::OutputSamples> quantize_int8_t;
+typedef Conv1DInt8<MODEL_INPUT_CHANNELS, max_pooling1d_6_t::OutputSamples, 64, 8, Activation::ReLU> conv1d_6_int8_t;
+typedef DenseInt8<conv1d_6_int8_t::Filters * conv1d_6_int8_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_4_int8_t;
+typedef ConvDenseInt8<conv1d_6_int8_t, dense_4_int8_t> conv1d_6_dense_4_int8_t;
+
+// conv1d_6 and dense_4 always run fused, only the pooled and quantized inputs are stored
+typedef ArenaPlan<
+  sizeof(max_pooling1d_6_t::output_type),
+  sizeof(quantize_int8_t::output_type)
+> model_int8_arena_plan_t;
+
+#define MODEL_INT8_ARENA_SIZE (model_int8_arena_plan_t::bytes)
+
+typedef struct {
+  alignas(ARENA_ALIGNMENT) uint8_t arena[MODEL_INT8_ARENA_SIZE];
+} cnn_int8_activations_t;
+
+// Same input and output format as cnn(), the output is requantized to number_t
+void cnn_int8(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES]);
+
+void cnn_int8_r(
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES],
+  cnn_int8_activations_t *activations);
+
+#endif//__MODEL_INT8_H__
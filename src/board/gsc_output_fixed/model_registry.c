@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    model_registry.c
+  * @brief   Registry of the generated variants, see model_registry.h
+  */
+
+#include <string.h>
+
+#ifndef SINGLE_FILE
+#include "model_registry.h"
+
+// Each weight file undefines its macros at the end, conv1d_6 runs on the weights of model.c through cnn_pooled()
+#include "weights/conv1d.c"
+#include "weights/dense.c"
+#include "weights/conv1d_5.c"
+#include "weights/dense_2.c"
+#endif
+
+template<typename PoolLayer>
+static void registry_forward_prefix(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES]) {
+  static_assert(sizeof(typename PoolLayer::output_type) <= MODEL_REGISTRY_PREFIX_SAMPLES * sizeof(number_t), "First layer output larger than its buffer");
+  PoolLayer::forward(input, reinterpret_cast<typename PoolLayer::output_type &>(*prefix_output));
+}
+
+// conv -> flatten -> dense fused like cnn_r()
+template<typename ConvLayer, typename DenseLayer>
+static void registry_forward_rest(
+  const typename ConvLayer::kernel_type conv_kernel,
+  const typename ConvLayer::bias_type conv_bias,
+  const typename DenseLayer::kernel_type dense_kernel,
+  const typename DenseLayer::bias_type dense_bias,
+  const number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES]) {
+
+  ConvDense<ConvLayer, DenseLayer>::forward(
+    reinterpret_cast<const typename ConvLayer::input_type &>(*prefix_output),
+    conv_kernel,
+    conv_bias,
+    dense_kernel,
+    dense_bias,
+    output
+  );
+}
+
+namespace conv1d {
+static void forward_rest(const number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) {
+  registry_forward_rest<conv_t, dense_t>(conv1d_kernel, conv1d_bias, dense_kernel, dense_bias, prefix_output, output);
+}
+
+void cnn(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) {
+  number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES];
+  registry_forward_prefix<max_pooling1d_6_t>(input, prefix_output);
+  forward_rest(prefix_output, output);
+}
+}
+
+namespace conv1d_5 {
+static void forward_rest(const number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) {
+  registry_forward_rest<conv_t, dense_t>(conv1d_5_kernel, conv1d_5_bias, dense_2_kernel, dense_2_bias, prefix_output, output);
+}
+
+void cnn(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) {
+  number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES];
+  registry_forward_prefix<max_pooling1d_6_t>(input, prefix_output);
+  forward_rest(prefix_output, output);
+}
+}
+
+namespace conv1d_6 {
+static void forward_rest(const number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) {
+  ::cnn_pooled(reinterpret_cast<const max_pooling1d_6_t::output_type &>(*prefix_output), output);
+}
+
+void cnn(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) {
+  ::cnn(input, output);
+}
+}
+
+const model_registry_entry_t model_registry[MODEL_REGISTRY_SIZE] = {
+  {"conv1d", model_blob_pool_layer<max_pooling1d_6_t>(), registry_forward_prefix<max_pooling1d_6_t>, conv1d::forward_rest},
+  {"conv1d_5", model_blob_pool_layer<max_pooling1d_6_t>(), registry_forward_prefix<max_pooling1d_6_t>, conv1d_5::forward_rest},
+  {"conv1d_6", model_blob_pool_layer<max_pooling1d_6_t>(), registry_forward_prefix<max_pooling1d_6_t>, conv1d_6::forward_rest},
+};
+
+int model_registry_find(const char *name) {
+  for (int i = 0; i < MODEL_REGISTRY_SIZE; i++)
+    if (!strcmp(model_registry[i].name, name))
+      return i;
+  return -1;
+}
+
+unsigned int model_registry_run(
+  const unsigned int models[],
+  unsigned int count,
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t outputs[][MODEL_OUTPUT_SAMPLES],
+  bool share) {
+
+  // One buffer per distinct first layer, there are at most as many as registered models
+  number_t prefix_outputs[MODEL_REGISTRY_SIZE][MODEL_REGISTRY_PREFIX_SAMPLES];
+  const model_registry_entry_t *computed[MODEL_REGISTRY_SIZE];
+  unsigned int buffers = 0, computations = 0;
+
+  for (unsigned int i = 0; i < count; i++) {
+    const model_registry_entry_t *model = &model_registry[models[i]];
+    number_t *prefix_output = NULL;
+
+    for (unsigned int b = 0; share && b < buffers && !prefix_output; b++)
+      if (!memcmp(&computed[b]->prefix, &model->prefix, sizeof(model->prefix)))
+        prefix_output = prefix_outputs[b];
+
+    if (!prefix_output) {
+      unsigned int b = share ? buffers++ : 0; // Without sharing, each first layer is consumed right away
+      computed[b] = model;
+      prefix_output = prefix_outputs[b];
+      model->forward_prefix(input, prefix_output);
+      computations++;
+    }
+    model->forward_rest(prefix_output, outputs[i]);
+  }
+  return computations;
+}
+
+bool cnn_cascade(
+  const model_cascade_t *cascade,
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES]) {
+
+  number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES];
+  registry_forward_prefix<max_pooling1d_6_t>(input, prefix_output);
+  conv1d_5::forward_rest(prefix_output, output);
+
+  for (unsigned int o = 0; o < MODEL_OUTPUT_SAMPLES; o++) {
+    if (output[o] >= cascade->low && output[o] <= cascade->high) {
+      conv1d_6::forward_rest(prefix_output, output);
+      return true;
+    }
+  }
+  return false;
+}
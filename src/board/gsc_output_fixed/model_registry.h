@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    model_registry.h
+  * @brief   The three generated variants linked side by side, each in a namespace named after its conv layer, and
+  *          an execution of several of them on one input that computes their identical first layers only once
+  */
+
+#ifndef __MODEL_REGISTRY_H__
+#define __MODEL_REGISTRY_H__
+
+#ifndef SINGLE_FILE
+#include "model.h"
+#include "model_blob.h"
+#endif
+
+// 64 filters like conv1d_6, different training
+namespace conv1d {
+typedef Conv1D<MODEL_INPUT_CHANNELS, max_pooling1d_6_t::OutputSamples, 64, 8, 1, Activation::ReLU> conv_t;
+typedef Dense<conv_t::Filters * conv_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_t;
+
+void cnn(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]);
+}
+
+// 32 filters, dense_2 has 832 inputs
+namespace conv1d_5 {
+typedef Conv1D<MODEL_INPUT_CHANNELS, max_pooling1d_6_t::OutputSamples, 32, 8, 1, Activation::ReLU> conv_t;
+typedef Dense<conv_t::Filters * conv_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_t;
+
+void cnn(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]);
+}
+
+// The model of model.h
+namespace conv1d_6 {
+typedef conv1d_6_t conv_t;
+typedef dense_4_t dense_t;
+
+void cnn(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]);
+}
+
+#define MODEL_REGISTRY_SIZE 3
+#define MODEL_REGISTRY_PREFIX_SAMPLES (sizeof(max_pooling1d_6_t::output_type) / sizeof(number_t)) // Largest first layer output
+
+// Models are split after their first layer, which has no weights: two models with the same descriptor for it compute
+// the same output from the same input
+typedef struct {
+  const char *name;
+  model_blob_layer_t prefix; // Descriptor of the first layer
+  void (*forward_prefix)(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES]);
+  void (*forward_rest)(const number_t prefix_output[MODEL_REGISTRY_PREFIX_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]);
+} model_registry_entry_t;
+
+extern const model_registry_entry_t model_registry[MODEL_REGISTRY_SIZE];
+
+// Index of the model called name in model_registry, -1 if there is none
+int model_registry_find(const char *name);
+
+// Run the models model_registry[models[i]] on one input into outputs[i]. With share, a model whose first layer matches
+// the one of an earlier model reuses its output. Returns the number of first layers computed
+unsigned int model_registry_run(
+  const unsigned int models[],
+  unsigned int count,
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t outputs[][MODEL_OUTPUT_SAMPLES],
+  bool share);
+
+// Small to large cascade: conv1d_5 decides alone when its output is below low or above high, the windows with an output
+// in [low, high] are escalated to conv1d_6. Both run from the same first layer
+typedef struct {
+  number_t low;
+  number_t high;
+} model_cascade_t;
+
+#define MODEL_CASCADE_SMALL_MACS (ConvDense<conv1d_5::conv_t, conv1d_5::dense_t>::MACs)
+#define MODEL_CASCADE_LARGE_MACS (ConvDense<conv1d_6::conv_t, conv1d_6::dense_t>::MACs)
+
+// Returns true when the window was escalated, output is then the one of conv1d_6
+bool cnn_cascade(
+  const model_cascade_t *cascade,
+  const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES],
+  number_t output[MODEL_OUTPUT_SAMPLES]);
+
+#endif//__MODEL_REGISTRY_H__
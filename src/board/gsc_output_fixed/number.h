@@ -18,6 +18,12 @@
 typedef int16_t number_t;		// Standard size numeric type used for weights and activations
 typedef int32_t long_number_t;	// Long numeric type used for intermediate results
 
+#ifdef __GNUC__
+#define NUMBER_ALIGN __attribute__((aligned(4)))	// Weight arrays start on a word so that kernels can load them as packed pairs
+#else
+#define NUMBER_ALIGN
+#endif
+
 #ifndef min
 static inline long_number_t min(long_number_t a, long_number_t b) {
 	if (a <= b)
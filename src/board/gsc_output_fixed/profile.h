@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file    profile.h
+  * @brief   Opt-in per-layer timing of the inference, build with -DMODEL_PROFILE=1. Otherwise the macros expand to nothing
+  */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#ifndef MODEL_PROFILE
+#define MODEL_PROFILE 0
+#endif
+
+#if MODEL_PROFILE
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+// DWT cycle counter of the Cortex-M3/M4, 32-bit so a layer must take less than 53 s at 80 MHz
+#define PROFILE_UNIT "cycles"
+#define PROFILE_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define PROFILE_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define PROFILE_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+typedef uint32_t profile_time_t;
+
+static inline void profile_init(void) {
+  PROFILE_DEMCR |= 1UL << 24; // TRCENA: enable the DWT
+  PROFILE_DWT_CYCCNT = 0;
+  PROFILE_DWT_CTRL |= 1; // CYCCNTENA
+}
+
+static inline profile_time_t profile_now(void) {
+  return PROFILE_DWT_CYCCNT;
+}
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+// Time stamp counter, constant rate on current CPUs: close to but not exactly core cycles
+#define PROFILE_UNIT "TSC ticks"
+
+typedef uint64_t profile_time_t;
+
+static inline void profile_init(void) {
+}
+
+static inline profile_time_t profile_now(void) {
+  return __rdtsc();
+}
+#else
+#include <chrono>
+
+#define PROFILE_UNIT "ns"
+
+typedef uint64_t profile_time_t;
+
+static inline void profile_init(void) {
+}
+
+static inline profile_time_t profile_now(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+typedef struct {
+  const char *name;
+  uint32_t macs; // Per call
+  uint32_t calls;
+  profile_time_t min;
+  profile_time_t max;
+  uint64_t total;
+} profile_layer_t;
+
+static inline void profile_record(profile_layer_t *layer, profile_time_t elapsed) {
+  if (layer->calls == 0 || elapsed < layer->min)
+    layer->min = elapsed;
+  if (elapsed > layer->max)
+    layer->max = elapsed;
+  layer->total += elapsed;
+  layer->calls++;
+}
+
+static inline void profile_reset(profile_layer_t *layers, unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    layers[i].calls = 0;
+    layers[i].min = 0;
+    layers[i].max = 0;
+    layers[i].total = 0;
+  }
+}
+
+// One line per layer: name, calls, min/mean/max time and MACs per 1000 time units. No floating point so that it
+// works with the reduced printf of embedded C libraries
+static inline int profile_format(char *buffer, size_t size, const profile_layer_t *layer) {
+  unsigned long mean = layer->calls ? (unsigned long)(layer->total / layer->calls) : 0;
+  return snprintf(buffer, size, "%s: %lu calls, min %lu mean %lu max %lu " PROFILE_UNIT ", %lu MACs, %lu MACs/k" PROFILE_UNIT,
+    layer->name, (unsigned long)layer->calls, (unsigned long)layer->min, mean, (unsigned long)layer->max,
+    (unsigned long)layer->macs, mean ? (unsigned long)((uint64_t)layer->macs * 1000 / mean) : 0UL);
+}
+
+// Time the statements between PROFILE_BEGIN(id) and PROFILE_END(id, layer) into the profile_layer_t *layer
+#define PROFILE_BEGIN(id) profile_time_t profile_start_##id = profile_now()
+#define PROFILE_END(id, layer) profile_record(layer, profile_now() - profile_start_##id)
+#else
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id, layer)
+#endif
+
+#endif//__PROFILE_H__
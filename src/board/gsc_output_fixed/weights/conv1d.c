@@ -15,7 +15,7 @@
 const int16_t conv1d_bias[CONV_FILTERS] = {92, 2, 46, 10, -49, -29, 35, 43, 76, 20, 75, 92, -27, 23, 0, -55, -43, 25, -50, 68, 48, 42, 60, 103, 57, 24, 74, -12, -7, 50, 80, 76, 81, 39, 74, -7, 49, 42, 47, 30, 69, -61, 9, -40, 63, -3, 36, -18, 58, 91, -76, 53, 48, 52, 18, 40, -39, 55, 35, 103, -39, 0, 91, 37}
 ;
 
-const int16_t conv1d_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] = {{{43, -100, -36, 6, 3, 56, 75, 73}
+const int16_t conv1d_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] NUMBER_ALIGN = {{{43, -100, -36, 6, 3, 56, 75, 73}
 }
 , {{21, 40, 40, 104, -74, -47, 50, -68}
 }
@@ -15,7 +15,7 @@
 const int16_t conv1d_5_bias[CONV_FILTERS] = {-36, -55, -114, 58, 138, 50, 105, -85, 90, 6, 132, 79, 101, 48, 67, 86, 29, 143, 51, -73, -16, 61, 54, -64, 114, -104, 11, -70, -24, 76, 77, 79}
 ;
 
-const int16_t conv1d_5_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] = {{{53, 125, -64, -60, 81, -22, -31, -9}
+const int16_t conv1d_5_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] NUMBER_ALIGN = {{{53, 125, -64, -60, 81, -22, -31, -9}
 }
 , {{-38, -14, -71, 79, 33, 59, 101, -20}
 }
@@ -15,7 +15,7 @@
 const int16_t conv1d_6_bias[CONV_FILTERS] = {-69, 12, 76, -30, 9, 108, 71, -22, 58, -40, -25, 37, -23, 65, 3, 32, 43, 33, -28, 12, 16, 5, 35, -30, 15, 12, -10, 89, -20, 54, -14, 35, -19, 96, -68, 49, 55, 32, -23, -16, -2, 36, -22, -53, 109, 37, -2, 53, 12, 35, 15, 55, 18, 16, 50, 68, 11, 46, 34, 49, -3, 36, -31, 112}
 ;
 
-const int16_t conv1d_6_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] = {{{19, 59, 44, -15, -27, 14, -34, -5}
+const int16_t conv1d_6_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] NUMBER_ALIGN = {{{19, 59, 44, -15, -27, 14, -34, -5}
 }
 , {{-34, -75, 61, -56, 43, 38, 13, 62}
 }
@@ -0,0 +1,27 @@
+/**
+  ******************************************************************************
+  * @file    weights/conv1d_6_dense_4_bounds.c
+  * @brief   Filter order and per-filter sums of the negative and positive weights of conv1d_6 and dense_4 for
+  *          cnn_decide(). Generated by main --early-exit, do not edit
+  */
+
+#define CONV_FILTERS 64
+
+// Filters by decreasing range of their contribution to dense_4
+const uint8_t conv1d_6_dense_4_order[CONV_FILTERS] = {2, 15, 50, 27, 54, 63, 47, 30, 31, 44, 37, 6, 25, 8, 14, 5, 62, 24, 32, 55, 1, 51, 33, 20, 58, 22, 60, 59, 7, 26, 23, 49, 3, 57, 29, 43, 36, 53, 56, 35, 4, 40, 46, 28, 42, 48, 34, 39, 16, 13, 17, 10, 45, 18, 41, 12, 11, 0, 52, 61, 38, 21, 9, 19}
+;
+
+const int32_t conv1d_6_negative[CONV_FILTERS] = {-81, -165, -471, -149, -142, -272, -342, -172, -230, -47, -65, -82, -103, -110, -203, -481, -109, -140, -126, -43, -183, -77, -186, -156, -298, -520, -162, -337, -119, -117, -426, -384, -177, -303, -105, -118, -95, -237, -71, -93, -130, -91, -141, -126, -283, -127, -89, -413, -108, -148, -480, -206, -49, -145, -303, -221, -148, -132, -169, -160, -154, -71, -156, -302}
+;
+
+const int32_t conv1d_6_positive[CONV_FILTERS] = {136, 217, 304, 233, 62, 121, 51, 276, 114, 155, 235, 217, 151, 169, 263, 224, 220, 138, 168, 146, 199, 101, 149, 201, 86, 0, 189, 229, 180, 176, 6, 54, 220, 139, 184, 204, 285, 227, 129, 201, 175, 200, 173, 200, 116, 161, 183, 113, 234, 158, 158, 142, 150, 216, 202, 138, 178, 140, 170, 91, 217, 164, 289, 103}
+;
+
+// Over the dense_4 inputs of each filter
+const int32_t dense_4_negative[CONV_FILTERS] = {-182, -478, -879, -213, -389, -675, -828, -216, -791, -195, -256, -251, -248, -342, -507, -749, -280, -347, -200, -232, -442, -221, -542, -260, -534, -873, -326, -725, -171, -399, -1048, -789, -445, -361, -198, -395, -326, -811, -224, -64, -272, -266, -164, -210, -624, -346, -181, -418, -242, -478, -480, -644, -386, -314, -657, -489, -243, -572, -708, -465, -368, -347, -421, -702}
+;
+
+const int32_t dense_4_positive[CONV_FILTERS] = {307, 468, 696, 411, 630, 511, 463, 379, 672, 227, 239, 134, 297, 223, 513, 754, 217, 202, 294, 175, 435, 265, 391, 420, 470, 102, 391, 548, 445, 377, 191, 424, 486, 453, 382, 254, 254, 286, 290, 498, 355, 217, 413, 468, 664, 162, 497, 704, 275, 302, 765, 393, 142, 276, 608, 528, 402, 286, 215, 598, 360, 97, 455, 786}
+;
+
+#undef CONV_FILTERS
@@ -14,7 +14,7 @@
 const int16_t dense_bias[FC_UNITS] = {-39}
 ;
 
-const int16_t dense_kernel[FC_UNITS][INPUT_SAMPLES] = {{41, -49, -2, 4, -6, -49, 24, 99, 47, -3, -75, -85, -19, 6, 16, -17, -7, 48, -107, -12, 29, -2, 58, -74, -61, -27, 5, 2, -9, -20, 27, 15, 0, 36, 9, -30, 5, 43, -25, -17, 21, -34, 78, -40, -23, 22, -37, -4, 44, -17, -42, 78, 71, -45, -32, 57, -84, 18, -43, 4, -68, -30, -40, -80, 32, 41, -35, 0, -35, -55, 112, -53, -68, 65, -84, -13, 69, -53, 17, 51, -33, 37, 10, -47, -20, 11, -7, 28, -53, 89, 19, 41, 34, -61, 7, 20, -92, 34, -24, 17, -44, -27, -58, -156, -20, -35, -1, 4, 19, 20, 19, -13, -31, 19, 10, 28, 32, 43, 0, 0, -18, 3, 16, 15, 6, 11, 48, 18, 26, 24, 36, 38, 33, 0, -33, -15, 11, 46, -3, 3, -21, -15, 3, 13, -63, -7, 28, -12, 51, -35, 8, 1, 41, 41, 26, 0, 22, -32, -48, 16, -6, -4, 20, 1, 9, -9, -7, 28, -18, 1, -17, -5, 3, 5, -41, 48, -28, 7, -32, -57, -16, 34, -38, 54, -70, -31, 15, 17, 19, 21, -17, 0, -2, -9, -30, -21, 90, 8, 43, -85, 54, -34, -69, 19, 134, 35, -70, -164, -110, -57, -103, 25, 80, 5, 28, 11, -47, -25, -2, 33, -42, -25, 26, 9, -36, -60, 38, 107, 48, 127, -29, -18, -175, -117, -23, 129, -46, 48, -2, -24, -18, 0, 38, 82, 10, -62, -54, -38, -45, 56, 12, -40, 27, -18, -58, -3, 54, 72, 105, -19, 19, -28, 8, -69, 24, -15, 29, 18, 37, -64, 13, -61, 43, 61, -3, -61, -3, 41, -18, -26, -21, -47, 51, -24, -111, -50, 64, -69, 17, -2, -1, -47, 51, 28, 47, 2, -61, -93, -40, -51, 28, -9, -22, 30, -41, 0, -9, 44, 15, -51, -89, -55, -23, -23, -66, 102, 22, 40, 10, -12, 26, 47, 14, 8, -72, 89, 33, -16, 89, -57, 4, 6, -4, 90, -19, -25, -28, -12, -91, 122, -42, 46, -16, 15, -53, -61, 54, 88, -24, 30, 6, -18, -6, 8, 42, -18, 34, -67, -82, 67, 79, 55, 92, 28, -161, -14, -43, 19, -82, 0, -19, -44, -48, 20, 3, 34, -38, 69, -105, 28, 101, -21, -19, 47, 18, -4, -46, 28, -66, 62, -20, 21, 13, -5, -2, -20, 1, 46, -8, 23, -10, -14, 12, -11, -12, -34, 18, 8, 64, 5, 15, 7, 36, 18, 21, -24, 10, 32, 0, -84, 48, 12, -20, -63, 2, 4, -21, -32, 0, 15, -72, -59, -1, -76, -65, 6, -47, 69, 33, -35, -15, 7, -93, 17, -10, 40, -29, 21, -28, 11, 35, 54, 49, 15, -49, -70, 13, 15, 13, 41, 15, -39, -25, 16, -15, 66, 93, 44, -4, 9, -2, -2, 1, 6, 13, 13, -10, 31, 11, 9, 16, 11, -30, 6, 19, 39, 1, 10, 54, -5, 25, 18, 20, 23, 2, 17, -103, -59, 10, 51, -69, 42, 16, 19, 25, 60, 35, 19, -65, -6, 65, -91, -49, 95, 49, 70, 90, -22, 33, -29, -35, 23, -3, -26, 31, -18, -10, -17, 9, -9, -34, -11, 0, 8, -8, -52, -39, -26, -26, -1, 32, -5, 3, 24, -19, 30, 71, 1, -22, 5, 19, -8, 29, 16, -23, -26, 7, 0, -33, -39, 9, 2, 3, 1, 25, -43, 15, -28, -75, -26, -6, 17, 22, 60, -46, -87, -46, 58, 2, -2, 24, -36, -13, 25, 15, 34, -35, -52, 120, -77, -26, 22, -5, 111, 58, -51, -44, -31, 2, -52, -17, 0, 22, 10, 98, 96, 4, -27, -34, -69, -5, -3, -14, -17, 7, 20, -60, 2, 8, 34, 43, -50, -96, -108, 0, -80, -49, -3, 68, -101, -5, 2, -41, -77, 20, -80, -52, 54, 77, -14, -2, -32, -76, 123, -49, -71, 53, -33, -22, 39, -79, -30, 32, -62, 61, 22, -6, 7, 59, 10, -42, -76, 44, 20, -35, 28, -90, -1, 5, -190, 45, 55, 72, 6, 1, -28, -50, 66, 32, -34, 30, 107, -55, 46, -5, 11, 9, 21, -78, 52, -63, -72, 91, -31, -20, -38, -124, 113, 94, 40, 2, -98, 37, -32, 35, 7, -2, -9, 16, 65, 59, -14, -1, 5, 41, -17, 29, -18, 31, 15, -22, 41, 9, 3, 62, 23, 85, 33, -75, -23, -4, -22, 45, -3, 0, -39, 59, -20, 0, -56, 7, 31, 21, 30, 5, 21, 10, -75, 5, 26, 67, 57, 0, -15, -93, 6, 59, -71, -52, 39, -55, 34, 44, 49, -15, -22, -48, -68, -16, 41, 17, -7, 12, -75, -45, 6, 78, 119, -23, 20, -9, -11, 45, -17, -8, -8, -16, 45, 50, -3, -46, 26, 96, 2, -11, 11, -60, 116, 62, 4, -24, -78, -81, 4, -43, 15, -2, 75, 23, -5, 9, -15, -16, 1, 38, 81, 19, 50, 45, -14, -10, 107, 98, 126, 10, -92, -123, -203, -89, 78, 59, -28, 143, 2, -10, -45, 16, -39, -35, -41, 44, -34, -50, -15, 56, 21, -9, -78, -39, 53, 12, -68, -5, -40, -43, 2, -81, -101, -23, 46, 3, -67, 75, 84, 5, -33, 76, -27, -14, 26, -36, -18, -29, -7, 61, -2, -57, -86, -134, 36, 137, -91, 124, -8, -57, 32, 8, -13, -80, 33, -73, 19, -67, 25, -22, -26, -64, 38, 73, 33, -82, 22, 44, -121, -61, 98, 60, 49, -166, -104, 4, 8, -53, -34, 5, -14, -41, 11, -1, -122, 48, -17, -76, 52, -59, 9, 75, 0, -10, 63, -33, -31, 93, -7, 18, 95, -125, 14, -31, 67, 73, -39, -45, -3, 24, -64, 4, 92, -46, 27, 0, 6, 67, 10, -55, 6, -26, -16, 2, -100, 73, -119, -34, 43, -186, -55, 34, 11, -29, -19, 20, -24, -33, 3, -20, -33, -89, -46, -48, -156, -69, 75, 39, 61, -45, -79, 5, -114, -80, 66, -8, 10, -14, -15, -33, 10, -22, 52, -10, 22, 17, -38, -90, 46, 2, -55, -13, 4, 4, 8, -23, -50, 38, 43, -33, -58, -41, 0, -24, -48, 6, 32, 5, -31, -22, -16, 14, -23, -100, -61, -71, 39, 55, 22, 51, -24, -93, -95, -69, -89, -1, 6, -43, 46, -1, -89, -17, 45, -49, 2, 24, 32, -51, -64, 103, -19, 73, -20, -41, 18, -19, -54, -32, -12, -64, 99, -5, -6, 26, 35, -11, 19, 6, -28, 38, 49, 39, -18, 5, 8, 50, -49, -23, 68, 7, 15, 39, -28, -5, 22, 8, 13, 6, -20, 16, -1, -31, -31, -34, -55, -41, 20, -69, 3, 36, -48, 70, -42, -62, 116, -54, -46, -4, 0, -19, 103, -55, 30, -23, 153, 24, 85, 29, -43, 15, 33, 5, 88, 57, -30, 7, -5, -2, 21, 15, 5, 55, -41, -74, -2, 83, 70, 14, -3, -44, 88, -4, -29, 91, 38, -21, 20, 1, -23, 11, -18, -21, -105, -23, 5, 150, 57, -27, 0, -73, 68, 78, -2, 17, -80, -4, 58, -54, -49, 94, 25, 8, -21, 56, -12, 22, -5, 3, -17, 3, -47, -54, -43, -25, -69, -110, 43, 6, -185, 70, -25, -23, -23, -26, -26, -33, 15, -46, -18, 16, -15, -37, 13, 3, 72, -21, -41, 3, -5, -8, -8, -1, 6, -9, -23, -38, 18, -43, 70, -54, 81, -9, -12, -18, 13, 10, 37, 0, -29, 16, -6, -10, 54, 9, -35, 49, -10, -88, -43, 6, 21, 99, 33, 36, 32, -38, 54, -5, -36, -4, 89, -76, -19, 6, 7, -17, -62, -4, 59, 94, 58, 87, -6, -68, -58, -125, 64, 45, 7, -147, 13, -124, 46, -31, -35, -41, 47, -48, 23, -24, 56, -72, -18, 51, -91, 67, -71, -56, -5, -37, -72, 10, -72, -117, 22, -12, -3, -18, 17, -8, 39, -10, 14, -5, -3, -41, 26, 20, -46, 8, 24, -15, 45, -4, 20, 44, 16, -4, -7, 16, -45, -22, 10, 18, -4, -49, 8, -7, -19, 7, 14, -4, -36, 0, 36, -30, 23, 2, 13, 47, -19, -1, -14, -39, 0, -12, -35, 13, 16, 10, 55, -92, 25, 22, -10, -34, 18, -1, -57, 3, -16, -56, 43, -10, -60, 100, -69, -76, -3, -16, -47, 107, -57, -94, -52, 53, 18, 22, -14, -40, 43, -18, -8, -6, 10, 46, 38, 40, -110, 42, 83, 36, 115, 88, 31, -45, -157, -99, 86, 14, -16, -121, 26, -16, 43, 20, 35, 38, -30, -27, 90, -8, -100, -116, -72, -79, -155, -81, 105, 94, 97, -65, -45, -92, -145, -60, -26, 18, 13, -66, -16, -16, -19, -68, -17, -41, -52, 2, 21, -19, 33, 23, -28, 58, 7, 0, 72, -45, -19, 33, -38, 57, -6, 61, 2, -21, -45, -14, -20, 14, 42, -26, 3, 26, 0, -3, -17, 29, 31, 31, 47, 18, 19, 8, 7, 28, 109, 113, 71, 11, 7, -62, -42, -6, -6, -21, 17, 45, -16, -3, -15, -13, -27, -8, -19, 0, -23, -39, 57, -37, -55, 1, 10, 47, -69, 1, 25, 87, -32, 24, -9, 24, -22, 13, -116, 41, 117, -52, 111, -59, 56, -46, -44, 146, 158, 47, -107, -81, -31, 144, -109, -68, -20, 12, -22, 2, -39, 16, -38, -33, -52, 26, 40, -17, -69, -58, 6, 15, 33, 103, 66, 3, -78, -193, -102, 10, 17, -2, 13, 30, -23, 23, 15, 13, 15, -7, 35, 16, -24, 0, 0, 29, -25, 16, 66, -23, -1, -3, 10, 15, 44, -23, 68, -25, -32, -20, -5, -5, 3, 8, 9, -1, 21, 43, 6, 37, -9, -20, 48, -74, -12, -30, 41, 20, 39, 62, -25, 169, -20, -2, -81, 97, 0, -37, 51, 112, -133, -24, 8, -52, 0, -13, -70, 102, 155, -74, -9, -79, -52, 41, -35, 100, -62, -50, -5, -13, 26, -20, 16, -21, -19, -46, 30, 0, 1, -9, -58, -53, -22, 29, -34, 17, 3, 25, 31, -28, -22, -5, -24}
+const int16_t dense_kernel[FC_UNITS][INPUT_SAMPLES] NUMBER_ALIGN = {{41, -49, -2, 4, -6, -49, 24, 99, 47, -3, -75, -85, -19, 6, 16, -17, -7, 48, -107, -12, 29, -2, 58, -74, -61, -27, 5, 2, -9, -20, 27, 15, 0, 36, 9, -30, 5, 43, -25, -17, 21, -34, 78, -40, -23, 22, -37, -4, 44, -17, -42, 78, 71, -45, -32, 57, -84, 18, -43, 4, -68, -30, -40, -80, 32, 41, -35, 0, -35, -55, 112, -53, -68, 65, -84, -13, 69, -53, 17, 51, -33, 37, 10, -47, -20, 11, -7, 28, -53, 89, 19, 41, 34, -61, 7, 20, -92, 34, -24, 17, -44, -27, -58, -156, -20, -35, -1, 4, 19, 20, 19, -13, -31, 19, 10, 28, 32, 43, 0, 0, -18, 3, 16, 15, 6, 11, 48, 18, 26, 24, 36, 38, 33, 0, -33, -15, 11, 46, -3, 3, -21, -15, 3, 13, -63, -7, 28, -12, 51, -35, 8, 1, 41, 41, 26, 0, 22, -32, -48, 16, -6, -4, 20, 1, 9, -9, -7, 28, -18, 1, -17, -5, 3, 5, -41, 48, -28, 7, -32, -57, -16, 34, -38, 54, -70, -31, 15, 17, 19, 21, -17, 0, -2, -9, -30, -21, 90, 8, 43, -85, 54, -34, -69, 19, 134, 35, -70, -164, -110, -57, -103, 25, 80, 5, 28, 11, -47, -25, -2, 33, -42, -25, 26, 9, -36, -60, 38, 107, 48, 127, -29, -18, -175, -117, -23, 129, -46, 48, -2, -24, -18, 0, 38, 82, 10, -62, -54, -38, -45, 56, 12, -40, 27, -18, -58, -3, 54, 72, 105, -19, 19, -28, 8, -69, 24, -15, 29, 18, 37, -64, 13, -61, 43, 61, -3, -61, -3, 41, -18, -26, -21, -47, 51, -24, -111, -50, 64, -69, 17, -2, -1, -47, 51, 28, 47, 2, -61, -93, -40, -51, 28, -9, -22, 30, -41, 0, -9, 44, 15, -51, -89, -55, -23, -23, -66, 102, 22, 40, 10, -12, 26, 47, 14, 8, -72, 89, 33, -16, 89, -57, 4, 6, -4, 90, -19, -25, -28, -12, -91, 122, -42, 46, -16, 15, -53, -61, 54, 88, -24, 30, 6, -18, -6, 8, 42, -18, 34, -67, -82, 67, 79, 55, 92, 28, -161, -14, -43, 19, -82, 0, -19, -44, -48, 20, 3, 34, -38, 69, -105, 28, 101, -21, -19, 47, 18, -4, -46, 28, -66, 62, -20, 21, 13, -5, -2, -20, 1, 46, -8, 23, -10, -14, 12, -11, -12, -34, 18, 8, 64, 5, 15, 7, 36, 18, 21, -24, 10, 32, 0, -84, 48, 12, -20, -63, 2, 4, -21, -32, 0, 15, -72, -59, -1, -76, -65, 6, -47, 69, 33, -35, -15, 7, -93, 17, -10, 40, -29, 21, -28, 11, 35, 54, 49, 15, -49, -70, 13, 15, 13, 41, 15, -39, -25, 16, -15, 66, 93, 44, -4, 9, -2, -2, 1, 6, 13, 13, -10, 31, 11, 9, 16, 11, -30, 6, 19, 39, 1, 10, 54, -5, 25, 18, 20, 23, 2, 17, -103, -59, 10, 51, -69, 42, 16, 19, 25, 60, 35, 19, -65, -6, 65, -91, -49, 95, 49, 70, 90, -22, 33, -29, -35, 23, -3, -26, 31, -18, -10, -17, 9, -9, -34, -11, 0, 8, -8, -52, -39, -26, -26, -1, 32, -5, 3, 24, -19, 30, 71, 1, -22, 5, 19, -8, 29, 16, -23, -26, 7, 0, -33, -39, 9, 2, 3, 1, 25, -43, 15, -28, -75, -26, -6, 17, 22, 60, -46, -87, -46, 58, 2, -2, 24, -36, -13, 25, 15, 34, -35, -52, 120, -77, -26, 22, -5, 111, 58, -51, -44, -31, 2, -52, -17, 0, 22, 10, 98, 96, 4, -27, -34, -69, -5, -3, -14, -17, 7, 20, -60, 2, 8, 34, 43, -50, -96, -108, 0, -80, -49, -3, 68, -101, -5, 2, -41, -77, 20, -80, -52, 54, 77, -14, -2, -32, -76, 123, -49, -71, 53, -33, -22, 39, -79, -30, 32, -62, 61, 22, -6, 7, 59, 10, -42, -76, 44, 20, -35, 28, -90, -1, 5, -190, 45, 55, 72, 6, 1, -28, -50, 66, 32, -34, 30, 107, -55, 46, -5, 11, 9, 21, -78, 52, -63, -72, 91, -31, -20, -38, -124, 113, 94, 40, 2, -98, 37, -32, 35, 7, -2, -9, 16, 65, 59, -14, -1, 5, 41, -17, 29, -18, 31, 15, -22, 41, 9, 3, 62, 23, 85, 33, -75, -23, -4, -22, 45, -3, 0, -39, 59, -20, 0, -56, 7, 31, 21, 30, 5, 21, 10, -75, 5, 26, 67, 57, 0, -15, -93, 6, 59, -71, -52, 39, -55, 34, 44, 49, -15, -22, -48, -68, -16, 41, 17, -7, 12, -75, -45, 6, 78, 119, -23, 20, -9, -11, 45, -17, -8, -8, -16, 45, 50, -3, -46, 26, 96, 2, -11, 11, -60, 116, 62, 4, -24, -78, -81, 4, -43, 15, -2, 75, 23, -5, 9, -15, -16, 1, 38, 81, 19, 50, 45, -14, -10, 107, 98, 126, 10, -92, -123, -203, -89, 78, 59, -28, 143, 2, -10, -45, 16, -39, -35, -41, 44, -34, -50, -15, 56, 21, -9, -78, -39, 53, 12, -68, -5, -40, -43, 2, -81, -101, -23, 46, 3, -67, 75, 84, 5, -33, 76, -27, -14, 26, -36, -18, -29, -7, 61, -2, -57, -86, -134, 36, 137, -91, 124, -8, -57, 32, 8, -13, -80, 33, -73, 19, -67, 25, -22, -26, -64, 38, 73, 33, -82, 22, 44, -121, -61, 98, 60, 49, -166, -104, 4, 8, -53, -34, 5, -14, -41, 11, -1, -122, 48, -17, -76, 52, -59, 9, 75, 0, -10, 63, -33, -31, 93, -7, 18, 95, -125, 14, -31, 67, 73, -39, -45, -3, 24, -64, 4, 92, -46, 27, 0, 6, 67, 10, -55, 6, -26, -16, 2, -100, 73, -119, -34, 43, -186, -55, 34, 11, -29, -19, 20, -24, -33, 3, -20, -33, -89, -46, -48, -156, -69, 75, 39, 61, -45, -79, 5, -114, -80, 66, -8, 10, -14, -15, -33, 10, -22, 52, -10, 22, 17, -38, -90, 46, 2, -55, -13, 4, 4, 8, -23, -50, 38, 43, -33, -58, -41, 0, -24, -48, 6, 32, 5, -31, -22, -16, 14, -23, -100, -61, -71, 39, 55, 22, 51, -24, -93, -95, -69, -89, -1, 6, -43, 46, -1, -89, -17, 45, -49, 2, 24, 32, -51, -64, 103, -19, 73, -20, -41, 18, -19, -54, -32, -12, -64, 99, -5, -6, 26, 35, -11, 19, 6, -28, 38, 49, 39, -18, 5, 8, 50, -49, -23, 68, 7, 15, 39, -28, -5, 22, 8, 13, 6, -20, 16, -1, -31, -31, -34, -55, -41, 20, -69, 3, 36, -48, 70, -42, -62, 116, -54, -46, -4, 0, -19, 103, -55, 30, -23, 153, 24, 85, 29, -43, 15, 33, 5, 88, 57, -30, 7, -5, -2, 21, 15, 5, 55, -41, -74, -2, 83, 70, 14, -3, -44, 88, -4, -29, 91, 38, -21, 20, 1, -23, 11, -18, -21, -105, -23, 5, 150, 57, -27, 0, -73, 68, 78, -2, 17, -80, -4, 58, -54, -49, 94, 25, 8, -21, 56, -12, 22, -5, 3, -17, 3, -47, -54, -43, -25, -69, -110, 43, 6, -185, 70, -25, -23, -23, -26, -26, -33, 15, -46, -18, 16, -15, -37, 13, 3, 72, -21, -41, 3, -5, -8, -8, -1, 6, -9, -23, -38, 18, -43, 70, -54, 81, -9, -12, -18, 13, 10, 37, 0, -29, 16, -6, -10, 54, 9, -35, 49, -10, -88, -43, 6, 21, 99, 33, 36, 32, -38, 54, -5, -36, -4, 89, -76, -19, 6, 7, -17, -62, -4, 59, 94, 58, 87, -6, -68, -58, -125, 64, 45, 7, -147, 13, -124, 46, -31, -35, -41, 47, -48, 23, -24, 56, -72, -18, 51, -91, 67, -71, -56, -5, -37, -72, 10, -72, -117, 22, -12, -3, -18, 17, -8, 39, -10, 14, -5, -3, -41, 26, 20, -46, 8, 24, -15, 45, -4, 20, 44, 16, -4, -7, 16, -45, -22, 10, 18, -4, -49, 8, -7, -19, 7, 14, -4, -36, 0, 36, -30, 23, 2, 13, 47, -19, -1, -14, -39, 0, -12, -35, 13, 16, 10, 55, -92, 25, 22, -10, -34, 18, -1, -57, 3, -16, -56, 43, -10, -60, 100, -69, -76, -3, -16, -47, 107, -57, -94, -52, 53, 18, 22, -14, -40, 43, -18, -8, -6, 10, 46, 38, 40, -110, 42, 83, 36, 115, 88, 31, -45, -157, -99, 86, 14, -16, -121, 26, -16, 43, 20, 35, 38, -30, -27, 90, -8, -100, -116, -72, -79, -155, -81, 105, 94, 97, -65, -45, -92, -145, -60, -26, 18, 13, -66, -16, -16, -19, -68, -17, -41, -52, 2, 21, -19, 33, 23, -28, 58, 7, 0, 72, -45, -19, 33, -38, 57, -6, 61, 2, -21, -45, -14, -20, 14, 42, -26, 3, 26, 0, -3, -17, 29, 31, 31, 47, 18, 19, 8, 7, 28, 109, 113, 71, 11, 7, -62, -42, -6, -6, -21, 17, 45, -16, -3, -15, -13, -27, -8, -19, 0, -23, -39, 57, -37, -55, 1, 10, 47, -69, 1, 25, 87, -32, 24, -9, 24, -22, 13, -116, 41, 117, -52, 111, -59, 56, -46, -44, 146, 158, 47, -107, -81, -31, 144, -109, -68, -20, 12, -22, 2, -39, 16, -38, -33, -52, 26, 40, -17, -69, -58, 6, 15, 33, 103, 66, 3, -78, -193, -102, 10, 17, -2, 13, 30, -23, 23, 15, 13, 15, -7, 35, 16, -24, 0, 0, 29, -25, 16, 66, -23, -1, -3, 10, 15, 44, -23, 68, -25, -32, -20, -5, -5, 3, 8, 9, -1, 21, 43, 6, 37, -9, -20, 48, -74, -12, -30, 41, 20, 39, 62, -25, 169, -20, -2, -81, 97, 0, -37, 51, 112, -133, -24, 8, -52, 0, -13, -70, 102, 155, -74, -9, -79, -52, 41, -35, 100, -62, -50, -5, -13, 26, -20, 16, -21, -19, -46, 30, 0, 1, -9, -58, -53, -22, 29, -34, 17, 3, 25, 31, -28, -22, -5, -24}
 }
 ;
 
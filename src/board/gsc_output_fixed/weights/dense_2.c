@@ -14,7 +14,7 @@
 const int16_t dense_2_bias[FC_UNITS] = {61}
 ;
 
-const int16_t dense_2_kernel[FC_UNITS][INPUT_SAMPLES] = {{12, 37, -5, -8, 98, -19, -11, -42, 23, -62, -9, 56, -22, -118, -70, -54, 51, 32, -109, 28, 43, -48, 9, 35, -49, -12, 49, -44, -13, -35, -11, -22, 35, 24, -65, 7, 7, -39, 30, 6, 56, -21, -31, -13, -52, -22, 1, -5, -75, -3, -53, -76, -17, 25, 39, 83, -3, 21, 10, -52, -51, 44, 27, 13, -18, -38, -29, 63, -14, -81, 33, -56, 34, -24, -121, -73, -57, -53, -77, 45, 20, -32, 142, 68, 80, 70, 31, -52, -19, 16, 13, -37, -32, -63, 20, 91, 130, 23, 44, -44, 30, 148, 192, -25, -60, 118, 7, 7, -17, 127, -82, -116, -92, 34, 28, 172, 94, -45, -61, 41, -58, -50, 54, -31, 0, -36, -109, 43, 51, 37, 39, 10, -4, 12, 35, 13, 12, -17, 0, 29, -16, 32, 24, -56, 30, 58, 29, -21, -58, 47, 10, -15, -56, 36, 69, 32, 14, -3, 42, -20, 116, -2, 53, 13, 26, -36, 27, 98, -65, -101, 20, -63, 85, 74, -105, 13, 30, -27, 99, 12, -88, 138, 35, -34, 57, 17, -18, 13, -32, -13, 19, -5, 0, -50, -23, 15, -17, -4, -7, -13, -49, 21, -2, -60, -35, 11, -15, 13, -39, 77, -33, -28, -53, 18, -29, 22, -10, 7, -1, 16, 18, 46, 55, -21, -2, 54, 8, 45, 0, 28, 29, -7, -20, 31, 31, -84, -22, 100, 36, 26, -10, -62, -75, -93, 15, -6, -109, 1, -49, -125, 6, -147, -27, 49, 131, 85, -45, -130, -49, -24, -12, -24, -66, 11, 26, -35, 38, -13, 79, -61, 15, -5, 78, -5, -51, 35, 41, 32, 94, -6, 32, 134, 35, -6, 48, -90, -19, 40, 17, 60, 7, -30, 2, 36, -34, 20, 31, 48, 30, -13, 6, 18, 70, 9, 54, 69, -3, 34, 51, -17, -26, -14, 129, -60, -44, -70, 88, 0, -55, -8, 53, -76, -60, 1, -52, 55, 72, 170, 108, -64, -107, -193, -60, 34, 212, 166, 146, 32, -37, -56, 12, 2, -24, 92, -54, 15, 71, -52, -97, 7, 37, 10, -45, 44, 37, -103, 112, -51, 54, 88, 158, -40, 86, -15, 112, 0, -14, 29, -115, -37, -29, 58, -83, -58, -3, 115, -118, 11, 175, -19, -40, 52, -2, 185, -43, -172, -54, -80, 144, 85, 99, -51, -20, -123, 43, 35, 78, -110, -86, -93, -32, 8, 97, 0, 53, -21, -53, -27, 39, 47, 99, 43, -49, -16, -65, -4, -27, -40, 177, 45, -58, 14, 63, 44, -47, -7, -19, -40, 54, 162, 77, 138, 103, 213, 67, 15, 102, -30, 40, 25, 78, 79, -89, 98, 56, 111, -58, -17, -83, -83, -43, 73, 36, 108, 22, -16, -8, -51, -24, -62, 59, 53, -75, -170, -124, 116, 52, 163, -13, -155, 62, 103, -78, 20, -24, -29, 65, 16, 17, -12, 86, -20, -77, -20, 3, 182, -33, -66, 69, -125, -105, -18, 141, 231, 3, -5, -22, -33, 12, 18, -17, 2, 12, -18, -17, -22, 35, -41, 10, 33, 27, -14, 2, -55, -14, -37, -64, -31, -58, -13, 55, -96, 9, -93, 15, -23, 25, 28, -36, -42, -85, -8, -30, -81, 124, 23, -141, 30, -37, -32, 0, 6, -34, 34, -60, -78, 149, -146, 121, 94, 29, -54, -76, -46, -42, -60, -35, 97, 52, 80, -42, 0, -67, 13, -49, 15, 178, -94, -169, -139, -81, 85, -59, 2, -31, 57, 2, 15, 9, -31, -13, -44, 16, 22, -41, 89, -42, -27, 33, -26, 86, 49, 18, -14, -58, -6, 55, -64, -27, 3, 30, -7, 4, 14, 18, -19, -43, -33, 12, 3, 16, -13, -54, 21, 36, 2, 19, -77, 10, -3, -32, -38, -27, -92, 157, -18, 49, -5, 24, -98, 0, -102, 91, 85, 11, -60, 53, 121, 18, 124, -207, -139, -59, 1, 184, 50, 55, -9, 46, 15, 11, -4, 0, -2, -9, -18, -34, 47, 35, -14, -16, -35, -15, -15, -3, -2, 3, -8, -7, 16, -43, 4, 30, -26, -1, 12, 16, 60, 26, -15, 20, 26, 31, 0, 53, -13, 39, 24, 15, -42, 59, -26, -17, 55, -97, 49, -28, -83, 74, 32, -5, 17, -38, 36, -16, 20, -16, 7, 86, 17, 24, 59, -23, -7, -31, -121, 31, 2, -87, -98, 43, -114, 19, 10, -60, -87, 4, -88, -16, 3, 176, 104, -63, -9, 75, 18, 0, -3, 35, 66, -6, 26, -25, 157, 62, 55, 59, -31, 58, -22, -64, 191, 101, 155, 39, -76, -48, 10, 13, 9, -31, -75, -111, -15, -52, -57, -89, 101, 113, -40, -69, -232, -78, 7, 140, 189, 109, 41, -54, -11, -8, -28, 46, 33, 115, 33, 92, 84, -10, -30, 26, 117, -39, -132, -4, -70, 75, 76, -84, 93, 96, 13, 96, 61, -3, 102, 20, -98, 19, -22, 43, -22, 39, -52, -51, -90, -50, 37, 34, 33, 61, -14, 0, 36, 19, 76, 26, -58, -44, -11, -89, 23}
+const int16_t dense_2_kernel[FC_UNITS][INPUT_SAMPLES] NUMBER_ALIGN = {{12, 37, -5, -8, 98, -19, -11, -42, 23, -62, -9, 56, -22, -118, -70, -54, 51, 32, -109, 28, 43, -48, 9, 35, -49, -12, 49, -44, -13, -35, -11, -22, 35, 24, -65, 7, 7, -39, 30, 6, 56, -21, -31, -13, -52, -22, 1, -5, -75, -3, -53, -76, -17, 25, 39, 83, -3, 21, 10, -52, -51, 44, 27, 13, -18, -38, -29, 63, -14, -81, 33, -56, 34, -24, -121, -73, -57, -53, -77, 45, 20, -32, 142, 68, 80, 70, 31, -52, -19, 16, 13, -37, -32, -63, 20, 91, 130, 23, 44, -44, 30, 148, 192, -25, -60, 118, 7, 7, -17, 127, -82, -116, -92, 34, 28, 172, 94, -45, -61, 41, -58, -50, 54, -31, 0, -36, -109, 43, 51, 37, 39, 10, -4, 12, 35, 13, 12, -17, 0, 29, -16, 32, 24, -56, 30, 58, 29, -21, -58, 47, 10, -15, -56, 36, 69, 32, 14, -3, 42, -20, 116, -2, 53, 13, 26, -36, 27, 98, -65, -101, 20, -63, 85, 74, -105, 13, 30, -27, 99, 12, -88, 138, 35, -34, 57, 17, -18, 13, -32, -13, 19, -5, 0, -50, -23, 15, -17, -4, -7, -13, -49, 21, -2, -60, -35, 11, -15, 13, -39, 77, -33, -28, -53, 18, -29, 22, -10, 7, -1, 16, 18, 46, 55, -21, -2, 54, 8, 45, 0, 28, 29, -7, -20, 31, 31, -84, -22, 100, 36, 26, -10, -62, -75, -93, 15, -6, -109, 1, -49, -125, 6, -147, -27, 49, 131, 85, -45, -130, -49, -24, -12, -24, -66, 11, 26, -35, 38, -13, 79, -61, 15, -5, 78, -5, -51, 35, 41, 32, 94, -6, 32, 134, 35, -6, 48, -90, -19, 40, 17, 60, 7, -30, 2, 36, -34, 20, 31, 48, 30, -13, 6, 18, 70, 9, 54, 69, -3, 34, 51, -17, -26, -14, 129, -60, -44, -70, 88, 0, -55, -8, 53, -76, -60, 1, -52, 55, 72, 170, 108, -64, -107, -193, -60, 34, 212, 166, 146, 32, -37, -56, 12, 2, -24, 92, -54, 15, 71, -52, -97, 7, 37, 10, -45, 44, 37, -103, 112, -51, 54, 88, 158, -40, 86, -15, 112, 0, -14, 29, -115, -37, -29, 58, -83, -58, -3, 115, -118, 11, 175, -19, -40, 52, -2, 185, -43, -172, -54, -80, 144, 85, 99, -51, -20, -123, 43, 35, 78, -110, -86, -93, -32, 8, 97, 0, 53, -21, -53, -27, 39, 47, 99, 43, -49, -16, -65, -4, -27, -40, 177, 45, -58, 14, 63, 44, -47, -7, -19, -40, 54, 162, 77, 138, 103, 213, 67, 15, 102, -30, 40, 25, 78, 79, -89, 98, 56, 111, -58, -17, -83, -83, -43, 73, 36, 108, 22, -16, -8, -51, -24, -62, 59, 53, -75, -170, -124, 116, 52, 163, -13, -155, 62, 103, -78, 20, -24, -29, 65, 16, 17, -12, 86, -20, -77, -20, 3, 182, -33, -66, 69, -125, -105, -18, 141, 231, 3, -5, -22, -33, 12, 18, -17, 2, 12, -18, -17, -22, 35, -41, 10, 33, 27, -14, 2, -55, -14, -37, -64, -31, -58, -13, 55, -96, 9, -93, 15, -23, 25, 28, -36, -42, -85, -8, -30, -81, 124, 23, -141, 30, -37, -32, 0, 6, -34, 34, -60, -78, 149, -146, 121, 94, 29, -54, -76, -46, -42, -60, -35, 97, 52, 80, -42, 0, -67, 13, -49, 15, 178, -94, -169, -139, -81, 85, -59, 2, -31, 57, 2, 15, 9, -31, -13, -44, 16, 22, -41, 89, -42, -27, 33, -26, 86, 49, 18, -14, -58, -6, 55, -64, -27, 3, 30, -7, 4, 14, 18, -19, -43, -33, 12, 3, 16, -13, -54, 21, 36, 2, 19, -77, 10, -3, -32, -38, -27, -92, 157, -18, 49, -5, 24, -98, 0, -102, 91, 85, 11, -60, 53, 121, 18, 124, -207, -139, -59, 1, 184, 50, 55, -9, 46, 15, 11, -4, 0, -2, -9, -18, -34, 47, 35, -14, -16, -35, -15, -15, -3, -2, 3, -8, -7, 16, -43, 4, 30, -26, -1, 12, 16, 60, 26, -15, 20, 26, 31, 0, 53, -13, 39, 24, 15, -42, 59, -26, -17, 55, -97, 49, -28, -83, 74, 32, -5, 17, -38, 36, -16, 20, -16, 7, 86, 17, 24, 59, -23, -7, -31, -121, 31, 2, -87, -98, 43, -114, 19, 10, -60, -87, 4, -88, -16, 3, 176, 104, -63, -9, 75, 18, 0, -3, 35, 66, -6, 26, -25, 157, 62, 55, 59, -31, 58, -22, -64, 191, 101, 155, 39, -76, -48, 10, 13, 9, -31, -75, -111, -15, -52, -57, -89, 101, 113, -40, -69, -232, -78, 7, 140, 189, 109, 41, -54, -11, -8, -28, 46, 33, 115, 33, 92, 84, -10, -30, 26, 117, -39, -132, -4, -70, 75, 76, -84, 93, 96, 13, 96, 61, -3, 102, 20, -98, 19, -22, 43, -22, 39, -52, -51, -90, -50, 37, 34, 33, 61, -14, 0, 36, 19, 76, 26, -58, -44, -11, -89, 23}
 }
 ;
 
@@ -0,0 +1,22 @@
+/**
+  ******************************************************************************
+  * @file    weights/dense_4_sparse.c
+  * @brief   dense_4 magnitude-pruned to 50% zero weights, nonzero weights with one-byte index deltas
+  *          Generated by main --prune, do not edit
+  */
+
+#define FC_UNITS 1
+#define SPARSE_ENTRIES 832
+
+// 832/1664 weights left out, magnitudes up to 24 pruned, 0 zero entries bridge long gaps
+const uint16_t dense_4_sparse_counts[FC_UNITS] = {832}
+;
+
+const int16_t dense_4_sparse_values[SPARSE_ENTRIES] NUMBER_ALIGN = {-41, 40, 41, -39, 45, 39, 26, 28, -73, 67, -58, -39, -39, -30, -60, 33, 33, 37, -48, 40, 57, 148, -35, -64, 25, 32, -128, 49, -38, 29, -62, 27, -78, -26, 89, 54, 40, -68, -47, 71, -135, -140, 117, 100, 28, -77, 66, 38, -34, 28, 50, -35, -25, 64, -28, 56, 30, 58, 63, 35, -53, 26, 33, 51, 103, 45, -58, -119, -109, 65, 31, -65, -44, 66, -38, 27, -33, 56, -32, 52, -82, -73, 33, 27, -81, 32, 55, -57, 31, 73, -90, -48, -31, -81, -27, -37, 61, 39, 35, -60, 62, -58, -25, -41, -40, -30, -76, 66, 93, 82, -56, -80, -161, -30, -30, 37, 69, 39, -46, 71, 42, 70, -118, -25, 53, -46, 44, -45, -30, -80, 99, -99, 55, -127, 84, 118, 64, -76, -118, 49, -29, 26, 28, -42, -25, -39, 35, 26, -28, 43, -35, 34, -38, 25, -40, 26, -25, -43, -45, -33, -26, 44, 25, 43, -55, 37, -40, 37, -24, 34, 28, -26, -28, -69, 32, -50, -29, -29, -46, 28, 103, -79, -38, 43, -70, -84, 42, -37, 33, -55, -74, -35, 30, 145, 41, 145, -41, -24, -80, 107, -42, 104, -132, -36, 130, -96, -30, -89, -108, 76, -56, 106, 38, 30, 29, 26, -26, -30, -53, 28, -30, -27, 26, -45, 26, -38, 29, -34, -25, -40, 45, -50, -50, 30, -35, 24, -67, 33, 35, 49, -28, -29, -31, -28, -26, 92, 69, -76, -26, -47, 31, 32, -62, 29, -64, 25, 72, -120, -25, -33, -25, 39, -24, 29, 28, 38, -55, 38, -34, -26, 56, -30, 87, -43, 56, -149, 69, 42, -86, -77, 26, -33, -38, 35, -38, 57, -27, 38, 24, 56, 56, 56, 34, -31, 33, -39, 79, -49, 28, -47, -68, 66, -88, -36, -129, 110, -35, -33, -129, -35, -34, -43, -28, -80, -42, -30, -57, 26, 32, -84, -129, -47, -61, -28, -58, -25, -41, 96, 86, 50, -46, 42, 61, -45, 72, -68, 36, 47, -53, 99, -61, 99, 71, -161, -105, -53, -53, -24, 92, -78, 38, 34, -39, 29, -36, 25, 30, 45, -27, 55, 78, 58, -36, -55, 72, -42, -47, 62, -61, -35, 39, -24, 104, -64, -46, 24, -41, -49, -49, -110, -72, -97, -104, 28, 54, -132, -81, -72, -101, 75, -33, -36, 63, -68, -57, 57, -40, -73, -46, -39, -56, 108, 66, 24, -103, -154, -55, -92, 68, -39, 27, 39, -26, -62, 35, 51, -25, -41, -86, -32, 38, 64, 68, -76, -49, 28, 41, 59, -29, -42, 24, -33, 61, 72, 31, 28, -73, 38, 39, -37, 32, -30, 32, 70, -39, 47, -38, -52, 38, -43, -27, -42, -40, -53, 25, 45, -41, 50, 33, -110, 33, -32, 42, 24, -62, -28, -29, 35, -94, 65, -29, 51, -49, -45, -38, -33, 28, -85, -24, -80, -100, -51, 75, 38, -70, -60, 24, 41, -27, 60, -24, 29, 38, -31, -36, 48, 34, 29, 27, 30, 24, 31, 52, 26, 32, 58, 27, -28, -26, 49, 24, -33, 35, 44, -62, 25, -27, 50, -30, -34, 33, 48, -25, 38, -31, -29, -36, -28, 27, 25, -29, 34, 26, 25, 68, 29, 47, -49, 38, -27, 44, -63, 64, -30, 55, 25, 29, 30, -59, -32, 33, 31, 28, -62, 53, 45, -27, -41, 41, 40, 120, -39, 73, -87, 134, 91, -24, -197, -63, -55, -25, 27, -36, -27, 26, -34, -25, -26, -41, -24, -31, -47, 40, 29, 29, 54, 40, -43, -37, 41, -34, 35, 31, 26, 40, 65, -50, 78, 61, -34, 40, 34, -76, 40, 58, 104, 128, 46, 32, -139, -36, 28, -37, 26, 41, -37, -30, -28, -47, 36, 25, 38, 34, -46, -48, 112, -88, -35, 56, -28, -44, -64, 114, 32, -63, 44, 25, 94, -102, 27, 43, -45, -25, 99, 97, -36, -90, -31, 131, 28, -41, 49, -28, 35, -172, 84, 42, 71, -85, -97, -87, -63, 29, -40, -30, -26, 29, -52, -30, -53, -25, 34, -32, -35, 25, 25, -30, 30, -39, 40, -50, 40, -63, 50, 37, -77, -48, 66, -88, -42, 57, -100, 36, 32, 86, -137, 68, 26, -40, 74, -47, 89, 34, -62, -27, -31, -26, 37, 99, 34, 81, 42, -24, 42, 35, -87, -145, -36, -29, 29, 24, -26, 26, -27, -36, -25, 36, 32, 27, -53, 61, 30, 76, -44, -28, -24, 24, -84, -30, 75, -55, 90, -56, 33, -60, -32, -71, -68, -58, -69, -51, -40, 46, -25, -54, -46, -40, -43, -30, 64, -101, 45, 25, 39, -79, 48, -32, -57, 29, 58, 109, 46, -34, 78, -64, 102, -31, -62, 40, -66, -25, -29, 58, -46, 56, 31, -26, 63, -55, 57, -37, -78, -30, 30, -29, -26, -33, -49, 35, -30, -28, -148, 45, -57, 51, 35, 48, -68, 44, 57, -58, -30, 60, 59, 68, -75, 74, 25, -34, 103, -143, 53, 40, -61, 142, 114, 54, -54, -135, 39, -35, -68}
+;
+
+const uint8_t dense_4_sparse_deltas[SPARSE_ENTRIES] = {3, 2, 1, 4, 7, 4, 3, 1, 1, 2, 1, 1, 7, 1, 1, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 2, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 8, 2, 5, 1, 1, 3, 3, 1, 7, 2, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 4, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 1, 2, 1, 2, 1, 1, 2, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 4, 2, 2, 12, 2, 2, 1, 1, 1, 1, 1, 2, 3, 1, 1, 1, 1, 2, 3, 1, 2, 1, 1, 1, 1, 1, 1, 10, 1, 1, 3, 3, 1, 2, 1, 15, 2, 6, 4, 2, 1, 8, 5, 1, 1, 1, 14, 5, 1, 4, 1, 2, 2, 1, 4, 3, 1, 7, 4, 1, 1, 1, 2, 1, 1, 4, 1, 3, 1, 3, 4, 2, 2, 2, 1, 2, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1, 3, 4, 2, 1, 1, 1, 1, 1, 1, 3, 2, 6, 2, 1, 1, 1, 2, 3, 10, 1, 3, 3, 2, 3, 2, 1, 2, 3, 2, 6, 5, 2, 2, 3, 1, 3, 4, 5, 1, 2, 5, 1, 13, 1, 3, 2, 3, 1, 3, 1, 2, 4, 1, 3, 1, 2, 7, 3, 1, 5, 1, 4, 1, 2, 3, 1, 3, 1, 5, 2, 1, 2, 1, 1, 2, 2, 2, 4, 3, 3, 2, 1, 1, 5, 1, 1, 2, 1, 2, 1, 2, 2, 2, 1, 1, 3, 2, 3, 2, 1, 1, 2, 1, 2, 2, 1, 7, 1, 1, 1, 2, 1, 1, 1, 3, 1, 1, 1, 1, 1, 2, 2, 1, 3, 5, 5, 3, 1, 1, 1, 1, 3, 5, 2, 1, 2, 1, 1, 1, 1, 3, 1, 1, 1, 1, 1, 2, 5, 1, 1, 1, 2, 1, 1, 1, 3, 1, 9, 2, 2, 1, 4, 3, 2, 5, 1, 1, 1, 1, 2, 4, 1, 3, 6, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 1, 1, 1, 2, 5, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 7, 1, 1, 2, 1, 1, 1, 3, 1, 1, 1, 1, 1, 4, 1, 1, 1, 3, 1, 1, 3, 5, 3, 1, 1, 1, 1, 1, 2, 2, 1, 6, 5, 1, 1, 4, 6, 3, 3, 1, 2, 4, 2, 1, 1, 3, 1, 1, 1, 1, 2, 3, 2, 1, 5, 5, 1, 2, 5, 1, 1, 1, 1, 2, 1, 5, 3, 2, 1, 1, 1, 1, 1, 1, 1, 1, 5, 3, 2, 7, 2, 2, 2, 1, 1, 1, 1, 1, 6, 2, 1, 5, 3, 3, 1, 1, 1, 2, 3, 3, 3, 1, 4, 3, 2, 1, 2, 1, 1, 1, 1, 1, 1, 2, 4, 5, 4, 3, 1, 1, 4, 2, 2, 2, 3, 3, 2, 1, 2, 4, 2, 3, 1, 1, 1, 1, 3, 3, 10, 1, 2, 1, 1, 1, 1, 1, 2, 2, 3, 3, 1, 1, 2, 1, 1, 1, 2, 1, 1, 2, 1, 3, 4, 1, 1, 1, 2, 5, 4, 1, 3, 1, 2, 1, 4, 1, 1, 2, 1, 1, 1, 2, 2, 1, 4, 2, 1, 2, 2, 1, 3, 4, 3, 1, 1, 2, 1, 1, 1, 1, 1, 1, 6, 1, 2, 1, 2, 9, 1, 1, 1, 1, 4, 7, 2, 2, 3, 1, 1, 1, 1, 3, 3, 2, 1, 1, 2, 2, 1, 1, 1, 1, 1, 3, 1, 2, 1, 1, 3, 1, 10, 3, 1, 2, 1, 1, 1, 1, 2, 2, 1, 1, 2, 2, 1, 5, 4, 2, 1, 2, 2, 3, 11, 3, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 1, 1, 2, 1, 1, 2, 2, 1, 1, 5, 2, 1, 1, 1, 1, 3, 2, 1, 1, 1, 1, 1, 1, 3, 2, 1, 1, 1, 1, 1, 1, 2, 1, 1, 2, 2, 1, 1, 1, 7, 1, 3, 1, 1, 3, 3, 1, 1, 1, 1, 1, 6, 3, 4, 1, 2, 1, 1, 1, 2, 1, 1, 2, 1, 3, 2, 1, 4, 4, 1, 2, 1, 1, 1, 1, 1, 4, 1, 1, 1, 1, 2, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 1, 4, 3, 1, 8, 2, 2, 1, 1, 1, 1, 1, 2, 2, 2, 6, 3, 3, 1, 1, 4, 3, 2, 2, 5, 3, 1, 1, 1, 4, 2, 2, 2, 1, 1, 1, 1, 1, 1, 2, 1, 2, 2, 1, 2, 1, 2, 2, 2, 1, 1, 1}
+;
+
+#undef FC_UNITS
+#undef SPARSE_ENTRIES
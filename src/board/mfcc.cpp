@@ -0,0 +1,281 @@
+#include <math.h>
+#include <string.h>
+
+#include "mfcc.h"
+
+static_assert(MFCC_N_FFT % (4 * MFCC_N_MELS) == 0, "DCT angles must fall on the cosine table");
+static_assert(MFCC_N_MELS + 1 < 0xFF, "Mel segment index must fit in a byte");
+
+// librosa.hz_to_mel(htk=False): linear below 1 kHz, logarithmic above
+static double hzToMel(double hz) {
+  if (hz < 1000.0) {
+    return hz * 3.0 / 200.0;
+  }
+  return 15.0 + log(hz / 1000.0) * 27.0 / log(6.4);
+}
+
+static double melToHz(double mel) {
+  if (mel < 15.0) {
+    return mel * 200.0 / 3.0;
+  }
+  return 1000.0 * exp((mel - 15.0) * log(6.4) / 27.0);
+}
+
+MFCC::MFCC() {
+  for (unsigned int m = 0; m <= MFCC_N_FFT / 4; m++) {
+    cos_table[m] = (int16_t)fmin(lround(cos(2.0 * M_PI * m / MFCC_N_FFT) * 32768.0), 32767.0);
+  }
+  for (unsigned int i = 0; i < 256; i++) {
+    log2_table[i] = (uint16_t)lround(log2(1.0 + i / 256.0) * 65536.0);
+  }
+
+  // Mel points evenly spaced on the mel scale from 0 to the Nyquist frequency, filter j spans points j to j + 2
+  double hz[MFCC_N_MELS + 2];
+  double max_enorm = 0.0;
+  for (unsigned int j = 0; j < MFCC_N_MELS + 2; j++) {
+    hz[j] = melToHz(hzToMel(MFCC_SAMPLE_RATE / 2.0) * j / (MFCC_N_MELS + 1));
+  }
+  for (unsigned int j = 0; j < MFCC_N_MELS; j++) {
+    max_enorm = fmax(max_enorm, 2.0 / (hz[j + 2] - hz[j])); // Slaney normalization
+  }
+  for (weight_shift = 0; max_enorm * (1 << (weight_shift + 1)) < 65535.0; weight_shift++);
+
+  unsigned int j = 0;
+  for (unsigned int k = 0; k < bins; k++) {
+    double f = (double)k * MFCC_SAMPLE_RATE / MFCC_N_FFT;
+    while (j < MFCC_N_MELS + 1 && f >= hz[j + 1]) {
+      j++;
+    }
+    if (j >= MFCC_N_MELS + 1) {
+      bin_segment[k] = 0xFF;
+      bin_rise[k] = bin_fall[k] = 0;
+      continue;
+    }
+    double rise = (f - hz[j]) / (hz[j + 1] - hz[j]);
+    bin_segment[k] = j;
+    bin_rise[k] = j < MFCC_N_MELS ? (uint16_t)lround(rise * 2.0 / (hz[j + 2] - hz[j]) * (1 << weight_shift)) : 0;
+    bin_fall[k] = j > 0 ? (uint16_t)lround((1.0 - rise) * 2.0 / (hz[j + 1] - hz[j - 1]) * (1 << weight_shift)) : 0;
+  }
+
+  dct_scale[0] = (int32_t)lround(sqrt(1.0 / MFCC_N_MELS) * 1073741824.0);
+  dct_scale[1] = (int32_t)lround(sqrt(2.0 / MFCC_N_MELS) * 1073741824.0);
+
+  reset();
+}
+
+void MFCC::reset() {
+  memset(history, 0, sizeof(history)); // Zero padding before the first sample
+  samples = 0;
+  frames = 0;
+  max_db = MFCC_AMIN_DB * 65536;
+  memset(mel_sum, 0, sizeof(mel_sum));
+  memset(mel_clipped, 0, sizeof(mel_clipped));
+}
+
+// cos(2 pi m / MFCC_N_FFT) in Q15 from the first quarter
+int32_t MFCC::cosq15(uint32_t m) const {
+  m %= MFCC_N_FFT;
+  if (m <= MFCC_N_FFT / 4) {
+    return cos_table[m];
+  } else if (m <= MFCC_N_FFT / 2) {
+    return -cos_table[MFCC_N_FFT / 2 - m];
+  } else if (m <= MFCC_N_FFT * 3 / 4) {
+    return -cos_table[m - MFCC_N_FFT / 2];
+  }
+  return cos_table[MFCC_N_FFT - m];
+}
+
+int32_t MFCC::sinq15(uint32_t m) const {
+  return cosq15(m + MFCC_N_FFT - MFCC_N_FFT / 4);
+}
+
+// log2(v) in Q16 for v > 0, table lookup on the 8 bits after the leading one and linear interpolation on the next 16
+int32_t MFCC::log2q16(uint64_t v) const {
+  int n = 63 - __builtin_clzll(v);
+  uint64_t m = v << (63 - n);
+  uint32_t i = (m >> 55) & 0xFF;
+  int32_t frac = (m >> 39) & 0xFFFF;
+  int32_t lo = log2_table[i];
+  int32_t hi = i == 255 ? 65536 : log2_table[i + 1];
+  return n * 65536 + lo + (int32_t)(((int64_t)(hi - lo) * frac) >> 16);
+}
+
+// In-place radix-2 complex FFT of re + i im, Q15 twiddles with 32-bit data: no scaling is needed since
+// windowed samples have 18 significant bits and the transform adds at most 11
+void MFCC::fft() {
+  for (unsigned int i = 1, j = 0; i < fft_size; i++) {
+    unsigned int bit = fft_size >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      int32_t t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+
+  for (unsigned int len = 2; len <= fft_size; len <<= 1) {
+    unsigned int step = MFCC_N_FFT / len; // exp(-2 pi i k / len) = exp(-2 pi i k step / MFCC_N_FFT)
+    for (unsigned int k = 0; k < len / 2; k++) {
+      int64_t c = cosq15(k * step);
+      int64_t s = sinq15(k * step);
+      for (unsigned int a = k; a < fft_size; a += len) {
+        unsigned int b = a + len / 2;
+        int32_t tr = (int32_t)((re[b] * c + im[b] * s + (1 << 14)) >> 15);
+        int32_t ti = (int32_t)((im[b] * c - re[b] * s + (1 << 14)) >> 15);
+        re[b] = re[a] - tr;
+        im[b] = im[a] - ti;
+        re[a] += tr;
+        im[a] += ti;
+      }
+    }
+  }
+}
+
+// |2 X[k]|^2 from the half-size FFT: 2 X[k] = Z[k] + conj(Z[N - k]) - i W^k (Z[k] - conj(Z[N - k])),
+// 2 X is 2^19 times the float spectrum of librosa so the power is 2^38 times larger
+uint64_t MFCC::binPower(unsigned int k) const {
+  unsigned int a = k % fft_size;
+  unsigned int b = (fft_size - k) % fft_size;
+  int64_t er = (int64_t)re[a] + re[b];
+  int64_t ei = (int64_t)im[a] - im[b];
+  int64_t or_ = (int64_t)re[a] - re[b];
+  int64_t oi = (int64_t)im[a] + im[b];
+  int64_t c = cosq15(k);
+  int64_t s = sinq15(k);
+  int64_t xr = er + ((c * oi - s * or_ + (1 << 14)) >> 15);
+  int64_t xi = ei + ((-c * or_ - s * oi + (1 << 14)) >> 15);
+  return (uint64_t)(xr * xr) + (uint64_t)(xi * xi);
+}
+
+void MFCC::processFrame() {
+  // The frame is the whole history, oldest sample at samples % MFCC_N_FFT. Windowed samples get 3 extra
+  // fractional bits, even ones go to the real part and odd ones to the imaginary part of the half-size FFT
+  for (unsigned int n = 0; n < fft_size; n++) {
+    int32_t x0 = history[(samples + 2 * n) % MFCC_N_FFT];
+    int32_t x1 = history[(samples + 2 * n + 1) % MFCC_N_FFT];
+    int32_t w0 = (32768 - cosq15(2 * n)) >> 1; // Periodic Hann window, Q15
+    int32_t w1 = (32768 - cosq15(2 * n + 1)) >> 1;
+    re[n] = (x0 * w0 + (1 << 11)) >> 12;
+    im[n] = (x1 * w1 + (1 << 11)) >> 12;
+  }
+
+  fft();
+
+  uint64_t max_power = 0;
+  for (unsigned int k = 0; k < bins; k++) {
+    uint64_t p = binPower(k);
+    if (max_power < p) {
+      max_power = p;
+    }
+  }
+
+  // Drop low bits so that weighted sums fit in 64 bits, only powers far below the top_db floor are affected
+  int shift = max_power ? 64 - __builtin_clzll(max_power) - 44 : 0;
+  if (shift < 0) {
+    shift = 0;
+  }
+
+  memset(mel, 0, sizeof(mel));
+  for (unsigned int k = 0; k < bins; k++) {
+    unsigned int j = bin_segment[k];
+    if (j == 0xFF) {
+      continue;
+    }
+    uint64_t p = binPower(k) >> shift; // Recomputed rather than stored, a power spectrum would need 8 KB of stack
+    if (j < MFCC_N_MELS) {
+      mel[j] += p * bin_rise[k];
+    }
+    if (j > 0) {
+      mel[j - 1] += p * bin_fall[k];
+    }
+  }
+
+  // power_to_db: 10 log10(mel) = log2(mel) * 10 log10(2), 10 log10(2) = 197283 / 2^16
+  int32_t db[MFCC_N_MELS];
+  int32_t frame_max = MFCC_AMIN_DB * 65536;
+  for (unsigned int j = 0; j < MFCC_N_MELS; j++) {
+    db[j] = MFCC_AMIN_DB * 65536;
+    if (mel[j]) {
+      int64_t l = log2q16(mel[j]) + (int64_t)(shift - weight_shift - 38) * 65536;
+      int64_t d = (l * 197283) >> 16;
+      if (d > db[j]) {
+        db[j] = (int32_t)d;
+      }
+    }
+    if (frame_max < db[j]) {
+      frame_max = db[j];
+    }
+  }
+
+  if (max_db < frame_max) {
+    max_db = frame_max;
+  }
+  int32_t floor_db = max_db - MFCC_TOP_DB * 65536;
+  for (unsigned int j = 0; j < MFCC_N_MELS; j++) {
+    if (frames < MFCC_MAX_FRAMES) {
+      // Clipped in finish(), AMIN (silence) is stored exactly
+      int32_t q = (db[j] - MFCC_AMIN_DB * 65536 + (1 << 7)) >> 8;
+      frame_db[frames][j] = q > 0xFFFF ? 0xFFFF : q;
+      mel_sum[j] += db[j];
+    } else if (db[j] < floor_db) {
+      mel_clipped[j]++;
+    } else {
+      mel_sum[j] += db[j];
+    }
+  }
+
+  frames++;
+}
+
+void MFCC::push(const int16_t *data, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    history[samples % MFCC_N_FFT] = data[i];
+    samples++;
+
+    // Frame t is centered on sample t * MFCC_HOP_LENGTH
+    if (samples == frames * MFCC_HOP_LENGTH + MFCC_N_FFT / 2) {
+      processFrame();
+    }
+  }
+}
+
+uint32_t MFCC::finish(int32_t coefficients[MFCC_N_COEFFICIENTS]) {
+  // librosa computes 1 + len / hop frames, the last ones run into the zero padding after the clip
+  static const int16_t zero = 0;
+  uint32_t last = samples / MFCC_HOP_LENGTH;
+  while (frames <= last) {
+    push(&zero, 1);
+  }
+
+  // top_db: stored values below the final floor are raised to it
+  int32_t floor_db = max_db - MFCC_TOP_DB * 65536;
+  for (unsigned int t = 0; t < frames && t < MFCC_MAX_FRAMES; t++) {
+    for (unsigned int j = 0; j < MFCC_N_MELS; j++) {
+      int32_t value = MFCC_AMIN_DB * 65536 + frame_db[t][j] * 256;
+      if (value < floor_db) {
+        mel_sum[j] += floor_db - value;
+      }
+    }
+  }
+
+  int32_t mean[MFCC_N_MELS];
+  for (unsigned int j = 0; j < MFCC_N_MELS; j++) {
+    mean[j] = (int32_t)((mel_sum[j] + (int64_t)mel_clipped[j] * floor_db) / (int64_t)frames);
+  }
+
+  // DCT-II ortho: c[k] = scale[k] * sum of mean[n] cos(pi k (2 n + 1) / (2 MFCC_N_MELS))
+  for (unsigned int k = 0; k < MFCC_N_COEFFICIENTS; k++) {
+    int64_t acc = 0;
+    for (unsigned int n = 0; n < MFCC_N_MELS; n++) {
+      acc += (int64_t)mean[n] * cosq15(k * (2 * n + 1) * (MFCC_N_FFT / (4 * MFCC_N_MELS)));
+    }
+    acc = (acc + (1 << 14)) >> 15; // Back to Q16 before the Q30 scale
+    coefficients[k] = (int32_t)((acc * dct_scale[k ? 1 : 0] + (1LL << 29)) >> 30);
+  }
+
+  uint32_t clip_frames = frames;
+  reset();
+  return clip_frames;
+}
@@ -0,0 +1,89 @@
+#ifndef _MFCC_H_
+#define _MFCC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Integer-only streaming equivalent of the training features:
+//   np.mean(librosa.feature.mfcc(y=y, sr=sr, n_mfcc=100).T, axis=0)
+// i.e. centered frames of 2048 samples every 512 with zero padding, periodic Hann window, power spectrum,
+// 128 Slaney mel filters, power_to_db (amin 1e-10, top_db 80), DCT-II ortho. The DCT is linear so the running
+// mean is taken over the log-mel frames and a single DCT runs at the end of the clip.
+//
+// The clip-wide top_db floor is only known at the end: the log-mel values of the first MFCC_MAX_FRAMES frames are
+// kept at 1/256 dB resolution to clip them then. Later frames are clipped against the running maximum, so their
+// values kept early that end up below the final floor are not clipped.
+//
+// Budget on the STM32L476 at 80 MHz, per 512-sample hop: about 5k complex butterflies and 4k 32x32->64 multiplies,
+// roughly 0.2 M cycles i.e. 8 % of the CPU at 16 kHz; RAM is sizeof(MFCC), about 29 KB for 1 s clips.
+#define MFCC_SAMPLE_RATE 16000
+#define MFCC_N_FFT 2048
+#define MFCC_HOP_LENGTH 512
+#define MFCC_N_MELS 128
+#define MFCC_N_COEFFICIENTS 100
+#define MFCC_TOP_DB 80
+#define MFCC_AMIN_DB -100 // 10 * log10(1e-10)
+
+#ifndef MFCC_MAX_FRAMES
+#define MFCC_MAX_FRAMES 32 // Frames of a 1 s clip at 16 kHz: 1 + 16000 / MFCC_HOP_LENGTH
+#endif
+
+#define MFCC_FRACTION_BITS 16 // Coefficients are returned in dB with this many fractional bits
+
+class MFCC {
+private:
+  static const unsigned int fft_size = MFCC_N_FFT / 2; // Real FFT computed as a complex FFT of half the size
+  static const unsigned int bins = MFCC_N_FFT / 2 + 1;
+
+  // Tables built by the constructor
+  int16_t cos_table[MFCC_N_FFT / 4 + 1]; // cos(2 pi m / MFCC_N_FFT) for the first quarter, Q15
+  uint16_t log2_table[256];              // log2(1 + i / 256), Q16
+  uint8_t bin_segment[bins];             // Bin k lies between mel points j and j + 1, 0xFF above the last one
+  uint16_t bin_rise[bins];               // Weight of bin k in mel filter j (rising edge), Q(weight_shift)
+  uint16_t bin_fall[bins];               // Weight of bin k in mel filter j - 1 (falling edge), Q(weight_shift)
+  int weight_shift;
+  int32_t dct_scale[2];                  // sqrt(1 / MFCC_N_MELS) for c[0], sqrt(2 / MFCC_N_MELS) for the others, Q30
+
+  // Stream state
+  int16_t history[MFCC_N_FFT]; // Last MFCC_N_FFT samples, sample s at s % MFCC_N_FFT
+  uint32_t samples;            // Samples pushed since reset()
+  uint32_t frames;             // Frames computed since reset()
+  int32_t max_db;              // Running maximum of the log-mel values, Q16 dB
+  int64_t mel_sum[MFCC_N_MELS];
+  uint32_t mel_clipped[MFCC_N_MELS]; // Values below the running top_db floor after MFCC_MAX_FRAMES, added back at the final floor
+  uint16_t frame_db[MFCC_MAX_FRAMES][MFCC_N_MELS]; // value - MFCC_AMIN_DB in 1/256 dB, saturated
+
+  // Frame scratch
+  int32_t re[fft_size];
+  int32_t im[fft_size];
+  uint64_t mel[MFCC_N_MELS];
+
+  int32_t cosq15(uint32_t m) const;
+  int32_t sinq15(uint32_t m) const;
+  int32_t log2q16(uint64_t v) const;
+  uint64_t binPower(unsigned int k) const;
+  void fft();
+  void processFrame();
+
+public:
+  MFCC();
+
+  void reset();
+
+  // Append samples, every frame they complete is processed before returning
+  void push(const int16_t *data, size_t count);
+
+  // Process the zero-padded frames at the end of the clip and write its coefficients in Q(MFCC_FRACTION_BITS) dB,
+  // the stream is then reset for the next clip. Returns the number of frames of the clip
+  uint32_t finish(int32_t coefficients[MFCC_N_COEFFICIENTS]);
+
+  // Frames computed since the last reset()
+  uint32_t frameCount() const { return frames; }
+
+  // Coefficient truncated to fraction_bits fractional bits, like the float to integer conversion of the evaluator
+  static int32_t toFixed(int32_t coefficient, int fraction_bits) {
+    return coefficient / (1 << (MFCC_FRACTION_BITS - fraction_bits));
+  }
+};
+
+#endif//_MFCC_H_
@@ -0,0 +1,84 @@
+#include "scheduler.h"
+
+DutyCycleScheduler::DutyCycleScheduler(uint32_t period_ms, uint32_t settle_ms) : period_ms(period_ms), settle_ms(settle_ms) {
+  start(0);
+}
+
+void DutyCycleScheduler::start(uint32_t now_ms) {
+  counters = EnergyCounters();
+  current = PowerState::Settle;
+  entered_ms = now_ms;
+  accounted_ms = now_ms;
+  cycle_start_ms = now_ms;
+}
+
+// Charge the time since the last update to the current state, differences are wrap-safe
+void DutyCycleScheduler::account(uint32_t now_ms) {
+  uint32_t elapsed = now_ms - accounted_ms;
+
+  switch (current) {
+    case PowerState::Sleep:  counters.sleep_ms += elapsed; break;
+    case PowerState::Settle: counters.settle_ms += elapsed; break;
+    case PowerState::Listen: counters.listen_ms += elapsed; break;
+    case PowerState::Infer:  counters.infer_ms += elapsed; break;
+  }
+
+  accounted_ms = now_ms;
+}
+
+void DutyCycleScheduler::enter(PowerState state, uint32_t now_ms) {
+  current = state;
+  entered_ms = now_ms;
+}
+
+PowerState DutyCycleScheduler::update(uint32_t now_ms, bool clip_complete, bool inferred) {
+  account(now_ms);
+
+  switch (current) {
+    case PowerState::Sleep:
+      if (now_ms - cycle_start_ms >= period_ms) {
+        // Periods missed while awake are skipped, the new one starts now
+        cycle_start_ms = now_ms - cycle_start_ms >= 2 * period_ms ? now_ms : cycle_start_ms + period_ms;
+        counters.wakeups++;
+        enter(PowerState::Settle, now_ms);
+      }
+      break;
+
+    case PowerState::Settle:
+      if (now_ms - entered_ms >= settle_ms) {
+        enter(PowerState::Listen, now_ms);
+      }
+      break;
+
+    case PowerState::Listen:
+      if (clip_complete) {
+        enter(PowerState::Infer, now_ms);
+      }
+      break;
+
+    case PowerState::Infer:
+      if (inferred) {
+        counters.inferences++;
+      }
+      if (now_ms - cycle_start_ms >= period_ms) {
+        // Already time for the next clip, the codec is still powered
+        cycle_start_ms = now_ms;
+        enter(PowerState::Listen, now_ms);
+      } else {
+        enter(PowerState::Sleep, now_ms);
+      }
+      break;
+  }
+
+  return current;
+}
+
+uint32_t DutyCycleScheduler::sleepTime(uint32_t now_ms) const {
+  uint32_t elapsed = now_ms - cycle_start_ms;
+  return current == PowerState::Sleep && elapsed < period_ms ? period_ms - elapsed : 0;
+}
+
+const EnergyCounters &DutyCycleScheduler::energy(uint32_t now_ms) {
+  account(now_ms);
+  return counters;
+}
@@ -0,0 +1,65 @@
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include <stdint.h>
+
+// Duty cycle of the detector: the MCU waits in STOP mode with the codec powered down, then every period it powers the
+// codec up, lets it settle, captures one clip at a low clock and runs the inference at a boosted clock. When the
+// period is shorter than a capture the next clip starts right after the inference and the codec stays powered.
+// Hardware independent: board.ino performs the actions of each state and the host simulation replays the same
+// transitions to check the duty-cycle math.
+enum class PowerState : uint8_t {
+  Sleep,  // STOP mode until the next period, codec powered down
+  Settle, // Codec powering up, captured samples are discarded
+  Listen, // Capturing a clip, the MCU sleeps between DMA interrupts
+  Infer   // Boosted clock while the clip is classified
+};
+
+// Time spent in each state and events since start()
+struct EnergyCounters {
+  uint32_t sleep_ms;
+  uint32_t settle_ms;
+  uint32_t listen_ms;
+  uint32_t infer_ms;
+  uint32_t inferences; // Clips the model ran on, not the ones skipped by the activity gate
+  uint32_t wakeups; // Exits from Sleep
+
+  uint32_t activeTime() const { return settle_ms + listen_ms + infer_ms; }
+};
+
+class DutyCycleScheduler {
+private:
+  uint32_t period_ms;
+  uint32_t settle_ms;
+
+  PowerState current;
+  uint32_t entered_ms;     // Time of the last transition
+  uint32_t accounted_ms;   // Time up to which the counters are updated
+  uint32_t cycle_start_ms; // Start of the current period
+  EnergyCounters counters;
+
+  void account(uint32_t now_ms);
+  void enter(PowerState state, uint32_t now_ms);
+
+public:
+  // period_ms 0 listens continuously
+  DutyCycleScheduler(uint32_t period_ms, uint32_t settle_ms);
+
+  // Reset the counters and start a period with the codec settling
+  void start(uint32_t now_ms);
+
+  // Perform at most one transition, clip_complete tells that the clip captured in Listen is complete.
+  // In Infer the clip is assumed handled by the next call, inferred tells whether the model ran on it or the activity
+  // gate skipped it
+  PowerState update(uint32_t now_ms, bool clip_complete, bool inferred);
+
+  PowerState state() const { return current; }
+
+  // Time left before the end of Sleep
+  uint32_t sleepTime(uint32_t now_ms) const;
+
+  // Counters up to now_ms
+  const EnergyCounters &energy(uint32_t now_ms);
+};
+
+#endif//_SCHEDULER_H_
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "calibrate.h"
+#include "model_int8.h"
+
+// int16 weights of the model being quantized
+#include "weights/conv1d_6.c"
+#include "weights/dense_4.c"
+
+namespace {
+
+// Magnitudes of the values of one number_t tensor over the calibration inputs
+class MagnitudeHistogram {
+private:
+	std::vector<uint64_t> counts = std::vector<uint64_t>(-(long)NUMBER_MIN + 1, 0);
+	uint64_t total = 0;
+
+public:
+	void add(const number_t *values, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			counts[std::abs((long)values[i])]++;
+		}
+		total += n;
+	}
+
+	// Smallest magnitude that percent of the values do not exceed, at least 1
+	long percentile(double percent) const {
+		uint64_t target = (uint64_t)std::ceil(total * percent / 100);
+		uint64_t seen = 0;
+		for (size_t m = 0; m < counts.size(); m++) {
+			seen += counts[m];
+			if (seen >= target) {
+				return std::max<long>(1, m);
+			}
+		}
+		return counts.size() - 1;
+	}
+
+	// Fraction of the values above limit, saturated by the quantization
+	double clipped(long limit) const {
+		uint64_t above = 0;
+		for (size_t m = limit + 1; m < counts.size(); m++) {
+			above += counts[m];
+		}
+		return total ? above / (double)total : 0;
+	}
+};
+
+struct Requantization {
+	int32_t multiplier;
+	int shift;
+};
+
+// multiplier * 2^(shift - 31) closest to scale, false when scale is out of the range of requantize()
+bool toRequantization(double scale, Requantization &r) {
+	if (!(scale > 0)) {
+		return false;
+	}
+	int exponent;
+	double mantissa = std::frexp(scale, &exponent); // In [0.5, 1)
+	long long multiplier = std::llround(mantissa * (1ll << 31));
+	if (multiplier == (1ll << 31)) {
+		multiplier /= 2;
+		exponent++;
+	}
+	r.multiplier = (int32_t)multiplier;
+	r.shift = exponent;
+	return exponent >= -31 && exponent <= 30;
+}
+
+int32_t roundToInt32(double x) {
+	return (int32_t)std::max<double>(INT32_MIN, std::min<double>(INT32_MAX, std::llround(x)));
+}
+
+// Tables of weights/conv1d_6_int8.c and weights/dense_4_int8.c
+struct Int8Model {
+	Requantization input;
+	conv1d_6_int8_t::kernel_type conv_kernel;
+	conv1d_6_int8_t::bias_type conv_bias;
+	conv1d_6_int8_t::multiplier_type conv_multiplier;
+	conv1d_6_int8_t::shift_type conv_shift;
+	dense_4_int8_t::kernel_type dense_kernel;
+	dense_4_int8_t::bias_type dense_bias;
+	dense_4_int8_t::multiplier_type dense_multiplier;
+	dense_4_int8_t::shift_type dense_shift;
+
+	// Same layer calls as cnn_int8_r() on these tables
+	void run(const number_t input_values[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) const {
+		max_pooling1d_6_t::output_type pooled;
+		quantize_int8_t::output_type quantized;
+		max_pooling1d_6_t::forward(input_values, pooled);
+		quantize_int8_t::forward(pooled, input.multiplier, input.shift, quantized);
+		conv1d_6_dense_4_int8_t::forward(quantized, conv_kernel, conv_bias, conv_multiplier, conv_shift,
+			dense_kernel, dense_bias, dense_multiplier, dense_shift, output);
+	}
+};
+
+// Quantize the rows of an int16 weight matrix with one symmetric scale per row, returns the scales
+std::vector<double> quantizeRows(const number_t *weights, unsigned int rows, unsigned int columns, int8_t *out) {
+	std::vector<double> scales(rows);
+	for (unsigned int r = 0; r < rows; r++) {
+		const number_t *row = weights + r * columns;
+		long peak = 1;
+		for (unsigned int i = 0; i < columns; i++) {
+			peak = std::max(peak, std::abs((long)row[i]));
+		}
+		scales[r] = peak / (double)INT8_MAX_VALUE;
+		for (unsigned int i = 0; i < columns; i++) {
+			out[r * columns + i] = (int8_t)std::lround(row[i] / scales[r]);
+		}
+	}
+	return scales;
+}
+
+template<typename T>
+void writeValues(std::ostream &out, const T *values, size_t n) {
+	out << "{";
+	for (size_t i = 0; i < n; i++) {
+		out << (i ? ", " : "") << (long)values[i];
+	}
+	out << "}";
+}
+
+const char *banner(const std::string &file, const char *brief) {
+	static std::string text;
+	text = "/**\n"
+		"  ******************************************************************************\n"
+		"  * @file    weights/" + file + "\n"
+		"  * @brief   " + brief + "\n"
+		"  *          Generated by main --calibrate, do not edit\n"
+		"  */\n\n";
+	return text.c_str();
+}
+
+bool writeConv(const std::string &path, const Int8Model &model, long input_clip, long conv_clip, double percentile) {
+	std::ofstream out(path);
+	out << banner("conv1d_6_int8.c", "int8 weights of conv1d_6 with one requantization per filter");
+	out << "#define MODEL_INT8_CALIBRATED 1\n\n";
+	out << "#define INPUT_CHANNELS    " << conv1d_6_int8_t::InputChannels << "\n";
+	out << "#define CONV_FILTERS      " << conv1d_6_int8_t::Filters << "\n";
+	out << "#define CONV_KERNEL_SIZE  " << sizeof(model.conv_kernel[0][0]) << "\n\n";
+	out << "// Inputs clipped at " << input_clip << ", outputs at " << conv_clip << " (number_t), percentile " << percentile << "\n";
+	out << "const int32_t conv1d_6_int8_input_multiplier = " << model.input.multiplier << ";\n";
+	out << "const int conv1d_6_int8_input_shift = " << model.input.shift << ";\n\n";
+
+	out << "const int32_t conv1d_6_int8_bias[CONV_FILTERS] = ";
+	writeValues(out, model.conv_bias, conv1d_6_int8_t::Filters);
+	out << "\n;\n\nconst int32_t conv1d_6_int8_multiplier[CONV_FILTERS] = ";
+	writeValues(out, model.conv_multiplier, conv1d_6_int8_t::Filters);
+	out << "\n;\n\nconst int8_t conv1d_6_int8_shift[CONV_FILTERS] = ";
+	writeValues(out, model.conv_shift, conv1d_6_int8_t::Filters);
+
+	out << "\n;\n\nconst int8_t conv1d_6_int8_kernel[CONV_FILTERS][INPUT_CHANNELS][CONV_KERNEL_SIZE] NUMBER_ALIGN = {";
+	for (unsigned int k = 0; k < conv1d_6_int8_t::Filters; k++) {
+		out << (k ? ", {" : "{");
+		for (unsigned int z = 0; z < conv1d_6_int8_t::InputChannels; z++) {
+			out << (z ? ", " : "");
+			writeValues(out, model.conv_kernel[k][z], sizeof(model.conv_kernel[k][z]));
+			out << "\n";
+		}
+		out << "}\n";
+	}
+	out << "}\n;\n\n#undef INPUT_CHANNELS\n#undef CONV_FILTERS\n#undef CONV_KERNEL_SIZE\n";
+	return out.good();
+}
+
+bool writeDense(const std::string &path, const Int8Model &model) {
+	std::ofstream out(path);
+	out << banner("dense_4_int8.c", "int8 weights of dense_4 with one requantization per unit to the number_t output");
+	out << "#define INPUT_SAMPLES " << dense_4_int8_t::InputSamples << "\n";
+	out << "#define FC_UNITS " << dense_4_int8_t::Units << "\n\n\n";
+
+	out << "const int32_t dense_4_int8_bias[FC_UNITS] = ";
+	writeValues(out, model.dense_bias, dense_4_int8_t::Units);
+	out << "\n;\n\nconst int32_t dense_4_int8_multiplier[FC_UNITS] = ";
+	writeValues(out, model.dense_multiplier, dense_4_int8_t::Units);
+	out << "\n;\n\nconst int8_t dense_4_int8_shift[FC_UNITS] = ";
+	writeValues(out, model.dense_shift, dense_4_int8_t::Units);
+
+	out << "\n;\n\nconst int8_t dense_4_int8_kernel[FC_UNITS][INPUT_SAMPLES] NUMBER_ALIGN = {";
+	for (unsigned int u = 0; u < dense_4_int8_t::Units; u++) {
+		out << (u ? ", " : "");
+		writeValues(out, model.dense_kernel[u], dense_4_int8_t::InputSamples);
+		out << "\n";
+	}
+	out << "}\n;\n\n#undef INPUT_SAMPLES\n#undef FC_UNITS\n";
+	return out.good();
+}
+
+} // namespace
+
+bool calibrateInt8(const number_t (*inputs)[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], size_t count, double percentile, const char *directory) {
+	if (count == 0) {
+		std::cerr << "Error: no calibration input" << std::endl;
+		return false;
+	}
+
+	// Activation statistics of the int16 model, flatten_2 is the conv output read in place
+	MagnitudeHistogram pooled_magnitudes, conv_magnitudes;
+	std::vector<number_t> reference(count * MODEL_OUTPUT_SAMPLES);
+	for (size_t i = 0; i < count; i++) {
+		max_pooling1d_6_t::output_type pooled;
+		conv1d_6_t::output_type conv;
+		max_pooling1d_6_t::forward(inputs[i], pooled);
+		conv1d_6_t::forward(pooled, conv1d_6_kernel, conv1d_6_bias, conv);
+		dense_4_t::forward((const number_t *)conv, dense_4_kernel, dense_4_bias, &reference[i * MODEL_OUTPUT_SAMPLES]);
+		pooled_magnitudes.add(&pooled[0][0], sizeof(pooled) / sizeof(number_t));
+		conv_magnitudes.add(&conv[0][0], sizeof(conv) / sizeof(number_t));
+	}
+
+	// Scales in number_t steps per int8 step: value = q * scale
+	long input_clip = pooled_magnitudes.percentile(percentile);
+	long conv_clip = conv_magnitudes.percentile(percentile);
+	double input_scale = input_clip / (double)INT8_MAX_VALUE;
+	double conv_scale = conv_clip / (double)INT8_MAX_VALUE;
+
+	std::unique_ptr<Int8Model> model(new Int8Model);
+	std::vector<double> conv_weight_scales = quantizeRows(&conv1d_6_kernel[0][0][0], conv1d_6_t::Filters,
+		sizeof(conv1d_6_kernel[0]) / sizeof(number_t), &model->conv_kernel[0][0][0]);
+	std::vector<double> dense_weight_scales = quantizeRows(&dense_4_kernel[0][0], dense_4_t::Units, dense_4_t::InputSamples,
+		&model->dense_kernel[0][0]);
+
+	// Products of number_t are scaled down by 2^FIXED_POINT, int8 accumulators are not: the bias and the
+	// requantization absorb it
+	bool ok = toRequantization(1 / input_scale, model->input);
+	for (unsigned int k = 0; k < conv1d_6_t::Filters; k++) {
+		double accumulator_scale = input_scale * conv_weight_scales[k] / (1 << FIXED_POINT);
+		Requantization r = {0, 0};
+		ok = toRequantization(accumulator_scale / conv_scale, r) && ok;
+		model->conv_bias[k] = roundToInt32(conv1d_6_bias[k] / accumulator_scale);
+		model->conv_multiplier[k] = r.multiplier;
+		model->conv_shift[k] = r.shift;
+	}
+	for (unsigned int u = 0; u < dense_4_t::Units; u++) {
+		double accumulator_scale = conv_scale * dense_weight_scales[u] / (1 << FIXED_POINT);
+		Requantization r = {0, 0};
+		ok = toRequantization(accumulator_scale, r) && ok;
+		model->dense_bias[u] = roundToInt32(dense_4_bias[u] / accumulator_scale);
+		model->dense_multiplier[u] = r.multiplier;
+		model->dense_shift[u] = r.shift;
+	}
+	if (!ok) {
+		std::cerr << "Error: a requantization scale is out of range" << std::endl;
+		return false;
+	}
+
+	// Agreement of the int8 model with cnn() on the calibration inputs, the decision is the sign of the output
+	double max_error = 0, total_error = 0;
+	size_t agree = 0;
+	for (size_t i = 0; i < count; i++) {
+		number_t output[MODEL_OUTPUT_SAMPLES];
+		model->run(inputs[i], output);
+		for (unsigned int o = 0; o < MODEL_OUTPUT_SAMPLES; o++) {
+			number_t expected = reference[i * MODEL_OUTPUT_SAMPLES + o];
+			double error = std::abs(output[o] - expected) / (double)(1 << FIXED_POINT);
+			max_error = std::max(max_error, error);
+			total_error += error;
+			agree += (output[o] >= 0) == (expected >= 0);
+		}
+	}
+
+	std::string conv_path = std::string(directory) + "/conv1d_6_int8.c";
+	std::string dense_path = std::string(directory) + "/dense_4_int8.c";
+	if (!writeConv(conv_path, *model, input_clip, conv_clip, percentile)) {
+		std::cerr << "Error writing \"" << conv_path << "\": " << strerror(errno) << std::endl;
+		return false;
+	}
+	if (!writeDense(dense_path, *model)) {
+		std::cerr << "Error writing \"" << dense_path << "\": " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	size_t outputs = count * MODEL_OUTPUT_SAMPLES;
+	size_t int16_bytes = sizeof(conv1d_6_kernel) + sizeof(conv1d_6_bias) + sizeof(dense_4_kernel) + sizeof(dense_4_bias);
+	size_t int8_bytes = sizeof(model->conv_kernel) + sizeof(model->conv_bias) + sizeof(model->conv_multiplier) + sizeof(model->conv_shift)
+		+ sizeof(model->dense_kernel) + sizeof(model->dense_bias) + sizeof(model->dense_multiplier) + sizeof(model->dense_shift);
+	std::cout << "Calibrated on " << count << " inputs at percentile " << percentile << std::endl;
+	std::cout << "max_pooling1d_6 output clipped at " << input_clip / (double)(1 << FIXED_POINT) << " ("
+		<< pooled_magnitudes.clipped(input_clip) * 100 << "% saturated)" << std::endl;
+	std::cout << "conv1d_6 output clipped at " << conv_clip / (double)(1 << FIXED_POINT) << " ("
+		<< conv_magnitudes.clipped(conv_clip) * 100 << "% saturated)" << std::endl;
+	std::cout << "Weights: " << int16_bytes << " bytes int16, " << int8_bytes << " bytes int8" << std::endl;
+	std::cout << "Output error against cnn(): max " << max_error << ", mean " << total_error / outputs << ", "
+		<< agree << "/" << outputs << " decisions identical" << std::endl;
+	std::cout << "Wrote " << conv_path << " and " << dense_path << ", rebuild to use them in cnn_int8()" << std::endl;
+	return true;
+}
@@ -0,0 +1,14 @@
+#ifndef _CALIBRATE_H_
+#define _CALIBRATE_H_
+
+#include <cstddef>
+
+#include "model.h"
+
+// Derive the int8 weights and requantization of model_int8.h from the int16 model: per-channel weight scales from
+// the weights, activation scales from the magnitudes of the activations of the calibration inputs clipped at the
+// given percentile. Writes conv1d_6_int8.c and dense_4_int8.c into directory and reports how closely the int8 model
+// follows cnn() on the same inputs. Returns false on error
+bool calibrateInt8(const number_t (*inputs)[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], size_t count, double percentile, const char *directory);
+
+#endif//_CALIBRATE_H_
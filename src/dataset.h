@@ -0,0 +1,128 @@
+#ifndef _DATASET_H_
+#define _DATASET_H_
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "mapped_file.h"
+#include "model.h"
+
+// Binary dataset file: a 64-byte header followed by a [count][channels][samples] matrix in host byte order,
+// samples are stored in the model input layout so that number_t rows can be passed to cnn() in place
+#define DATASET_MAGIC "GSCD"
+#define DATASET_VERSION 1
+#define DATASET_ALIGNMENT 64
+
+enum DatasetType : uint32_t {
+	DATASET_FLOAT32 = 0,  // Raw float values
+	DATASET_NUMBER_T = 1, // Values already quantized to number_t with fixed_point fractional bits
+};
+
+struct DatasetHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t dtype;
+	int32_t fixed_point;
+	uint64_t count;
+	uint32_t channels;
+	uint32_t samples;
+	uint64_t data_offset; // From the beginning of the file, multiple of DATASET_ALIGNMENT
+	uint8_t reserved[24];
+};
+static_assert(sizeof(DatasetHeader) == DATASET_ALIGNMENT, "DatasetHeader must fill exactly one alignment unit");
+
+static inline size_t datasetTypeSize(uint32_t dtype) {
+	return dtype == DATASET_NUMBER_T ? sizeof(number_t) : sizeof(float);
+}
+
+class Dataset {
+private:
+	MappedFile file;
+	const DatasetHeader *header = nullptr;
+
+public:
+	// Check the magic number only, to tell binary datasets from CSV files
+	static bool probe(const char *filename) {
+		char magic[sizeof(DatasetHeader::magic)] = {};
+		std::ifstream fin(filename, std::ios::binary);
+		return fin.read(magic, sizeof(magic)) && !memcmp(magic, DATASET_MAGIC, sizeof(magic));
+	}
+
+	// Returns an error message or NULL on success
+	const char *open(const char *filename) {
+		header = nullptr;
+		if (!file.open(filename)) {
+			return strerror(errno);
+		}
+		if (file.size() < sizeof(DatasetHeader)) {
+			return "truncated header";
+		}
+		const DatasetHeader *h = reinterpret_cast<const DatasetHeader *>(file.data());
+		if (memcmp(h->magic, DATASET_MAGIC, sizeof(h->magic))) {
+			return "not a dataset file";
+		}
+		if (h->version != DATASET_VERSION) {
+			return "unsupported dataset version";
+		}
+		if (h->dtype != DATASET_FLOAT32 && h->dtype != DATASET_NUMBER_T) {
+			return "unsupported data type";
+		}
+		if (h->data_offset < sizeof(DatasetHeader) || h->data_offset % DATASET_ALIGNMENT) {
+			return "misaligned data section";
+		}
+		if (rowSize(h) == 0) {
+			return "empty row shape";
+		}
+		if (file.size() < h->data_offset || (file.size() - h->data_offset) / rowSize(h) < h->count) {
+			return "truncated data section";
+		}
+		header = h;
+		return NULL;
+	}
+
+	const DatasetHeader &info() const { return *header; }
+	size_t size() const { return header->count; }
+
+	template<typename T>
+	const T *row(size_t i) const {
+		return reinterpret_cast<const T *>(file.data() + header->data_offset + i * rowSize(header));
+	}
+
+	static size_t rowSize(const DatasetHeader *h) {
+		return (size_t)h->channels * h->samples * datasetTypeSize(h->dtype);
+	}
+};
+
+// Write rows of channels*samples values already in model input layout, returns an error message or NULL on success
+template<typename T>
+const char *writeDataset(const char *filename, DatasetType dtype, int fixed_point, size_t count, size_t channels, size_t samples, const T *data) {
+	static_assert(sizeof(T) == sizeof(float) || sizeof(T) == sizeof(number_t), "unsupported element type");
+	if (sizeof(T) != datasetTypeSize(dtype)) {
+		return "element size does not match data type";
+	}
+
+	DatasetHeader header = {};
+	memcpy(header.magic, DATASET_MAGIC, sizeof(header.magic));
+	header.version = DATASET_VERSION;
+	header.dtype = dtype;
+	header.fixed_point = fixed_point;
+	header.count = count;
+	header.channels = channels;
+	header.samples = samples;
+	header.data_offset = sizeof(DatasetHeader);
+
+	std::ofstream fout(filename, std::ios::binary | std::ios::trunc);
+	if (!fout) {
+		return strerror(errno);
+	}
+	fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char *>(data), count * channels * samples * sizeof(T));
+	if (!fout.flush()) {
+		return "write failed";
+	}
+	return NULL;
+}
+
+#endif//_DATASET_H_
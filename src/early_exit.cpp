@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include "early_exit.h"
+
+// Weights bounded, the same as those of cnn()
+#include "weights/conv1d_6.c"
+#include "weights/dense_4.c"
+
+namespace {
+
+template<typename T>
+void writeValues(std::ostream &out, const T *values, size_t n) {
+	out << "{";
+	for (size_t i = 0; i < n; i++) {
+		out << (i ? ", " : "") << (long)values[i];
+	}
+	out << "}";
+}
+
+} // namespace
+
+bool EarlyExitBounds::decide(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t threshold, unsigned int *rows) const {
+	max_pooling1d_6_t::output_type pooled;
+	max_pooling1d_6_t::forward(input, pooled);
+	return conv1d_6_dense_4_early_exit_t::forward(pooled, conv1d_6_kernel, conv1d_6_bias, dense_4_kernel, dense_4_bias,
+		order, conv_negative, conv_positive, dense_negative, dense_positive, threshold, rows);
+}
+
+EarlyExitBounds earlyExitBounds(bool ordered) {
+	const unsigned int filters = conv1d_6_t::Filters, samples = conv1d_6_t::OutputSamples;
+	EarlyExitBounds bounds = {};
+
+	for (unsigned int k = 0; k < filters; k++) {
+		for (unsigned int z = 0; z < conv1d_6_t::InputChannels; z++) {
+			for (unsigned int x = 0; x < conv1d_6_t::Size; x++) {
+				(conv1d_6_kernel[k][z][x] < 0 ? bounds.conv_negative : bounds.conv_positive)[k] += conv1d_6_kernel[k][z][x];
+			}
+		}
+		for (unsigned int x = 0; x < samples; x++) {
+			number_t weight = dense_4_kernel[0][k * samples + x];
+			(weight < 0 ? bounds.dense_negative : bounds.dense_positive)[k] += weight;
+		}
+	}
+
+	// Widest range of contributions for inputs of the same magnitude first, so that the bound of the rows left shrinks
+	// as fast as possible. Equal widths keep the filter order
+	std::iota(bounds.order, bounds.order + filters, 0);
+	if (ordered) {
+		auto width = [&](unsigned int k) {
+			return (int64_t)(bounds.conv_positive[k] - bounds.conv_negative[k]) * (bounds.dense_positive[k] - bounds.dense_negative[k]);
+		};
+		std::stable_sort(bounds.order, bounds.order + filters, [&](unsigned int a, unsigned int b) {
+			return width(a) > width(b);
+		});
+	}
+	return bounds;
+}
+
+bool writeEarlyExitBounds(const EarlyExitBounds &bounds, const char *directory) {
+	const unsigned int filters = conv1d_6_t::Filters;
+	std::string path = std::string(directory) + "/conv1d_6_dense_4_bounds.c";
+	std::ofstream out(path);
+	out << "/**\n"
+		"  ******************************************************************************\n"
+		"  * @file    weights/conv1d_6_dense_4_bounds.c\n"
+		"  * @brief   Filter order and per-filter sums of the negative and positive weights of conv1d_6 and dense_4 for\n"
+		"  *          cnn_decide(). Generated by main --early-exit, do not edit\n"
+		"  */\n\n";
+	out << "#define CONV_FILTERS " << filters << "\n\n";
+	out << "// Filters by decreasing range of their contribution to dense_4\n";
+	out << "const uint8_t conv1d_6_dense_4_order[CONV_FILTERS] = ";
+	writeValues(out, bounds.order, filters);
+	out << "\n;\n\nconst int32_t conv1d_6_negative[CONV_FILTERS] = ";
+	writeValues(out, bounds.conv_negative, filters);
+	out << "\n;\n\nconst int32_t conv1d_6_positive[CONV_FILTERS] = ";
+	writeValues(out, bounds.conv_positive, filters);
+	out << "\n;\n\n// Over the dense_4 inputs of each filter\nconst int32_t dense_4_negative[CONV_FILTERS] = ";
+	writeValues(out, bounds.dense_negative, filters);
+	out << "\n;\n\nconst int32_t dense_4_positive[CONV_FILTERS] = ";
+	writeValues(out, bounds.dense_positive, filters);
+	out << "\n;\n\n#undef CONV_FILTERS\n";
+	if (!out.good()) {
+		std::cerr << "Error writing \"" << path << "\": " << strerror(errno) << std::endl;
+		return false;
+	}
+	return true;
+}
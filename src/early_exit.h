@@ -0,0 +1,23 @@
+#ifndef _EARLY_EXIT_H_
+#define _EARLY_EXIT_H_
+
+#include "model.h"
+
+// Filter order and per-filter weight sums of conv1d_6 and dense_4, as read by ConvDenseEarlyExit (layers.h)
+struct EarlyExitBounds {
+	conv1d_6_dense_4_early_exit_t::order_type order;
+	conv1d_6_dense_4_early_exit_t::bound_type conv_negative, conv_positive;
+	conv1d_6_dense_4_early_exit_t::bound_type dense_negative, dense_positive;
+
+	// Same layer calls as cnn_decide() on these tables, rows is set to the conv1d_6 rows computed
+	bool decide(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t threshold, unsigned int *rows) const;
+};
+
+// Bounds of the weights of conv1d_6 and dense_4, with the filters that can move the output the most first when ordered,
+// in filter order otherwise
+EarlyExitBounds earlyExitBounds(bool ordered);
+
+// Write conv1d_6_dense_4_bounds.c into directory, returns false on error
+bool writeEarlyExitBounds(const EarlyExitBounds &bounds, const char *directory);
+
+#endif//_EARLY_EXIT_H_
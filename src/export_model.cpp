@@ -0,0 +1,48 @@
+#include <cstring>
+#include <vector>
+
+#include "export_model.h"
+#include "model_file.h"
+
+// Weights of every generated variant, each file undefines its macros at the end
+#include "weights/conv1d.c"
+#include "weights/dense.c"
+#include "weights/conv1d_5.c"
+#include "weights/dense_2.c"
+#include "weights/conv1d_6.c"
+#include "weights/dense_4.c"
+
+namespace {
+
+// max_pooling1d -> conv1d -> flatten -> dense with the weights of one variant
+template<typename PoolLayer, typename ConvLayer, typename DenseLayer>
+std::vector<ModelBlobSection> variantLayers(const typename ConvLayer::kernel_type &conv_kernel, const typename ConvLayer::bias_type &conv_bias,
+                                            const typename DenseLayer::kernel_type &dense_kernel, const typename DenseLayer::bias_type &dense_bias) {
+	return {
+		{model_blob_pool_layer<PoolLayer>(), NULL, NULL},
+		{model_blob_conv_layer<ConvLayer>(), conv_kernel, conv_bias},
+		{model_blob_flatten_layer<ConvLayer>(), NULL, NULL},
+		{model_blob_dense_layer<DenseLayer>(), dense_kernel, dense_bias},
+	};
+}
+
+} // namespace
+
+const char *exportModel(const char *variant, const char *filename) {
+	typedef Conv1D<1, max_pooling1d_6_t::OutputSamples, 64, 8, 1, Activation::ReLU> conv1d_t;
+	typedef Dense<conv1d_t::Filters * conv1d_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_t;
+	typedef Conv1D<1, max_pooling1d_6_t::OutputSamples, 32, 8, 1, Activation::ReLU> conv1d_5_t;
+	typedef Dense<conv1d_5_t::Filters * conv1d_5_t::OutputSamples, MODEL_OUTPUT_SAMPLES, Activation::Linear> dense_2_t;
+
+	std::vector<ModelBlobSection> layers;
+	if (!strcmp(variant, "conv1d_6")) {
+		layers = variantLayers<max_pooling1d_6_t, conv1d_6_t, dense_4_t>(conv1d_6_kernel, conv1d_6_bias, dense_4_kernel, dense_4_bias);
+	} else if (!strcmp(variant, "conv1d")) {
+		layers = variantLayers<max_pooling1d_6_t, conv1d_t, dense_t>(conv1d_kernel, conv1d_bias, dense_kernel, dense_bias);
+	} else if (!strcmp(variant, "conv1d_5")) {
+		layers = variantLayers<max_pooling1d_6_t, conv1d_5_t, dense_2_t>(conv1d_5_kernel, conv1d_5_bias, dense_2_kernel, dense_2_bias);
+	} else {
+		return "unknown variant";
+	}
+	return writeModelBlob(filename, variant, layers, MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES, MODEL_OUTPUT_SAMPLES);
+}
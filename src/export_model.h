@@ -0,0 +1,8 @@
+#ifndef _EXPORT_MODEL_H_
+#define _EXPORT_MODEL_H_
+
+// Write the compiled-in weights of a generated variant (conv1d_6, conv1d or conv1d_5, named after their conv layer)
+// as a model blob for cnn_blob_r(). Returns an error message or NULL on success
+const char *exportModel(const char *variant, const char *filename);
+
+#endif//_EXPORT_MODEL_H_
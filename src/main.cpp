@@ -1,31 +1,155 @@
 #include <algorithm>
 #include <array>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cmath>
 #include <cstring>
-#include <fstream>
+#include <functional>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "calibrate.h"
+#include "board/activity.h"
+#include "board/mfcc.h"
+#include "board/scheduler.h"
+#include "dataset.h"
+#include "early_exit.h"
+#include "export_model.h"
+#include "mapped_file.h"
 #include "model.h"
+#include "model_file.h"
+#include "model_int8.h"
+#include "model_registry.h"
+#include "pcm_stream.h"
+#include "prune.h"
+#include "server.h"
 
+// Run fn(t) for every t in [0, threads), the calling thread takes t = 0
+template<typename F>
+void runThreads(unsigned int threads, F fn) {
+	std::vector<std::thread> pool;
+	for (unsigned int t = 1; t < threads; t++) {
+		pool.emplace_back(fn, t);
+	}
+	fn(0);
+	for (auto &thread : pool) {
+		thread.join();
+	}
+}
+
+// Call fn(begin, end) for every line in [begin, end), line terminator excluded
+template<typename F>
+void forEachLine(const char *begin, const char *end, F fn) {
+	while (begin < end) {
+		const char *eol = static_cast<const char *>(memchr(begin, '\n', end - begin));
+		if (!eol) {
+			eol = end;
+		}
+		const char *line_end = eol;
+		if (line_end > begin && line_end[-1] == '\r') {
+			line_end--;
+		}
+		fn(begin, line_end);
+		begin = eol + 1;
+	}
+}
+
+// Parse one CSV row of exactly N floats, returns an error message or NULL on success
 template<int N>
-std::vector<std::array<float, N>> readInputsFromFile(const char *filename) {
-	// Read training vectors from CSV file
-	std::vector<std::array<float, N>> inputs;
-	std::ifstream fin(filename);
-	if (!fin) {
+const char *parseCSVRow(const char *p, const char *end, std::array<float, N> &floats) {
+	int i = 0;
+	for (;;) {
+		while (p < end && (*p == ' ' || *p == '\t')) p++;
+		if (i >= N) {
+			return "too many columns";
+		}
+		if (p < end && *p == '+') p++; // Not accepted by from_chars
+		auto res = std::from_chars(p, end, floats[i]);
+		if (res.ec == std::errc::result_out_of_range) {
+			return "value out of range";
+		} else if (res.ec != std::errc()) {
+			return "invalid number";
+		}
+		p = res.ptr;
+		i++;
+		while (p < end && (*p == ' ' || *p == '\t')) p++;
+		if (p == end) {
+			break;
+		}
+		if (*p != ',') {
+			return "unexpected character";
+		}
+		p++;
+	}
+	if (i < N) {
+		return "too few columns";
+	}
+	return NULL;
+}
+
+template<int N>
+std::vector<std::array<float, N>> readInputsFromFile(const char *filename, unsigned int threads = 1) {
+	// Read training vectors from CSV file, mapped in memory and parsed in place by chunks of lines
+	MappedFile file;
+	if (!file.open(filename)) {
 		std::cerr << "Error opening \"" << filename << "\": " << strerror(errno) << std::endl;
 		exit(0);
 	}
-	std::string linestr;
-	while (std::getline(fin, linestr)) {
-		std::istringstream linestrs(linestr);
-		std::string floatstr;
-		std::array<float, N> floats;
-		for (int i = 0; std::getline(linestrs, floatstr, ','); i++) {
-			floats.at(i) = std::strtof(floatstr.c_str(), NULL);
+	threads = std::max(1u, std::min(threads, (unsigned int)(file.size() / 65536 + 1))); // At least 64 KiB per chunk
+
+	// Split at line boundaries, one chunk per thread
+	std::vector<const char *> bounds(threads + 1, file.end());
+	bounds.at(0) = file.begin();
+	for (unsigned int t = 1; t < threads; t++) {
+		const char *p = std::max(bounds.at(t - 1), file.begin() + file.size() * t / threads);
+		const char *eol = static_cast<const char *>(memchr(p, '\n', file.end() - p));
+		bounds.at(t) = eol ? eol + 1 : file.end();
+	}
+
+	// Count lines and non-empty rows before each chunk so that the output is allocated once
+	std::vector<size_t> lines(threads + 1, 0);
+	std::vector<size_t> rows(threads + 1, 0);
+	runThreads(threads, [&](unsigned int t) {
+		forEachLine(bounds.at(t), bounds.at(t + 1), [&](const char *begin, const char *end) {
+			lines.at(t + 1)++;
+			if (begin != end) {
+				rows.at(t + 1)++;
+			}
+		});
+	});
+	for (unsigned int t = 0; t < threads; t++) {
+		lines.at(t + 1) += lines.at(t);
+		rows.at(t + 1) += rows.at(t);
+	}
+
+	std::vector<std::array<float, N>> inputs(rows.at(threads));
+	std::vector<std::pair<size_t, const char *>> errors(threads, {0, NULL}); // First bad line of each chunk
+
+	runThreads(threads, [&](unsigned int t) {
+		size_t line = lines.at(t);
+		size_t row = rows.at(t);
+		forEachLine(bounds.at(t), bounds.at(t + 1), [&](const char *begin, const char *end) {
+			line++;
+			if (begin == end || errors.at(t).second) { // Skip empty lines, stop at the first error
+				return;
+			}
+			const char *error = parseCSVRow<N>(begin, end, inputs[row++]);
+			if (error) {
+				errors.at(t) = {line, error};
+			}
+		});
+	});
+
+	for (const auto &error : errors) {
+		if (error.second) {
+			std::cerr << filename << ":" << error.first << ": " << error.second << " (expected " << N << " values per row)" << std::endl;
+			exit(1);
 		}
-		inputs.push_back(floats);
 	}
 	return inputs;
 }
@@ -39,37 +163,948 @@ void convert_input_vector(const std::array<float, Channels*Samples> &input, numb
 	}
 }
 
-//Compute testing accuracy
-template<size_t InputDims, size_t OutputDims>
-float evaluate(const std::vector<std::array<float, InputDims>> &inputs, const std::vector<std::array<float, OutputDims>> &labels) {
-	int rightlabels = 0;
-	std::array<number_t, OutputDims> outputs = {};
+template<size_t Channels, size_t Samples>
+void convert_input_row(const float *input, number_t out[Channels][Samples]) {
+	// Same quantization as convert_input_vector() for a row already in model input layout
+	for (size_t i = 0; i < Channels; i++) {
+		for (size_t j = 0; j < Samples; j++) {
+			out[i][j] = clamp_to_number_t((long_number_t)(input[i*Samples + j] * (1<<FIXED_POINT)));
+		}
+	}
+}
+
+typedef number_t input_t[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES];
+
+// Whether the decision of an output row matches its labels: a single label is 1 for the positive class, several are
+// one per class
+bool predicts(const number_t output[MODEL_OUTPUT_SAMPLES], const float label[MODEL_OUTPUT_SAMPLES]) {
+	unsigned int decision = model_decision(output);
+	if (MODEL_OUTPUT_SAMPLES == 1) {
+		return decision == (label[0] > 0.5f);
+	}
+	return label[decision] > 0;
+}
+
+//Compute testing accuracy, samples are split in contiguous ranges across threads and run in batches
+//input(i, n, buffer) returns n contiguous quantized samples from i, either converted into buffer or in place from a mapped dataset
+//label(i) returns the i-th row of MODEL_OUTPUT_SAMPLES labels
+//model(n, inputs, outputs, activations) runs n samples like cnn_batch(), activations is the scratch of the calling thread
+template<typename InputFn, typename LabelFn, typename ModelFn>
+float evaluate(size_t count, InputFn input, LabelFn label, unsigned int threads, ModelFn model) {
+	threads = std::max(1u, std::min(threads, (unsigned int)count));
+	std::vector<int> rightlabels(threads, 0);
+
+	auto worker = [&](unsigned int t) {
+		// Per-thread scratch so that cnn_batch() calls do not share state
+		std::unique_ptr<cnn_batch_activations_t> activations(new cnn_batch_activations_t);
+		input_t converted_inputs[MODEL_BATCH_SIZE];
+		number_t outputs[MODEL_BATCH_SIZE][MODEL_OUTPUT_SAMPLES];
+		int right = 0;
+
+		size_t end = count * (t + 1) / threads;
+		for (size_t i = count * t / threads; i < end; i += MODEL_BATCH_SIZE) {
+			unsigned int batch = std::min((size_t)MODEL_BATCH_SIZE, end - i);
+
+			model(batch, input(i, batch, converted_inputs), outputs, activations.get());
+
+			for (unsigned int b = 0; b < batch; b++) {
+				if (predicts(outputs[b], label(i + b))) {
+					right++;
+				}
+			}
+		}
+		rightlabels.at(t) = right;
+	};
+
+	runThreads(threads, worker);
+
+	int total = 0;
+	for (auto right : rightlabels) {
+		total += right;
+	}
+	return total/(float)count;
+}
+
+// Map a binary dataset and check its shape, exits on error
+void openDataset(Dataset &dataset, const char *filename, size_t channels, size_t samples) {
+	const char *error = dataset.open(filename);
+	if (!error && (dataset.info().channels != channels || dataset.info().samples != samples)) {
+		error = "shape does not match the model";
+	}
+	if (!error && dataset.info().dtype == DATASET_NUMBER_T && dataset.info().fixed_point != FIXED_POINT) {
+		error = "quantized with a different fixed-point format than the model";
+	}
+	if (error) {
+		std::cerr << "Error opening \"" << filename << "\": " << error << std::endl;
+		exit(1);
+	}
+}
+
+// Quantized inputs of a CSV or binary dataset in memory, exits on error
+std::vector<std::array<number_t, MODEL_INPUT_CHANNELS*MODEL_INPUT_SAMPLES>> readQuantizedInputs(const char *path) {
+	std::vector<std::array<number_t, MODEL_INPUT_CHANNELS*MODEL_INPUT_SAMPLES>> inputs;
+	if (Dataset::probe(path)) {
+		Dataset xset;
+		openDataset(xset, path, MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES);
+		inputs.resize(xset.size());
+		for (size_t i = 0; i < inputs.size(); i++) {
+			input_t &converted = *reinterpret_cast<input_t *>(inputs[i].data());
+			if (xset.info().dtype == DATASET_NUMBER_T) {
+				memcpy(converted, xset.row<input_t>(i), sizeof(input_t));
+			} else {
+				convert_input_row<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES>(xset.row<float>(i), converted);
+			}
+		}
+	} else {
+		auto rows = readInputsFromFile<MODEL_INPUT_SAMPLES*MODEL_INPUT_CHANNELS>(path);
+		inputs.resize(rows.size());
+		for (size_t i = 0; i < inputs.size(); i++) {
+			convert_input_vector<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES>(rows[i], *reinterpret_cast<input_t *>(inputs[i].data()));
+		}
+	}
+	return inputs;
+}
+
+// Test inputs and labels, binary datasets are mapped and read in place, CSV files are parsed into memory
+struct TestSet {
+	Dataset xset, yset;
+	std::vector<std::array<float, MODEL_INPUT_SAMPLES*MODEL_INPUT_CHANNELS>> xcsv;
+	std::vector<std::array<float, MODEL_OUTPUT_SAMPLES>> ycsv;
+	std::function<const input_t *(size_t, unsigned int, input_t *)> input; // As expected by evaluate()
+	std::function<const float *(size_t)> label;
+	size_t count; // Samples with both an input and a label
+};
+
+// Open the inputs and labels of a test set, exits on error
+void openTestSet(TestSet &test, const char *xpath, const char *ypath, unsigned int threads) {
+	size_t inputs_count, labels_count;
+
+	if (Dataset::probe(xpath)) {
+		openDataset(test.xset, xpath, MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES);
+		inputs_count = test.xset.size();
+		if (test.xset.info().dtype == DATASET_NUMBER_T) { // Already quantized, no copy
+			test.input = [&test](size_t i, unsigned int, input_t *) { return test.xset.row<input_t>(i); };
+		} else {
+			test.input = [&test](size_t i, unsigned int n, input_t *buffer) {
+				for (unsigned int b = 0; b < n; b++) {
+					convert_input_row<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES>(test.xset.row<float>(i + b), buffer[b]);
+				}
+				return buffer;
+			};
+		}
+	} else {
+		test.xcsv = readInputsFromFile<MODEL_INPUT_SAMPLES*MODEL_INPUT_CHANNELS>(xpath, threads);
+		inputs_count = test.xcsv.size();
+		test.input = [&test](size_t i, unsigned int n, input_t *buffer) {
+			for (unsigned int b = 0; b < n; b++) {
+				convert_input_vector<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES>(test.xcsv[i + b], buffer[b]);
+			}
+			return buffer;
+		};
+	}
+
+	if (Dataset::probe(ypath)) {
+		openDataset(test.yset, ypath, 1, MODEL_OUTPUT_SAMPLES);
+		if (test.yset.info().dtype != DATASET_FLOAT32) {
+			std::cerr << "Error opening \"" << ypath << "\": labels must be stored as float32" << std::endl;
+			exit(1);
+		}
+		labels_count = test.yset.size();
+		test.label = [&test](size_t i) { return test.yset.row<float>(i); };
+	} else {
+		test.ycsv = readInputsFromFile<MODEL_OUTPUT_SAMPLES>(ypath, threads);
+		labels_count = test.ycsv.size();
+		test.label = [&test](size_t i) { return test.ycsv[i].data(); };
+	}
+
+	if (inputs_count != labels_count) {
+		std::cerr << "Warning: " << inputs_count << " inputs but " << labels_count << " labels" << std::endl;
+	}
+	test.count = std::min(inputs_count, labels_count);
+}
+
+#if MODEL_INT8_CALIBRATED
+// cnn_int8_r() one sample at a time in place of cnn_batch() for evaluate()
+void runInt8(unsigned int batch, const input_t inputs[], number_t outputs[][MODEL_OUTPUT_SAMPLES], cnn_batch_activations_t *) {
+	cnn_int8_activations_t activations;
+	for (unsigned int b = 0; b < batch; b++) {
+		cnn_int8_r(inputs[b], outputs[b], &activations);
+	}
+}
+#endif
+
+// Prune dense_4 to the given sparsity, write weights/dense_4_sparse.c and report what the sparse weights save and cost
+// against cnn() on the test set
+int pruneModel(const char *xpath, const char *ypath, const char *directory, double sparsity, unsigned int threads) {
+	TestSet test;
+	openTestSet(test, xpath, ypath, threads);
+
+	SparseDenseWeights weights = pruneDense(sparsity);
+	if (!writeSparseDense(weights, sparsity, directory)) {
+		return 1;
+	}
+
+	float dense_acc = evaluate(test.count, test.input, test.label, threads, cnn_batch);
+	float sparse_acc = evaluate(test.count, test.input, test.label, threads,
+		[&](unsigned int batch, const input_t inputs[], number_t outputs[][MODEL_OUTPUT_SAMPLES], cnn_batch_activations_t *) {
+			for (unsigned int b = 0; b < batch; b++) {
+				weights.run(inputs[b], outputs[b]);
+			}
+		});
+
+	// Output changes and single-thread time per inference of both models
+	input_t converted;
+	number_t dense_output[MODEL_OUTPUT_SAMPLES], sparse_output[MODEL_OUTPUT_SAMPLES];
+	std::chrono::steady_clock::duration dense_time{0}, sparse_time{0};
+	size_t agree = 0;
+	double max_error = 0;
+	for (size_t i = 0; i < test.count; i++) {
+		const input_t &input = *test.input(i, 1, &converted);
+		auto start = std::chrono::steady_clock::now();
+		cnn(input, dense_output);
+		auto middle = std::chrono::steady_clock::now();
+		weights.run(input, sparse_output);
+		sparse_time += std::chrono::steady_clock::now() - middle;
+		dense_time += middle - start;
+		for (unsigned int o = 0; o < MODEL_OUTPUT_SAMPLES; o++) {
+			max_error = std::max(max_error, std::abs(sparse_output[o] - dense_output[o]) / (double)(1 << FIXED_POINT));
+			agree += (sparse_output[o] >= 0) == (dense_output[o] >= 0); // The decision is the sign of the output
+		}
+	}
+
+	size_t stored = weights.values.size() - weights.fillers;
+	unsigned int skipped = weights.skippedFilters();
+	auto us = [&](std::chrono::steady_clock::duration time) {
+		return test.count ? std::chrono::duration<double, std::micro>(time).count() / test.count : 0;
+	};
+	std::cout << "dense_4: " << weights.zeros << "/" << dense_4_t::MACs << " weights zero ("
+		<< 100.0 * weights.zeros / dense_4_t::MACs << "% sparsity), magnitudes up to " << weights.threshold << " pruned" << std::endl;
+	std::cout << "Flash: " << sizeof(dense_4_t::kernel_type) << " bytes dense, " << weights.bytes() << " bytes sparse ("
+		<< stored << " weights, " << weights.fillers << " gap entries), " << (long)sizeof(dense_4_t::kernel_type) - (long)weights.bytes()
+		<< " bytes saved" << std::endl;
+	std::cout << "MACs: dense_4 " << dense_4_t::MACs << " -> " << weights.values.size() << ", " << skipped << "/" << conv1d_6_t::Filters
+		<< " conv1d_6 filters skipped (" << conv1d_6_t::MACs << " -> " << conv1d_6_t::MACs / conv1d_6_t::Filters * (conv1d_6_t::Filters - skipped) << ")" << std::endl;
+	std::cout << "Testing accuracy: " << dense_acc << " dense, " << sparse_acc << " sparse (" << std::showpos << sparse_acc - dense_acc
+		<< std::noshowpos << "), " << agree << "/" << test.count * MODEL_OUTPUT_SAMPLES << " decisions identical, max output error " << max_error << std::endl;
+	std::cout << "Time per inference: " << us(dense_time) << " us dense, " << us(sparse_time) << " us sparse" << std::endl;
+	std::cout << "Wrote " << directory << "/dense_4_sparse.c, rebuild with -DMODEL_SPARSE_DENSE=1 to use it in cnn()" << std::endl;
+	return 0;
+}
+
+// Run registered models side by side on the test set: accuracy of each and of their mean output, how often their
+// decisions agree, and the time of one input through all of them with and without their shared first layer
+int compareModels(const char *xpath, const char *ypath, int count, const char *const names[], unsigned int threads) {
+	std::vector<unsigned int> models;
+	for (int i = 0; i < count; i++) {
+		int model = model_registry_find(names[i]);
+		if (model < 0) {
+			std::cerr << "Unknown model \"" << names[i] << "\"" << std::endl;
+			return 1;
+		}
+		models.push_back(model);
+	}
+	if (models.empty()) {
+		for (unsigned int m = 0; m < MODEL_REGISTRY_SIZE; m++) {
+			models.push_back(m);
+		}
+	}
 
-	for (size_t i = 0;  i < inputs.size() && i < labels.size(); i++) {
-		number_t converted_input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES];
+	TestSet test;
+	openTestSet(test, xpath, ypath, threads);
 
-		convert_input_vector<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES>(inputs.at(i), converted_input);
-		cnn(converted_input, outputs.data());
+	auto run = [&](unsigned int batch, const input_t inputs[], std::vector<std::array<number_t, MODEL_OUTPUT_SAMPLES>> &outputs) {
+		for (unsigned int b = 0; b < batch; b++) {
+			model_registry_run(models.data(), models.size(), inputs[b],
+				reinterpret_cast<number_t (*)[MODEL_OUTPUT_SAMPLES]>(outputs[b * models.size()].data()), true);
+		}
+	};
+	for (unsigned int m = 0; m < models.size(); m++) {
+		float acc = evaluate(test.count, test.input, test.label, threads,
+			[&](unsigned int batch, const input_t inputs[], number_t outputs[][MODEL_OUTPUT_SAMPLES], cnn_batch_activations_t *) {
+				for (unsigned int b = 0; b < batch; b++) {
+					model_registry_run(&models[m], 1, inputs[b], &outputs[b], false);
+				}
+			});
+		std::cout << model_registry[models[m]].name << ": testing accuracy " << acc << std::endl;
+	}
+	float ensemble_acc = evaluate(test.count, test.input, test.label, threads,
+		[&](unsigned int batch, const input_t inputs[], number_t outputs[][MODEL_OUTPUT_SAMPLES], cnn_batch_activations_t *) {
+			std::vector<std::array<number_t, MODEL_OUTPUT_SAMPLES>> all(batch * models.size());
+			run(batch, inputs, all);
+			for (unsigned int b = 0; b < batch; b++) {
+				for (unsigned int o = 0; o < MODEL_OUTPUT_SAMPLES; o++) {
+					long_number_t sum = 0;
+					for (unsigned int m = 0; m < models.size(); m++) {
+						sum += all[b * models.size() + m][o];
+					}
+					outputs[b][o] = sum / (long_number_t)models.size();
+				}
+			}
+		});
+	std::cout << "Ensemble (mean output): testing accuracy " << ensemble_acc << std::endl;
 
-		auto cls = std::max_element(outputs.begin(), outputs.end()) - outputs.begin();
+	// Decision agreement and single-thread time of all the models on one input, the outputs of both runs must match
+	input_t converted;
+	std::vector<std::array<number_t, MODEL_OUTPUT_SAMPLES>> shared(models.size()), separate(models.size());
+	std::vector<size_t> agree(models.size() * models.size(), 0);
+	std::chrono::steady_clock::duration shared_time{0}, separate_time{0};
+	size_t mismatches = 0, shared_prefixes = 0, separate_prefixes = 0;
+	for (size_t i = 0; i < test.count; i++) {
+		const input_t &input = *test.input(i, 1, &converted);
+		auto start = std::chrono::steady_clock::now();
+		separate_prefixes += model_registry_run(models.data(), models.size(), input,
+			reinterpret_cast<number_t (*)[MODEL_OUTPUT_SAMPLES]>(separate.data()), false);
+		auto middle = std::chrono::steady_clock::now();
+		shared_prefixes += model_registry_run(models.data(), models.size(), input,
+			reinterpret_cast<number_t (*)[MODEL_OUTPUT_SAMPLES]>(shared.data()), true);
+		shared_time += std::chrono::steady_clock::now() - middle;
+		separate_time += middle - start;
+		mismatches += shared != separate;
+		for (unsigned int a = 0; a < models.size(); a++) {
+			for (unsigned int b = 0; b < models.size(); b++) {
+				for (unsigned int o = 0; o < MODEL_OUTPUT_SAMPLES; o++) {
+					agree[a * models.size() + b] += (shared[a][o] >= 0) == (shared[b][o] >= 0); // The decision is the sign of the output
+				}
+			}
+		}
+	}
 
-		if (labels.at(i).at(cls) > 0) {
-			rightlabels++;
+	std::cout << "Decisions identical (of " << test.count * MODEL_OUTPUT_SAMPLES << "):" << std::endl;
+	for (unsigned int a = 0; a < models.size(); a++) {
+		std::cout << "  " << model_registry[models[a]].name << ":";
+		for (unsigned int b = 0; b < models.size(); b++) {
+			std::cout << " " << agree[a * models.size() + b];
 		}
+		std::cout << std::endl;
+	}
+	auto us = [&](std::chrono::steady_clock::duration time) {
+		return test.count ? std::chrono::duration<double, std::micro>(time).count() / test.count : 0;
+	};
+	std::cout << "First layers per input: " << (double)separate_prefixes / std::max<size_t>(1, test.count) << " separate, "
+		<< (double)shared_prefixes / std::max<size_t>(1, test.count) << " shared" << std::endl;
+	std::cout << "Time per input for all models: " << us(separate_time) << " us separate, " << us(shared_time) << " us shared, "
+		<< mismatches << " inputs with different outputs" << std::endl;
+	return mismatches ? 1 : 0;
+}
+
+// Band of conv1d_5 outputs to escalate that holds the given share of the outputs on which conv1d_5 and conv1d_6 decide
+// differently, on each side of the decision
+model_cascade_t tuneCascade(const std::vector<number_t> &small, const std::vector<number_t> &large, double coverage) {
+	std::vector<number_t> negative, positive; // Wrong decisions of conv1d_5 below and above 0
+	for (size_t i = 0; i < small.size(); i++) {
+		if ((small[i] >= 0) != (large[i] >= 0)) {
+			(small[i] >= 0 ? positive : negative).push_back(small[i]);
+		}
+	}
+	std::sort(negative.begin(), negative.end());
+	std::sort(positive.begin(), positive.end());
+
+	// The bounds are the last outputs covered on each side, so that saturated outputs can be escalated too. [0, -1]
+	// escalates none, [low, -1] and [0, high] only one side
+	auto covered = [&](size_t n) { return (size_t)std::ceil(coverage / 100 * n); };
+	model_cascade_t cascade;
+	cascade.low = 0;
+	cascade.high = -1;
+	if (covered(negative.size())) {
+		cascade.low = negative[negative.size() - covered(negative.size())];
+	}
+	if (covered(positive.size())) {
+		cascade.high = positive[covered(positive.size()) - 1];
+	}
+	return cascade;
+}
+
+// Tune the conv1d_5 -> conv1d_6 cascade on the outputs of both models over the even windows of the test set and report
+// what it costs and saves against always running conv1d_6 on the odd windows, held out, for several shares of the
+// disagreements escalated
+int cascadeReport(const char *xpath, const char *ypath, double coverage, unsigned int threads) {
+	TestSet test;
+	openTestSet(test, xpath, ypath, threads);
+
+	// Interleaved rather than halves, in case the windows are sorted by label or recording
+	input_t converted;
+	std::vector<number_t> small, large, tune_small, tune_large;
+	std::vector<size_t> held_out;
+	for (size_t i = 0; i < test.count; i++) {
+		const input_t &input = *test.input(i, 1, &converted);
+		number_t small_output[MODEL_OUTPUT_SAMPLES], large_output[MODEL_OUTPUT_SAMPLES];
+		conv1d_5::cnn(input, small_output);
+		conv1d_6::cnn(input, large_output);
+		bool tuning = i % 2 == 0;
+		std::vector<number_t> &small_outputs = tuning ? tune_small : small, &large_outputs = tuning ? tune_large : large;
+		small_outputs.insert(small_outputs.end(), small_output, small_output + MODEL_OUTPUT_SAMPLES);
+		large_outputs.insert(large_outputs.end(), large_output, large_output + MODEL_OUTPUT_SAMPLES);
+		if (!tuning) {
+			held_out.push_back(i);
+		}
+	}
+
+	auto fixed = [](number_t value) { return value / (double)(1 << FIXED_POINT); };
+	size_t large_right = 0;
+	for (size_t h = 0; h < held_out.size(); h++) {
+		large_right += predicts(&large[h * MODEL_OUTPUT_SAMPLES], test.label(held_out[h]));
+	}
+	double large_acc = held_out.size() ? large_right / (double)held_out.size() : 0;
+	std::cout << "Tuned on " << test.count - held_out.size() << " windows, scored on " << held_out.size() << " held out" << std::endl;
+	std::cout << "MACs per window: conv1d_5 " << MODEL_CASCADE_SMALL_MACS << ", conv1d_6 " << MODEL_CASCADE_LARGE_MACS
+		<< ", escalated " << MODEL_CASCADE_SMALL_MACS + MODEL_CASCADE_LARGE_MACS << std::endl;
+	std::cout << "conv1d_6 alone: held-out accuracy " << large_acc << std::endl;
+
+	std::vector<double> coverages = {0, 50, 90, 95, 99, 100};
+	if (std::find(coverages.begin(), coverages.end(), coverage) == coverages.end()) {
+		coverages.push_back(coverage);
+		std::sort(coverages.begin(), coverages.end());
+	}
+	for (double c : coverages) {
+		model_cascade_t cascade = tuneCascade(tune_small, tune_large, c);
+		size_t escalated = 0, right = 0;
+		for (size_t h = 0; h < held_out.size(); h++) {
+			const number_t *output = &small[h * MODEL_OUTPUT_SAMPLES];
+			bool escalate = false;
+			for (unsigned int o = 0; o < MODEL_OUTPUT_SAMPLES; o++) {
+				escalate = escalate || (output[o] >= cascade.low && output[o] <= cascade.high);
+			}
+			escalated += escalate;
+			right += predicts(escalate ? &large[h * MODEL_OUTPUT_SAMPLES] : output, test.label(held_out[h]));
+		}
+		double rate = held_out.size() ? escalated / (double)held_out.size() : 0;
+		double acc = held_out.size() ? right / (double)held_out.size() : 0;
+		std::cout << (c == coverage ? "* " : "  ") << c << "% of tuning disagreements escalated: band [" << fixed(cascade.low)
+			<< ", " << fixed(cascade.high) << "], escalation rate " << 100 * rate << "%, MACs per window "
+			<< MODEL_CASCADE_SMALL_MACS + rate * MODEL_CASCADE_LARGE_MACS << ", held-out accuracy " << acc << " ("
+			<< std::showpos << acc - large_acc << std::noshowpos << ")" << std::endl;
+	}
+
+	// The selected band through cnn_cascade() on the held-out windows, timed on one thread against conv1d_6 alone
+	model_cascade_t cascade = tuneCascade(tune_small, tune_large, coverage);
+	number_t output[MODEL_OUTPUT_SAMPLES];
+	std::chrono::steady_clock::duration cascade_time{0}, large_time{0};
+	size_t escalated = 0, right = 0;
+	for (size_t i : held_out) {
+		const input_t &input = *test.input(i, 1, &converted);
+		auto start = std::chrono::steady_clock::now();
+		conv1d_6::cnn(input, output);
+		auto middle = std::chrono::steady_clock::now();
+		escalated += cnn_cascade(&cascade, input, output);
+		cascade_time += std::chrono::steady_clock::now() - middle;
+		large_time += middle - start;
+		right += predicts(output, test.label(i));
+	}
+	auto us = [&](std::chrono::steady_clock::duration time) {
+		return held_out.size() ? std::chrono::duration<double, std::micro>(time).count() / held_out.size() : 0;
+	};
+	std::cout << "cnn_cascade() with low = " << cascade.low << ", high = " << cascade.high << ": held-out accuracy "
+		<< (held_out.size() ? right / (double)held_out.size() : 0) << ", " << escalated << "/" << held_out.size()
+		<< " escalated, " << us(cascade_time) << " us per window against " << us(large_time) << " us for conv1d_6" << std::endl;
+	return 0;
+}
+
+// Write weights/conv1d_6_dense_4_bounds.c and report the share of conv1d_6 -> dense_4 MACs the early exit runs to decide
+// whether the output of cnn() is at least threshold, with the filters in their order and ordered by range
+int earlyExitReport(const char *xpath, const char *ypath, const char *directory, number_t threshold, unsigned int threads) {
+	TestSet test;
+	openTestSet(test, xpath, ypath, threads);
+
+	EarlyExitBounds ordered = earlyExitBounds(true), unordered = earlyExitBounds(false);
+	if (!writeEarlyExitBounds(ordered, directory)) {
+		return 1;
+	}
+
+	input_t converted;
+	number_t output[MODEL_OUTPUT_SAMPLES];
+	std::chrono::steady_clock::duration full_time{0}, exit_time{0};
+	size_t agree = 0, positive = 0;
+	uint64_t ordered_rows = 0, unordered_rows = 0;
+	for (size_t i = 0; i < test.count; i++) {
+		const input_t &input = *test.input(i, 1, &converted);
+		unsigned int rows;
+		auto start = std::chrono::steady_clock::now();
+		cnn(input, output);
+		auto middle = std::chrono::steady_clock::now();
+		bool decision = ordered.decide(input, threshold, &rows);
+		exit_time += std::chrono::steady_clock::now() - middle;
+		full_time += middle - start;
+		ordered_rows += rows;
+		agree += decision == (output[0] >= threshold);
+		agree += unordered.decide(input, threshold, &rows) == (output[0] >= threshold);
+		unordered_rows += rows;
+		positive += decision;
+	}
+
+	auto share = [&](uint64_t rows) {
+		return test.count ? 100.0 * rows / ((double)test.count * conv1d_6_t::Filters) : 0;
+	};
+	auto us = [&](std::chrono::steady_clock::duration time) {
+		return test.count ? std::chrono::duration<double, std::micro>(time).count() / test.count : 0;
+	};
+	std::cout << "Threshold " << threshold / (double)(1 << FIXED_POINT) << ": " << positive << "/" << test.count << " outputs at or above, "
+		<< agree << "/" << 2 * test.count << " decisions identical to cnn()" << std::endl;
+	std::cout << "conv1d_6 -> dense_4 MACs executed: " << share(unordered_rows) << "% in filter order, " << share(ordered_rows)
+		<< "% ordered by range (" << share(ordered_rows) / 100 * conv1d_6_dense_4_early_exit_t::MACs << " of "
+		<< conv1d_6_dense_4_early_exit_t::MACs << " per inference)" << std::endl;
+	std::cout << "Time per inference: " << us(full_time) << " us cnn(), " << us(exit_time) << " us early exit" << std::endl;
+#if MODEL_EARLY_EXIT
+	size_t built_agree = 0;
+	model_early_exit_reset();
+	for (size_t i = 0; i < test.count; i++) {
+		const input_t &input = *test.input(i, 1, &converted);
+		cnn(input, output);
+		built_agree += cnn_decide(input, threshold) == (output[0] >= threshold);
+	}
+	std::cout << "cnn_decide(): " << built_agree << "/" << test.count << " decisions identical, " << share(model_early_exit.rows)
+		<< "% of the MACs executed" << std::endl;
+#endif
+	std::cout << "Wrote " << directory << "/conv1d_6_dense_4_bounds.c, rebuild with -DMODEL_EARLY_EXIT=1 to use it in cnn_decide()" << std::endl;
+	return agree == 2 * test.count ? 0 : 1;
+}
+
+// Convert CSV inputs and labels to binary datasets, inputs are quantized unless float32 is requested
+int convert(const char *xcsv, const char *ycsv, const char *xbin, const char *ybin, DatasetType dtype, unsigned int threads) {
+	auto inputs = readInputsFromFile<MODEL_INPUT_SAMPLES*MODEL_INPUT_CHANNELS>(xcsv, threads);
+	auto labels = readInputsFromFile<MODEL_OUTPUT_SAMPLES>(ycsv, threads);
+	const char *error;
+
+	if (dtype == DATASET_NUMBER_T) {
+		std::vector<number_t> rows(inputs.size() * MODEL_INPUT_CHANNELS * MODEL_INPUT_SAMPLES);
+		input_t *converted = reinterpret_cast<input_t *>(rows.data());
+		for (size_t i = 0; i < inputs.size(); i++) {
+			convert_input_vector<MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES>(inputs.at(i), converted[i]);
+		}
+		error = writeDataset(xbin, dtype, FIXED_POINT, inputs.size(), MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES, rows.data());
+	} else {
+		std::vector<float> rows(inputs.size() * MODEL_INPUT_CHANNELS * MODEL_INPUT_SAMPLES);
+		for (size_t i = 0; i < inputs.size(); i++) {
+			for (size_t c = 0; c < MODEL_INPUT_CHANNELS; c++) {
+				for (size_t j = 0; j < MODEL_INPUT_SAMPLES; j++) {
+					rows.at((i*MODEL_INPUT_CHANNELS + c)*MODEL_INPUT_SAMPLES + j) = inputs.at(i).at(j*MODEL_INPUT_CHANNELS + c); // CSV interleaves channels
+				}
+			}
+		}
+		error = writeDataset(xbin, dtype, 0, inputs.size(), MODEL_INPUT_CHANNELS, MODEL_INPUT_SAMPLES, rows.data());
+	}
+	if (error) {
+		std::cerr << "Error writing \"" << xbin << "\": " << error << std::endl;
+		return 1;
+	}
+
+	error = writeDataset(ybin, DATASET_FLOAT32, 0, labels.size(), 1, MODEL_OUTPUT_SAMPLES, labels.data()->data());
+	if (error) {
+		std::cerr << "Error writing \"" << ybin << "\": " << error << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// Compare the board MFCC front-end with librosa features, row i of the reference CSV belongs to the i-th raw
+// 16-bit PCM clip. Clips are pushed in blocks like I2S DMA transfers
+int compareMFCC(const char *reference, int clips, const char *const files[]) {
+	const size_t block = 256;
+	auto rows = readInputsFromFile<MFCC_N_COEFFICIENTS>(reference);
+	if (rows.size() != (size_t)clips) {
+		std::cerr << "Error: " << rows.size() << " reference rows for " << clips << " clips" << std::endl;
+		return 1;
+	}
+
+	std::unique_ptr<MFCC> mfcc(new MFCC); // Tables and state take tens of KB
+	std::array<int32_t, MFCC_N_COEFFICIENTS> coefficients;
+	double max_error = 0, total_error = 0;
+	size_t identical = 0;
+	int max_lsb = 0;
+
+	for (int i = 0; i < clips; i++) {
+		MappedFile file;
+		if (!file.open(files[i])) {
+			std::cerr << "Error opening \"" << files[i] << "\": " << strerror(errno) << std::endl;
+			return 1;
+		}
+		const int16_t *pcm = reinterpret_cast<const int16_t *>(file.data());
+		size_t samples = file.size() / sizeof(int16_t);
+		for (size_t j = 0; j < samples; j += block) {
+			mfcc->push(pcm + j, std::min(block, samples - j));
+		}
+		uint32_t frames = mfcc->finish(coefficients.data());
+
+		// Error in dB and in number_t steps once both are quantized like the evaluator inputs
+		double clip_error = 0;
+		int clip_lsb = 0;
+		for (size_t k = 0; k < MFCC_N_COEFFICIENTS; k++) {
+			double error = std::fabs(coefficients[k] / (double)(1 << MFCC_FRACTION_BITS) - rows[i][k]);
+			number_t fixed = clamp_to_number_t(MFCC::toFixed(coefficients[k], FIXED_POINT));
+			number_t expected = clamp_to_number_t((long_number_t)(rows[i][k] * (1<<FIXED_POINT)));
+			int lsb = std::abs(fixed - expected);
+			clip_error = std::max(clip_error, error);
+			clip_lsb = std::max(clip_lsb, lsb);
+			total_error += error;
+			identical += lsb == 0;
+		}
+		max_error = std::max(max_error, clip_error);
+		max_lsb = std::max(max_lsb, clip_lsb);
+		std::cout << files[i] << ": " << frames << " frames, max error " << clip_error << " dB, " << clip_lsb << " LSB" << std::endl;
+	}
+
+	size_t values = (size_t)clips * MFCC_N_COEFFICIENTS;
+	std::cout << "Max error " << max_error << " dB, mean " << total_error / values << " dB, "
+		<< identical << "/" << values << " fixed-point inputs identical, max " << max_lsb << " LSB" << std::endl;
+	return 0;
+}
+
+// Run the board activity gate over raw 16-bit PCM files to tune its thresholds: frames with the gate open and the
+// windows of MODEL_STREAM_HOP samples that would reach the model
+int activityReport(int files, const char *const paths[]) {
+	uint64_t total_frames = 0, total_active = 0, total_windows = 0, total_inferred = 0;
+
+	for (int i = 0; i < files; i++) {
+		MappedFile file;
+		if (!file.open(paths[i])) {
+			std::cerr << "Error opening \"" << paths[i] << "\": " << strerror(errno) << std::endl;
+			return 1;
+		}
+		const int16_t *pcm = reinterpret_cast<const int16_t *>(file.data());
+		size_t samples = file.size() / sizeof(int16_t);
+
+		// One gate per file, fed by hops like the board ring
+		ActivityGate gate;
+		uint32_t windows = 0, inferred = 0;
+		int32_t max_level = INT32_MIN;
+		for (size_t j = 0; j + MODEL_STREAM_HOP <= samples; j += MODEL_STREAM_HOP) {
+			gate.push(pcm + j, MODEL_STREAM_HOP);
+			max_level = std::max(max_level, gate.level());
+			if (j + MODEL_STREAM_HOP >= MODEL_INPUT_SAMPLES) {
+				windows++;
+				inferred += gate.active();
+			}
+		}
+
+		std::cout << paths[i] << ": " << gate.activeFrameCount() << "/" << gate.frameCount() << " frames active, "
+			<< inferred << "/" << windows << " windows inferred, max level " << max_level / 256.0
+			<< " dBFS, noise floor " << gate.noiseFloor() / 256.0 << " dBFS" << std::endl;
+		total_frames += gate.frameCount();
+		total_active += gate.activeFrameCount();
+		total_windows += windows;
+		total_inferred += inferred;
+	}
+
+	std::cout << "Total: " << total_active << "/" << total_frames << " frames active, " << total_inferred << "/"
+		<< total_windows << " windows inferred (" << (total_windows ? 100.0 * total_inferred / total_windows : 0) << " %)" << std::endl;
+	return 0;
+}
+
+// Replay the board duty cycle for hours with fixed durations per clip and compare the simulated average power with the
+// closed form. Defaults are the measurements of doc/Rendu.md (14.1 mW active, 27 ms inference, 316.8 mWh battery);
+// the STOP mode power of the MCU with the codec powered down is an estimate to replace by a measurement. The activity
+// gate is open on active_percent of the clips, evenly spread, and the others leave Infer at once without inference
+int simulateDutyCycle(int argc, const char *argv[]) {
+	const uint32_t duration_ms = 24 * 3600 * 1000;
+	double values[] = {2560, 50, 1000, 27, 14.1, 0.01, 316.8, 100};
+	const char *names[] = {"period_ms", "settle_ms", "clip_ms", "inference_ms", "active_mw", "sleep_mw", "battery_mwh", "active_percent"};
+	for (int i = 0; i < argc; i++) {
+		values[i] = std::strtod(argv[i], NULL);
+	}
+	uint32_t period_ms = values[0], settle_ms = values[1], clip_ms = values[2], inference_ms = values[3];
+	double active_mw = values[4], sleep_mw = values[5], battery_mwh = values[6], active_percent = values[7];
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+		std::cout << names[i] << "=" << values[i] << (i + 1 < sizeof(values) / sizeof(values[0]) ? " " : "\n");
+	}
+
+	// Event-driven: each state lasts its simulated duration. A clip starts when Listen is entered after Settle, or
+	// at the end of the previous clip when capture continued during the inference
+	DutyCycleScheduler scheduler(period_ms, settle_ms);
+	uint32_t now = 0, entered = 0, clip_start = 0, clip_end = 0;
+	uint64_t clips = 0, inferred = 0; // Clips that left Infer, and those the model ran on
+	bool clip_inferred = false;
+	PowerState state = PowerState::Settle;
+	scheduler.start(now);
+	while (now < duration_ms) {
+		PowerState previous = state;
+		state = scheduler.update(now, state == PowerState::Listen && now >= clip_start + clip_ms, clip_inferred);
+		if (previous == PowerState::Infer && state != previous) {
+			clips++;
+			inferred += clip_inferred;
+		}
+		if (state != previous) {
+			entered = now;
+			if (state == PowerState::Infer) {
+				clip_end = now;
+				clip_inferred = std::floor((clips + 1) * active_percent / 100) > std::floor(clips * active_percent / 100);
+			} else if (state == PowerState::Listen) {
+				clip_start = previous == PowerState::Settle ? now : clip_end;
+			}
+		}
+		switch (state) {
+			case PowerState::Sleep: now += scheduler.sleepTime(now); break;
+			case PowerState::Settle: now = std::max(now, entered + settle_ms); break;
+			case PowerState::Listen: now = std::max(now, clip_start + clip_ms); break;
+			case PowerState::Infer: now = std::max(now, entered + (clip_inferred ? inference_ms : 0)); break;
+		}
+	}
+
+	const EnergyCounters &energy = scheduler.energy(now);
+	double awake_mj = (energy.settle_ms + energy.listen_ms + energy.infer_ms) * active_mw / 1000;
+	double average_mw = (awake_mj + energy.sleep_ms * sleep_mw / 1000) / (now / 1000.0);
+
+	// Closed form for one period, the codec stays powered when a capture does not fit
+	double active_ms = settle_ms + clip_ms + inference_ms * active_percent / 100;
+	double expected_mw = active_ms >= period_ms ? active_mw
+		: (active_ms * active_mw + (period_ms - active_ms) * sleep_mw) / period_ms;
+
+	std::cout << "Simulated " << now / 1000 << " s: sleep " << energy.sleep_ms << " ms, settle " << energy.settle_ms
+		<< " ms, listen " << energy.listen_ms << " ms, inference " << energy.infer_ms << " ms, "
+		<< energy.inferences << " inferences, " << energy.wakeups << " wake-ups" << std::endl;
+	std::cout << "Duty cycle " << 100.0 * energy.activeTime() / now << " %, average power " << average_mw
+		<< " mW (closed form " << expected_mw << " mW), battery life " << battery_mwh / average_mw << " h" << std::endl;
+
+	// Clips skipped by the activity gate must not count as inferences in the counters read over serial
+	if (energy.inferences != inferred) {
+		std::cerr << "Error: " << energy.inferences << " inferences counted for " << inferred << " clips inferred out of "
+			<< clips << std::endl;
+		return 1;
+	}
+	std::cout << inferred << " of " << clips << " clips inferred, " << clips - inferred << " skipped by the activity gate" << std::endl;
+	return 0;
+}
+
+// Time each layer of cnn() on one thread over the test inputs, repeated, and print the per-layer statistics.
+// Requires a build with -DMODEL_PROFILE=1
+int profileModel(const char *path, unsigned int repeat) {
+#if MODEL_PROFILE
+	auto inputs = readQuantizedInputs(path);
+
+	number_t output[MODEL_OUTPUT_SAMPLES];
+	profile_init();
+	model_profile_reset();
+	for (unsigned int r = 0; r < repeat; r++) {
+		for (auto &row : inputs) {
+			cnn(*reinterpret_cast<const input_t *>(row.data()), output);
+		}
+	}
+
+	char line[160];
+	for (unsigned int i = 0; i < MODEL_PROFILE_LAYERS; i++) {
+		profile_format(line, sizeof(line), &model_profile[i]);
+		std::cerr << line << std::endl;
+	}
+	return 0;
+#else
+	(void)path;
+	(void)repeat;
+	std::cerr << "Error: per-layer profiling requires a build with -DMODEL_PROFILE=1" << std::endl;
+	return 1;
+#endif
+}
+
+// Count the nonzero conv1d_6 outputs of cnn() over the test inputs: the share of dense_4 MACs the activation-sparse
+// kernel skips. Requires a build with -DMODEL_ACTIVATION_SPARSE=1
+int densityReport(const char *path) {
+#if MODEL_ACTIVATION_SPARSE
+	auto inputs = readQuantizedInputs(path);
+
+	number_t output[MODEL_OUTPUT_SAMPLES];
+	model_density_reset();
+	for (auto &row : inputs) {
+		cnn(*reinterpret_cast<const input_t *>(row.data()), output);
+	}
+
+	const double outputs = flatten_2_t::OutputSamples;
+	double mean = model_density.inferences ? model_density.total / (double)model_density.inferences : 0;
+	std::cout << model_density.inferences << " inferences, nonzero conv1d_6 outputs per inference: min " << model_density.min
+		<< " (" << 100 * model_density.min / outputs << "%), mean " << mean << " (" << 100 * mean / outputs << "%), max "
+		<< model_density.max << " (" << 100 * model_density.max / outputs << "%)" << std::endl;
+	std::cout << "dense_4 MACs per inference: " << mean * dense_4_t::Units << " of " << dense_4_t::MACs << std::endl;
+	return 0;
+#else
+	(void)path;
+	std::cerr << "Error: activation density counters require a build with -DMODEL_ACTIVATION_SPARSE=1" << std::endl;
+	return 1;
+#endif
+}
+
+// Print the activation arena layout planned at compile time
+template<typename Plan>
+void printArenaPlan(const std::string &name) {
+	std::cout << name << " activation arena: " << Plan::bytes << " bytes" << std::endl;
+	for (unsigned int i = 0; i < Plan::tensors; i++) {
+		std::cout << "  " << model_tensor_names[i] << ": offset " << Plan::offset(i) << ", " << Plan::sizes[i] << " bytes" << std::endl;
 	}
-	return rightlabels/(float)inputs.size();
 }
 
 int main(int argc, const char *argv[]) {
-	if (argc != 3) {
-		std::cerr << "Usage: " << argv[0] << " testX.csv testY.csv" << std::endl;
+	if (argc == 2 && !strcmp(argv[1], "--memory")) {
+		printArenaPlan<model_arena_plan_t>("Single inference");
+		printArenaPlan<model_batch_arena_plan_t>("Batch of " + std::to_string(MODEL_BATCH_SIZE));
+		std::cout << "Streaming state: " << sizeof(cnn_stream_t) << " bytes, hop of " << MODEL_STREAM_HOP << " samples" << std::endl;
+		std::cout << "int8 inference: " << MODEL_INT8_ARENA_SIZE << " bytes" << std::endl;
+		std::cout << "MFCC front-end: " << sizeof(MFCC) << " bytes" << std::endl;
+		return 0;
+	}
+	if (argc >= 2 && argc <= 10 && !strcmp(argv[1], "--duty-cycle")) {
+		return simulateDutyCycle(argc - 2, argv + 2);
+	}
+	if ((argc == 3 || argc == 4) && !strcmp(argv[1], "--profile")) {
+		return profileModel(argv[2], argc == 4 ? std::strtoul(argv[3], NULL, 10) : 1);
+	}
+	if (argc == 3 && !strcmp(argv[1], "--density")) {
+		return densityReport(argv[2]);
+	}
+	if ((argc == 4 || argc == 5) && !strcmp(argv[1], "--calibrate")) {
+		auto inputs = readQuantizedInputs(argv[2]);
+		double percentile = argc == 5 ? std::strtod(argv[4], NULL) : 99.99;
+		if (!(percentile > 0 && percentile <= 100)) {
+			std::cerr << "Error: the percentile must be in (0, 100]" << std::endl;
+			return 1;
+		}
+		return calibrateInt8(reinterpret_cast<const input_t *>(inputs.data()), inputs.size(), percentile, argv[3]) ? 0 : 1;
+	}
+	if ((argc == 6 || argc == 7) && !strcmp(argv[1], "--prune")) {
+		double sparsity = std::strtod(argv[5], NULL);
+		if (!(sparsity >= 0 && sparsity <= 100)) {
+			std::cerr << "Error: the sparsity must be in [0, 100]" << std::endl;
+			return 1;
+		}
+		unsigned int threads = argc == 7 ? std::strtoul(argv[6], NULL, 10) : std::thread::hardware_concurrency();
+		return pruneModel(argv[2], argv[3], argv[4], sparsity, std::max(1u, threads));
+	}
+	if (argc >= 4 && !strcmp(argv[1], "--compare-models")) {
+		return compareModels(argv[2], argv[3], argc - 4, argv + 4, std::thread::hardware_concurrency());
+	}
+	if ((argc == 4 || argc == 5) && !strcmp(argv[1], "--cascade")) {
+		double coverage = argc == 5 ? std::strtod(argv[4], NULL) : 95;
+		if (!(coverage >= 0 && coverage <= 100)) {
+			std::cerr << "Error: the share of disagreements escalated must be in [0, 100]" << std::endl;
+			return 1;
+		}
+		return cascadeReport(argv[2], argv[3], coverage, std::thread::hardware_concurrency());
+	}
+	if ((argc == 5 || argc == 6) && !strcmp(argv[1], "--early-exit")) {
+		double threshold = argc == 6 ? std::strtod(argv[5], NULL) : 0;
+		return earlyExitReport(argv[2], argv[3], argv[4], clamp_to_number_t(std::lround(threshold * (1 << FIXED_POINT))),
+			std::thread::hardware_concurrency());
+	}
+	if (argc >= 3 && argc <= 5 && !strcmp(argv[1], "--stream") && (!strcmp(argv[2], "raw") || !strcmp(argv[2], "mfcc"))) {
+		PcmStreamOptions options;
+		options.mfcc = !strcmp(argv[2], "mfcc");
+		options.speed = argc >= 4 ? std::strtod(argv[3], NULL) : 0;
+		options.gate = !(argc == 5 && !strcmp(argv[4], "nogate"));
+		return streamPcm(options);
+	}
+	if (argc >= 3 && argc <= 7 && !strcmp(argv[1], "--serve")) {
+		ServerOptions options;
+		options.socket_path = argv[2];
+		options.workers = std::max(1u, argc >= 4 ? (unsigned int)std::strtoul(argv[3], NULL, 10) : std::thread::hardware_concurrency());
+		options.max_batch = std::max(1u, argc >= 5 ? (unsigned int)std::strtoul(argv[4], NULL, 10) : MODEL_BATCH_SIZE);
+		options.deadline_us = argc >= 6 ? std::strtoul(argv[5], NULL, 10) : 1000;
+		options.model_path = argc == 7 ? argv[6] : NULL;
+		return serve(options);
+	}
+	if (argc >= 4 && argc <= 8 && !strcmp(argv[1], "--load")) {
+		auto inputs = readQuantizedInputs(argv[3]);
+		unsigned int connections = std::max(1u, argc >= 5 ? (unsigned int)std::strtoul(argv[4], NULL, 10) : 8);
+		size_t requests = argc >= 6 ? std::strtoul(argv[5], NULL, 10) : inputs.size();
+		unsigned int depth = std::max(1u, argc >= 7 ? (unsigned int)std::strtoul(argv[6], NULL, 10) : 1);
+		bool pcm = argc == 8 && !strcmp(argv[7], "pcm");
+		return loadTest(argv[2], reinterpret_cast<const input_t *>(inputs.data()), inputs.size(), connections, requests, depth, pcm);
+	}
+	if (argc == 4 && !strcmp(argv[1], "--export-model")) {
+		const char *error = exportModel(argv[2], argv[3]);
+		if (error) {
+			std::cerr << "Error exporting \"" << argv[2] << "\" to \"" << argv[3] << "\": " << error << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+	if (argc >= 3 && !strcmp(argv[1], "--activity")) {
+		return activityReport(argc - 2, argv + 2);
+	}
+	if (argc >= 4 && !strcmp(argv[1], "--mfcc")) {
+		return compareMFCC(argv[2], argc - 3, argv + 3);
+	}
+
+	// Evaluate cnn_int8() or the weights of a model blob instead of cnn()
+	const char *program = argv[0];
+	bool int8 = argc >= 2 && !strcmp(argv[1], "--int8");
+	const char *blob = argc >= 3 && !strcmp(argv[1], "--model") ? argv[2] : NULL;
+	if (int8) {
+#if !MODEL_INT8_CALIBRATED
+		std::cerr << "Error: no int8 weights, run " << program << " --calibrate trainX.csv on the training set and rebuild" << std::endl;
+		return 1;
+#endif
+		argc--;
+		argv++;
+	} else if (blob) {
+		argc -= 2;
+		argv += 2;
+	}
+
+	bool convert_mode = !int8 && !blob && argc >= 2 && !strcmp(argv[1], "--convert");
+	if (convert_mode ? (argc != 6 && argc != 7) : (argc != 3 && argc != 4)) {
+		std::cerr << "Usage: " << program << " [--int8 | --model model.gscm] testX.{csv,bin} testY.{csv,bin} [threads]" << std::endl;
+		std::cerr << "       " << program << " --convert testX.csv testY.csv testX.bin testY.bin [number_t|float32]" << std::endl;
+		std::cerr << "       " << program << " --memory" << std::endl;
+		std::cerr << "       " << program << " --stream raw|mfcc [speed] [gate|nogate] < pcm_s16le_16khz_mono" << std::endl;
+		std::cerr << "       " << program << " --serve socket [workers] [max_batch] [deadline_us] [model.gscm]" << std::endl;
+		std::cerr << "       " << program << " --load socket testX.{csv,bin} [connections] [requests] [depth] [features|pcm]" << std::endl;
+		std::cerr << "       " << program << " --mfcc reference.csv clip.raw..." << std::endl;
+		std::cerr << "       " << program << " --export-model conv1d_6|conv1d|conv1d_5 model.gscm" << std::endl;
+		std::cerr << "       " << program << " --compare-models testX.{csv,bin} testY.{csv,bin} [conv1d|conv1d_5|conv1d_6...]" << std::endl;
+		std::cerr << "       " << program << " --cascade testX.{csv,bin} testY.{csv,bin} [disagreements_escalated_percent]" << std::endl;
+		std::cerr << "       " << program << " --calibrate trainX.{csv,bin} weights_directory [percentile]" << std::endl;
+		std::cerr << "       " << program << " --prune testX.{csv,bin} testY.{csv,bin} weights_directory sparsity_percent [threads]" << std::endl;
+		std::cerr << "       " << program << " --early-exit testX.{csv,bin} testY.{csv,bin} weights_directory [threshold]" << std::endl;
+		std::cerr << "       " << program << " --profile testX.{csv,bin} [repeat] (build with -DMODEL_PROFILE=1)" << std::endl;
+		std::cerr << "       " << program << " --density testX.{csv,bin} (build with -DMODEL_ACTIVATION_SPARSE=1)" << std::endl;
+		std::cerr << "       " << program << " --activity clip.raw..." << std::endl;
+		std::cerr << "       " << program << " --duty-cycle [period_ms settle_ms clip_ms inference_ms active_mw sleep_mw battery_mwh active_percent]" << std::endl;
 		exit(1);
 	}
 
-	auto inputs = readInputsFromFile<MODEL_INPUT_SAMPLES*MODEL_INPUT_CHANNELS>(argv[1]);
-	auto labels = readInputsFromFile<MODEL_OUTPUT_SAMPLES>(argv[2]);
+	unsigned int threads = std::thread::hardware_concurrency();
+	if (!convert_mode && argc == 4) {
+		threads = std::strtoul(argv[3], NULL, 10);
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
 
-	auto acc = evaluate(inputs, labels);
+	if (convert_mode) {
+		DatasetType dtype = DATASET_NUMBER_T;
+		if (argc == 7 && !strcmp(argv[6], "float32")) {
+			dtype = DATASET_FLOAT32;
+		} else if (argc == 7 && strcmp(argv[6], "number_t")) {
+			std::cerr << "Unknown data type \"" << argv[6] << "\"" << std::endl;
+			exit(1);
+		}
+		return convert(argv[2], argv[3], argv[4], argv[5], dtype, threads);
+	}
+
+	TestSet test;
+	openTestSet(test, argv[1], argv[2], threads);
+
+	ModelSlot slot;
+	if (blob) {
+		const char *error = slot.load(blob);
+		if (error) {
+			std::cerr << "Error loading \"" << blob << "\": " << error << std::endl;
+			return 1;
+		}
+		std::cerr << "Model " << slot.get()->name() << " from " << blob << std::endl;
+	}
+
+	float acc;
+	if (int8) {
+#if MODEL_INT8_CALIBRATED
+		acc = evaluate(test.count, test.input, test.label, threads, runInt8);
+#endif
+	} else if (blob) {
+		acc = evaluate(test.count, test.input, test.label, threads,
+			[&](unsigned int batch, const input_t inputs[], number_t outputs[][MODEL_OUTPUT_SAMPLES], cnn_batch_activations_t *) {
+				std::shared_ptr<const ModelFile> model = slot.get(); // Kept mapped for the whole batch
+				cnn_activations_t activations;
+				for (unsigned int b = 0; b < batch; b++) {
+					cnn_blob_r(model->model(), inputs[b], outputs[b], &activations);
+				}
+			});
+	} else {
+		acc = evaluate(test.count, test.input, test.label, threads, cnn_batch);
+	}
 
 	std::cerr << "Testing accuracy: " << acc << std::endl;
 
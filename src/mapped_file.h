@@ -0,0 +1,72 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile {
+private:
+	const char *addr = nullptr;
+	size_t length = 0;
+	bool mapped = false;
+
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	~MappedFile() {
+		close();
+	}
+
+	// Returns false with errno set on failure, an empty file maps to an empty range
+	bool open(const char *filename) {
+		close();
+
+		int fd = ::open(filename, O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) < 0) {
+			::close(fd);
+			return false;
+		}
+
+		if (st.st_size > 0) {
+			void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED) {
+				::close(fd);
+				return false;
+			}
+			madvise(p, st.st_size, MADV_SEQUENTIAL);
+			addr = static_cast<const char *>(p);
+			length = st.st_size;
+		}
+		::close(fd); // The mapping keeps its own reference to the file
+		mapped = true;
+		return true;
+	}
+
+	void close() {
+		if (addr) {
+			munmap(const_cast<char *>(addr), length);
+		}
+		addr = nullptr;
+		length = 0;
+		mapped = false;
+	}
+
+	bool is_open() const { return mapped; }
+	const char *data() const { return addr; }
+	size_t size() const { return length; }
+	const char *begin() const { return addr; }
+	const char *end() const { return addr + length; }
+};
+
+#endif//_MAPPED_FILE_H_
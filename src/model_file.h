@@ -0,0 +1,137 @@
+#ifndef _MODEL_FILE_H_
+#define _MODEL_FILE_H_
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "mapped_file.h"
+#include "model_blob.h"
+
+// Model blob mapped from a file, the inference reads its weights in place
+class ModelFile {
+private:
+	MappedFile file;
+	model_blob_t blob = {};
+	struct stat st = {};
+
+public:
+	// Returns an error message or NULL on success
+	const char *open(const char *filename) {
+		if (stat(filename, &st) < 0 || !file.open(filename)) {
+			return strerror(errno);
+		}
+		return model_blob_open(file.data(), file.size(), &blob);
+	}
+
+	const model_blob_t *model() const { return &blob; }
+	const char *name() const { return blob.header->name; }
+
+	// The file at filename is no longer the one mapped, replaced or modified since open()
+	bool changed(const char *filename) const {
+		struct stat now;
+		return stat(filename, &now) < 0 || now.st_ino != st.st_ino || now.st_dev != st.st_dev
+			|| now.st_mtim.tv_sec != st.st_mtim.tv_sec || now.st_mtim.tv_nsec != st.st_mtim.tv_nsec;
+	}
+};
+
+// Model shared by inference threads and replaced while they run: load() maps and validates the new file before
+// publishing it, and the previous one stays mapped until the last inference holding it returns. Replace the file by
+// renaming a new one over it, like writeModelBlob() does, writing in place would change the mapped weights
+class ModelSlot {
+private:
+	std::shared_ptr<const ModelFile> current;
+
+public:
+	// Returns an error message or NULL on success, the current model is kept on error
+	const char *load(const char *filename) {
+		std::shared_ptr<ModelFile> next = std::make_shared<ModelFile>();
+		const char *error = next->open(filename);
+		if (error) {
+			return error;
+		}
+		std::atomic_store(&current, std::shared_ptr<const ModelFile>(std::move(next)));
+		return NULL;
+	}
+
+	// Model to run one or more inferences with, NULL before the first load()
+	std::shared_ptr<const ModelFile> get() const {
+		return std::atomic_load(&current);
+	}
+};
+
+// One layer of a blob to write, weights and bias are NULL for the layers without them
+struct ModelBlobSection {
+	model_blob_layer_t layer; // Section offsets are filled in by writeModelBlob()
+	const void *weights;
+	const void *bias;
+};
+
+// Write a blob with the given layers, to a temporary file renamed over filename so that a process mapping the previous
+// blob never sees a partial one. Returns an error message or NULL on success
+inline const char *writeModelBlob(const char *filename, const char *name, std::vector<ModelBlobSection> layers,
+                                  uint32_t input_channels, uint32_t input_samples, uint32_t output_samples) {
+	auto align = [](size_t offset) {
+		return (offset + MODEL_BLOB_ALIGNMENT - 1) / MODEL_BLOB_ALIGNMENT * MODEL_BLOB_ALIGNMENT;
+	};
+
+	// Descriptors after the header, then the sections in layer order
+	size_t size = sizeof(model_blob_header_t) + layers.size() * sizeof(model_blob_layer_t);
+	for (auto &section : layers) {
+		section.layer.weights_offset = section.layer.weights_bytes ? (size = align(size)) : 0;
+		size += section.layer.weights_bytes;
+		section.layer.bias_offset = section.layer.bias_bytes ? (size = align(size)) : 0;
+		size += section.layer.bias_bytes;
+	}
+	size = align(size);
+
+	std::vector<uint8_t> blob(size, 0);
+	model_blob_header_t header = {};
+	memcpy(header.magic, MODEL_BLOB_MAGIC, sizeof(header.magic));
+	header.version = MODEL_BLOB_VERSION;
+	header.size = size;
+	header.fixed_point = FIXED_POINT;
+	header.number_size = sizeof(number_t);
+	header.input_channels = input_channels;
+	header.input_samples = input_samples;
+	header.output_samples = output_samples;
+	header.layers = layers.size();
+	strncpy(header.name, name, sizeof(header.name) - 1);
+
+	for (size_t i = 0; i < layers.size(); i++) {
+		const ModelBlobSection &section = layers[i];
+		memcpy(&blob[sizeof(header) + i * sizeof(model_blob_layer_t)], &section.layer, sizeof(model_blob_layer_t));
+		if (section.layer.weights_bytes) {
+			memcpy(&blob[section.layer.weights_offset], section.weights, section.layer.weights_bytes);
+		}
+		if (section.layer.bias_bytes) {
+			memcpy(&blob[section.layer.bias_offset], section.bias, section.layer.bias_bytes);
+		}
+	}
+	header.checksum = model_blob_checksum(&blob[sizeof(header)], size - sizeof(header));
+	memcpy(&blob[0], &header, sizeof(header));
+
+	std::string temporary = std::string(filename) + ".tmp";
+	std::ofstream fout(temporary, std::ios::binary | std::ios::trunc);
+	if (!fout) {
+		return strerror(errno);
+	}
+	fout.write(reinterpret_cast<const char *>(blob.data()), blob.size());
+	if (!fout.flush()) {
+		return "write failed";
+	}
+	fout.close();
+	if (rename(temporary.c_str(), filename) < 0) {
+		return strerror(errno);
+	}
+	return NULL;
+}
+
+#endif//_MODEL_FILE_H_
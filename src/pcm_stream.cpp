@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "board/activity.h"
+#include "board/mfcc.h"
+#include "model.h"
+#include "percentile.h"
+#include "pcm_stream.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const unsigned int sample_rate = MFCC_SAMPLE_RATE; // I2S_SAMPLE_RATE of board.ino
+const size_t block_samples = 256; // Samples per read, like a capture buffer of the board
+const size_t queue_blocks = 8; // Blocks read ahead of the model, the next ones are dropped when reading paced
+const uint64_t clip_samples = MFCC_SAMPLE_RATE; // CLIP_SAMPLES of board.ino
+
+// Samples read together, numbered from the start of the stream with the dropped ones included
+struct Block {
+	uint64_t first;
+	Clock::time_point arrival; // Read of the last sample
+	std::vector<int16_t> samples;
+};
+
+// Blocks handed from the reader thread to the model
+class BlockQueue {
+private:
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<Block> blocks;
+	bool closed = false;
+
+public:
+	// Returns false if the queue is full and wait is false, the block is then dropped
+	bool push(Block &&block, bool wait) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (wait) {
+			changed.wait(lock, [&]() { return blocks.size() < queue_blocks; });
+		} else if (blocks.size() >= queue_blocks) {
+			return false;
+		}
+		blocks.push_back(std::move(block));
+		changed.notify_all();
+		return true;
+	}
+
+	// No more blocks after the queued ones
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		changed.notify_all();
+	}
+
+	// Returns false once the queue is closed and empty
+	bool pop(Block &block) {
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [&]() { return !blocks.empty() || closed; });
+		if (blocks.empty()) {
+			return false;
+		}
+		block = std::move(blocks.front());
+		blocks.pop_front();
+		changed.notify_all();
+		return true;
+	}
+};
+
+// Read full blocks from fd until end of file, paced at speed times real time when speed > 0. Returns the samples read,
+// dropped ones included
+uint64_t readBlocks(int fd, double speed, BlockQueue &queue, uint64_t &dropped_blocks, uint64_t &dropped_samples) {
+	Clock::time_point start = Clock::now();
+	uint64_t position = 0;
+
+	for (;;) {
+		Block block;
+		block.samples.resize(block_samples);
+		size_t bytes = 0, size = block_samples * sizeof(int16_t);
+		while (bytes < size) {
+			ssize_t r = read(fd, reinterpret_cast<char *>(block.samples.data()) + bytes, size - bytes);
+			if (r < 0 && errno == EINTR) {
+				continue;
+			}
+			if (r <= 0) {
+				break;
+			}
+			bytes += r;
+		}
+		block.samples.resize(bytes / sizeof(int16_t)); // An odd last byte is not a sample
+		if (block.samples.empty()) {
+			break;
+		}
+
+		size_t n = block.samples.size();
+		if (speed > 0) { // The block is complete once its last sample would have been captured
+			std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+				std::chrono::duration<double>((position + n) / (sample_rate * speed))));
+		}
+		block.first = position;
+		block.arrival = Clock::now();
+		position += n;
+		if (!queue.push(std::move(block), speed <= 0)) {
+			dropped_blocks++;
+			dropped_samples += n;
+		}
+	}
+	queue.close();
+	return position;
+}
+
+// Windowing of board.ino on the blocks of the queue
+class PcmStream {
+private:
+	const PcmStreamOptions options;
+	ActivityGate gate; // Fed with every sample received
+	uint64_t expected = 0; // First sample of the next block without a gap
+
+	// Raw sliding windows: samples [history_first, history_first + history.size()) and the state of cnn_stream()
+	std::vector<number_t> history;
+	uint64_t history_first = 0;
+	uint64_t window_end = MODEL_INPUT_SAMPLES; // Sample at which the next window is complete
+	cnn_stream_t stream;
+	bool stream_stale = false;
+
+	// MFCC clips
+	std::unique_ptr<MFCC> mfcc{new MFCC}; // Tables and state take tens of KB
+	uint64_t clip_first = 0; // First sample of the current clip, clips start every clip_samples samples of the stream
+	uint64_t clip_pushed = 0; // Samples of the current clip so far, dropped ones included
+	bool clip_active = false; // Activity gate open at some point during the clip
+	bool clip_lost = false; // Samples of the current clip were dropped, it is counted as dropped once complete
+
+	void classified(uint64_t end, const number_t output[MODEL_OUTPUT_SAMPLES], const Block &block) {
+		double latency = std::chrono::duration<double, std::micro>(Clock::now() - block.arrival).count();
+		latencies.push_back(latency);
+		// Times to the sample, 1/16000 s needs 7 decimals
+		std::cout << std::setprecision(7) << end / (double)sample_rate << "," << model_decision(output) << "," << output[0] << ","
+			<< std::setprecision(1) << latency << "\n";
+	}
+
+	void windows(const Block &block) {
+		if (block.first != expected) { // Samples were dropped, restart from a full window after them like drainCapture()
+			// Windows stay on the hop grid of the stream so that every window of it is classified, skipped or dropped
+			uint64_t restart = MODEL_INPUT_SAMPLES + (block.first + MODEL_STREAM_HOP - 1) / MODEL_STREAM_HOP * MODEL_STREAM_HOP;
+			for (; window_end < restart; window_end += MODEL_STREAM_HOP) {
+				dropped++;
+			}
+			history.clear();
+			history_first = block.first;
+			cnn_stream_reset(&stream);
+		}
+		history.insert(history.end(), block.samples.begin(), block.samples.end()); // PCM samples are used as is
+		uint64_t head = block.first + block.samples.size();
+
+		number_t output[MODEL_OUTPUT_SAMPLES];
+		for (; window_end <= head; window_end += MODEL_STREAM_HOP) {
+			if (options.gate && !gate.active()) {
+				skipped++;
+				stream_stale = true;
+				continue;
+			}
+			if (stream_stale) {
+				cnn_stream_reset(&stream); // The next window is computed in full
+				stream_stale = false;
+			}
+			const number_t (*window)[MODEL_INPUT_SAMPLES] = reinterpret_cast<const number_t (*)[MODEL_INPUT_SAMPLES]>(
+				&history[window_end - MODEL_INPUT_SAMPLES - history_first]);
+			cnn_stream(window, output, &stream);
+			classified(window_end, output, block);
+		}
+
+		// Keep the start of the next window
+		uint64_t keep = window_end - MODEL_INPUT_SAMPLES;
+		if (keep > history_first) {
+			history.erase(history.begin(), history.begin() + std::min<uint64_t>(keep - history_first, history.size()));
+			history_first = std::min(keep, head);
+		}
+	}
+
+	void resetClip() {
+		mfcc->reset();
+		clip_pushed = 0;
+		clip_active = gate.active();
+		clip_lost = false;
+	}
+
+	void clips(const Block &block) {
+		if (block.first != expected) { // Samples were dropped, every clip missing some of them is dropped
+			uint64_t first = block.first / clip_samples * clip_samples; // Clip of the block
+			dropped += (first - clip_first) / clip_samples; // The clips that ended in the gap
+			clip_first = first;
+			resetClip();
+			clip_pushed = block.first - first;
+			clip_lost = clip_pushed > 0;
+		}
+
+		const int16_t *samples = block.samples.data();
+		size_t count = block.samples.size();
+		while (count > 0) {
+			size_t n = std::min<uint64_t>(count, clip_samples - clip_pushed);
+			if (!clip_lost) {
+				mfcc->push(samples, n);
+			}
+			samples += n;
+			count -= n;
+			clip_pushed += n;
+			clip_active |= gate.active();
+
+			if (clip_pushed == clip_samples) {
+				if (clip_lost) {
+					dropped++;
+				} else if (options.gate && !clip_active) {
+					skipped++;
+				} else {
+					// Q(MFCC_FRACTION_BITS) dB to number_t like the float inputs of the evaluator
+					int32_t coefficients[MFCC_N_COEFFICIENTS];
+					number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES];
+					number_t output[MODEL_OUTPUT_SAMPLES];
+					mfcc->finish(coefficients);
+					for (size_t i = 0; i < MODEL_INPUT_SAMPLES; i++) {
+						input[0][i] = clamp_to_number_t(MFCC::toFixed(coefficients[i], FIXED_POINT));
+					}
+					cnn(input, output);
+					classified(clip_first + clip_samples, output, block);
+				}
+				clip_first += clip_samples;
+				resetClip(); // The samples after the clip start the next one
+			}
+		}
+	}
+
+public:
+	std::vector<double> latencies; // Per classified window, us
+	uint64_t skipped = 0; // Windows (clips) with the activity gate closed
+	uint64_t dropped = 0; // Windows (clips) lost with dropped samples
+
+	explicit PcmStream(const PcmStreamOptions &options) : options(options) {
+		static_assert(MODEL_INPUT_CHANNELS == 1, "Windows are read from a single channel");
+		static_assert(sizeof(number_t) == sizeof(int16_t), "PCM samples are used as is");
+		cnn_stream_reset(&stream);
+		resetClip();
+	}
+
+	void push(const Block &block) {
+		gate.push(block.samples.data(), block.samples.size());
+		if (options.mfcc) {
+			clips(block);
+		} else {
+			windows(block);
+		}
+		expected = block.first + block.samples.size();
+	}
+
+	// End of the stream at sample total, dropped ones included: count the windows (clips) that the samples dropped after
+	// the last block would have completed
+	void finish(uint64_t total) {
+		if (options.mfcc) {
+			dropped += (total - clip_first) / clip_samples;
+		} else {
+			for (; window_end <= total; window_end += MODEL_STREAM_HOP) {
+				dropped++;
+			}
+		}
+	}
+};
+
+} // namespace
+
+int streamPcm(const PcmStreamOptions &options) {
+	BlockQueue queue;
+	uint64_t dropped_blocks = 0, dropped_samples = 0, total = 0;
+	std::thread reader([&]() {
+		total = readBlocks(STDIN_FILENO, options.speed, queue, dropped_blocks, dropped_samples);
+	});
+
+	std::unique_ptr<PcmStream> stream(new PcmStream(options));
+	std::cout << std::fixed;
+	Clock::duration busy{0};
+	Clock::time_point start = Clock::now();
+	Block block;
+	while (queue.pop(block)) {
+		Clock::time_point begin = Clock::now();
+		stream->push(block);
+		busy += Clock::now() - begin;
+	}
+	double wall = std::chrono::duration<double>(Clock::now() - start).count();
+	reader.join();
+	stream->finish(total);
+	std::cout.flush();
+
+	double audio = total / (double)sample_rate;
+	double processing = std::chrono::duration<double>(busy).count();
+	std::cerr << "Audio " << audio << " s in " << wall << " s (" << (wall > 0 ? audio / wall : 0) << "x real time), processing "
+		<< processing << " s: real-time factor " << (audio > 0 ? processing / audio : 0) << std::endl;
+	std::cerr << (options.mfcc ? "Clips: " : "Windows: ") << stream->latencies.size() << " classified, " << stream->skipped
+		<< " skipped by the activity gate, " << stream->dropped << " dropped (" << dropped_blocks << " blocks, "
+		<< dropped_samples << " samples of input dropped)" << std::endl;
+	std::cerr << "Latency: p50 " << percentile(stream->latencies, 50) << " us, p99 " << percentile(stream->latencies, 99)
+		<< " us, max " << percentile(stream->latencies, 100) << " us" << std::endl;
+	return 0;
+}
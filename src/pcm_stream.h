@@ -0,0 +1,16 @@
+#ifndef _PCM_STREAM_H_
+#define _PCM_STREAM_H_
+
+struct PcmStreamOptions {
+	bool mfcc; // 1 s clips through the MFCC front-end like MFCC_FRONTEND of board.ino, raw sliding windows otherwise
+	bool gate; // Only classify windows (clips) where the activity gate is open, like ACTIVITY_GATE
+	double speed; // Read the input at this multiple of real time, dropping blocks when the model falls behind like the
+	              // I2S capture of the board. 0 reads as fast as the model consumes it and never drops
+};
+
+// Classify mono signed 16-bit PCM at 16 kHz read from stdin with the windowing of board.ino, one line per window on
+// stdout: end time in seconds, decision, output and latency in us since the read of its last sample. Real-time
+// factor, latency percentiles and dropped windows are printed on stderr at the end of the input. Returns the exit status
+int streamPcm(const PcmStreamOptions &options);
+
+#endif//_PCM_STREAM_H_
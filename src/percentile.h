@@ -0,0 +1,18 @@
+#ifndef _PERCENTILE_H_
+#define _PERCENTILE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Nearest-rank percentile p in [0, 100] of values, 0 if there are none. Takes a copy since it reorders the values
+inline double percentile(std::vector<double> values, double p) {
+	if (values.empty()) {
+		return 0;
+	}
+	size_t rank = std::min(values.size() - 1, (size_t)(p / 100 * values.size()));
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	return values[rank];
+}
+
+#endif//_PERCENTILE_H_
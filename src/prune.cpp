@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include "prune.h"
+
+// Weights being pruned, conv1d_6 and the bias of dense_4 are kept as they are
+#include "weights/conv1d_6.c"
+#include "weights/dense_4.c"
+
+namespace {
+
+template<typename T>
+void writeValues(std::ostream &out, const T *values, size_t n) {
+	out << "{";
+	for (size_t i = 0; i < n; i++) {
+		out << (i ? ", " : "") << (long)values[i];
+	}
+	out << "}";
+}
+
+} // namespace
+
+size_t SparseDenseWeights::bytes() const {
+	return values.size() * sizeof(number_t) + deltas.size() * sizeof(uint8_t) + sizeof(counts);
+}
+
+unsigned int SparseDenseWeights::skippedFilters() const {
+	std::vector<bool> used(conv1d_6_t::Filters, false);
+	size_t entry = 0;
+	for (unsigned int u = 0; u < dense_4_sparse_t::Units; u++) {
+		unsigned int index = 0;
+		for (unsigned int i = 0; i < counts[u]; i++, entry++) {
+			index += deltas[entry];
+			used[index / conv1d_6_t::OutputSamples] = true;
+		}
+	}
+	return std::count(used.begin(), used.end(), false);
+}
+
+void SparseDenseWeights::run(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) const {
+	max_pooling1d_6_t::output_type pooled;
+	max_pooling1d_6_t::forward(input, pooled);
+	conv1d_6_dense_4_sparse_t::forward(pooled, conv1d_6_kernel, conv1d_6_bias, values.data(), deltas.data(), counts, dense_4_bias, output);
+}
+
+SparseDenseWeights pruneDense(double sparsity) {
+	const size_t n = dense_4_t::InputSamples;
+	SparseDenseWeights weights;
+
+	for (unsigned int u = 0; u < dense_4_t::Units; u++) {
+		const number_t *row = dense_4_kernel[u];
+
+		// Smallest magnitudes first, the order of equal magnitudes is kept so that the result is reproducible
+		std::vector<unsigned int> order(n);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+			return std::abs((long)row[a]) < std::abs((long)row[b]);
+		});
+		std::vector<bool> pruned(n, false);
+		size_t target = std::min(n, (size_t)(n * sparsity / 100 + 0.5));
+		for (size_t i = 0; i < target; i++) {
+			pruned[order[i]] = true;
+			weights.threshold = std::max<number_t>(weights.threshold, std::abs((long)row[order[i]]));
+		}
+
+		size_t first = weights.values.size();
+		unsigned int previous = 0;
+		for (unsigned int i = 0; i < n; i++) {
+			if (pruned[i] || row[i] == 0) {
+				weights.zeros++;
+				continue;
+			}
+			for (; i - previous > dense_4_sparse_t::MaxDelta; previous += dense_4_sparse_t::MaxDelta) {
+				weights.values.push_back(0);
+				weights.deltas.push_back(dense_4_sparse_t::MaxDelta);
+				weights.fillers++;
+			}
+			weights.values.push_back(row[i]);
+			weights.deltas.push_back(i - previous);
+			previous = i;
+		}
+		weights.counts[u] = weights.values.size() - first;
+	}
+	return weights;
+}
+
+bool writeSparseDense(const SparseDenseWeights &weights, double sparsity, const char *directory) {
+	std::string path = std::string(directory) + "/dense_4_sparse.c";
+	std::ofstream out(path);
+	out << "/**\n"
+		"  ******************************************************************************\n"
+		"  * @file    weights/dense_4_sparse.c\n"
+		"  * @brief   dense_4 magnitude-pruned to " << sparsity << "% zero weights, nonzero weights with one-byte index deltas\n"
+		"  *          Generated by main --prune, do not edit\n"
+		"  */\n\n";
+	out << "#define FC_UNITS " << dense_4_sparse_t::Units << "\n";
+	out << "#define SPARSE_ENTRIES " << std::max<size_t>(1, weights.values.size()) << "\n\n";
+	out << "// " << weights.zeros << "/" << dense_4_t::MACs << " weights left out, magnitudes up to " << weights.threshold
+		<< " pruned, " << weights.fillers << " zero entries bridge long gaps\n";
+
+	// An empty array is not valid C, a unit without weights still gets one zero entry
+	std::vector<number_t> values = weights.values;
+	std::vector<uint8_t> deltas = weights.deltas;
+	if (values.empty()) {
+		values.push_back(0);
+		deltas.push_back(0);
+	}
+	out << "const uint16_t dense_4_sparse_counts[FC_UNITS] = ";
+	writeValues(out, weights.counts, dense_4_sparse_t::Units);
+	out << "\n;\n\nconst int16_t dense_4_sparse_values[SPARSE_ENTRIES] NUMBER_ALIGN = ";
+	writeValues(out, values.data(), values.size());
+	out << "\n;\n\nconst uint8_t dense_4_sparse_deltas[SPARSE_ENTRIES] = ";
+	writeValues(out, deltas.data(), deltas.size());
+	out << "\n;\n\n#undef FC_UNITS\n#undef SPARSE_ENTRIES\n";
+	if (!out.good()) {
+		std::cerr << "Error writing \"" << path << "\": " << strerror(errno) << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,34 @@
+#ifndef _PRUNE_H_
+#define _PRUNE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "model.h"
+
+// dense_4 with its smallest weights set to zero, in the storage of SparseDense (layers.h)
+struct SparseDenseWeights {
+	std::vector<number_t> values;
+	std::vector<uint8_t> deltas;
+	dense_4_sparse_t::count_type counts;
+	size_t zeros = 0; // Weights left out, pruned or already zero
+	size_t fillers = 0; // Zero entries bridging gaps over SparseDense::MaxDelta
+	number_t threshold = 0; // Largest magnitude pruned
+
+	// Flash bytes of the tables of weights/dense_4_sparse.c
+	size_t bytes() const;
+
+	// conv1d_6 filters that feed no stored weight, never computed by the fused kernel
+	unsigned int skippedFilters() const;
+
+	// Same layer calls as cnn_r() built with MODEL_SPARSE_DENSE on these tables
+	void run(const number_t input[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], number_t output[MODEL_OUTPUT_SAMPLES]) const;
+};
+
+// Prune the weights of dense_4 with the smallest magnitudes until sparsity percent of them are zero
+SparseDenseWeights pruneDense(double sparsity);
+
+// Write dense_4_sparse.c into directory, returns false on error
+bool writeSparseDense(const SparseDenseWeights &weights, double sparsity, const char *directory);
+
+#endif//_PRUNE_H_
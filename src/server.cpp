@@ -0,0 +1,536 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "model_blob.h"
+#include "model_file.h"
+#include "percentile.h"
+#include "server.h"
+
+namespace {
+
+typedef number_t input_t[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES];
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t max_payload = 1 << 16; // Larger requests are rejected and their connection closed
+const size_t max_queue = 4096; // Requests waiting for a worker, the next ones are answered SERVER_BUSY
+const size_t latency_window = 8192; // Latest responses the percentiles are computed over
+const int send_timeout_ms = 1000; // A client that does not read its responses for this long is dropped, not waited for
+
+std::atomic<bool> stopping{false};
+
+void onSignal(int) {
+	stopping = true;
+}
+
+// Read or write exactly n bytes, false on end of file or error
+bool readAll(int fd, void *data, size_t n) {
+	char *p = static_cast<char *>(data);
+	while (n > 0) {
+		ssize_t r = recv(fd, p, n, 0);
+		if (r < 0 && errno == EINTR) {
+			continue;
+		}
+		if (r <= 0) {
+			return false;
+		}
+		p += r;
+		n -= r;
+	}
+	return true;
+}
+
+bool writeAll(int fd, const void *data, size_t n) {
+	const char *p = static_cast<const char *>(data);
+	while (n > 0) {
+		ssize_t w = send(fd, p, n, MSG_NOSIGNAL); // A closed peer is an error, not a SIGPIPE
+		if (w < 0 && errno == EINTR) {
+			continue;
+		}
+		if (w <= 0) {
+			return false;
+		}
+		p += w;
+		n -= w;
+	}
+	return true;
+}
+
+// Fill address with a UNIX socket path, false if it does not fit
+bool socketAddress(const char *path, sockaddr_un &address) {
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		return false;
+	}
+	strcpy(address.sun_path, path);
+	return true;
+}
+
+int32_t decide(const number_t outputs[MODEL_OUTPUT_SAMPLES]) {
+	if (MODEL_OUTPUT_SAMPLES == 1) {
+		return outputs[0] >= 0;
+	}
+	return std::max_element(outputs, outputs + MODEL_OUTPUT_SAMPLES) - outputs;
+}
+
+// Client connection, the reader thread and the workers answering its requests share it
+struct Connection {
+	int fd;
+	std::mutex write_mutex; // Responses of several workers are never interleaved
+	bool broken = false; // A response could not be written, guarded by write_mutex
+	std::atomic<uint64_t> &dropped; // Connections of the server dropped this way
+	std::atomic<bool> done{false}; // Reader returned, its thread can be joined
+
+	Connection(int fd, std::atomic<uint64_t> &dropped) : fd(fd), dropped(dropped) {}
+	~Connection() {
+		close(fd);
+	}
+
+	// Writes block for at most send_timeout_ms. A response cut short leaves the stream unusable, so on the first
+	// failure the connection is shut down, which also ends its reader, and the later responses are discarded
+	bool respond(uint32_t id, uint32_t status, const void *payload, uint32_t bytes) {
+		ServerResponse response = {SERVER_RESPONSE_MAGIC, id, status, bytes};
+		std::lock_guard<std::mutex> lock(write_mutex);
+		if (broken) {
+			return false;
+		}
+		if (writeAll(fd, &response, sizeof(response)) && writeAll(fd, payload, bytes)) {
+			return true;
+		}
+		broken = true;
+		shutdown(fd, SHUT_RDWR);
+		dropped++;
+		return false;
+	}
+
+	bool respondError(uint32_t id, const char *message) {
+		return respond(id, SERVER_BAD_REQUEST, message, strlen(message));
+	}
+};
+
+struct Pending {
+	std::shared_ptr<Connection> connection;
+	uint32_t id;
+	Clock::time_point arrival; // Payload received
+	std::array<number_t, MODEL_INPUT_CHANNELS * MODEL_INPUT_SAMPLES> input;
+};
+
+class Server {
+private:
+	const ServerOptions options;
+	ModelSlot slot;
+
+	std::mutex mutex; // Queue and metrics
+	std::condition_variable ready;
+	std::deque<Pending> queue;
+	bool stopped = false; // No more requests, workers drain the queue and return
+
+	size_t max_depth = 0;
+	uint64_t requests = 0, rejected = 0;
+	std::atomic<uint64_t> dropped{0}; // Connections closed because they did not read their responses
+	std::vector<uint64_t> batch_sizes; // Micro-batches by size
+	std::vector<double> latencies; // Arrival to response in us, ring of the latest latency_window
+	size_t latency_count = 0;
+
+	// Next micro-batch: max_batch requests, or fewer once the oldest has waited for the deadline
+	bool take(std::vector<Pending> &batch) {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			if (queue.size() >= options.max_batch
+				|| (!queue.empty() && (stopped || Clock::now() >= queue.front().arrival + std::chrono::microseconds(options.deadline_us)))) {
+				break;
+			}
+			if (stopped) {
+				return false;
+			}
+			if (queue.empty()) {
+				ready.wait(lock);
+			} else {
+				ready.wait_until(lock, queue.front().arrival + std::chrono::microseconds(options.deadline_us));
+			}
+		}
+
+		size_t n = std::min<size_t>(options.max_batch, queue.size());
+		batch.clear();
+		std::move(queue.begin(), queue.begin() + n, std::back_inserter(batch));
+		queue.erase(queue.begin(), queue.begin() + n);
+		batch_sizes[n]++;
+		if (!queue.empty()) {
+			ready.notify_one(); // The rest goes to another worker
+		}
+		return true;
+	}
+
+	void work() {
+		std::unique_ptr<cnn_batch_activations_t> activations(new cnn_batch_activations_t);
+		cnn_activations_t blob_activations;
+		std::vector<Pending> batch;
+		std::vector<std::array<number_t, MODEL_INPUT_CHANNELS * MODEL_INPUT_SAMPLES>> inputs;
+		std::vector<std::array<number_t, MODEL_OUTPUT_SAMPLES>> outputs;
+
+		while (take(batch)) {
+			inputs.resize(batch.size());
+			outputs.resize(batch.size());
+			for (size_t b = 0; b < batch.size(); b++) {
+				inputs[b] = batch[b].input;
+			}
+			const input_t *batch_inputs = reinterpret_cast<const input_t *>(inputs.data());
+			number_t (*batch_outputs)[MODEL_OUTPUT_SAMPLES] = reinterpret_cast<number_t (*)[MODEL_OUTPUT_SAMPLES]>(outputs.data());
+
+			if (options.model_path) {
+				std::shared_ptr<const ModelFile> model = slot.get(); // Kept mapped for the whole batch
+				for (size_t b = 0; b < batch.size(); b++) {
+					cnn_blob_r(model->model(), batch_inputs[b], batch_outputs[b], &blob_activations);
+				}
+			} else {
+				cnn_batch(batch.size(), batch_inputs, batch_outputs, activations.get());
+			}
+
+			for (size_t b = 0; b < batch.size(); b++) {
+				ServerResult result = {};
+				memcpy(result.outputs, batch_outputs[b], sizeof(result.outputs));
+				result.decision = decide(result.outputs);
+				if (!batch[b].connection->respond(batch[b].id, SERVER_OK, &result, sizeof(result))) {
+					continue; // Dropped connection, not a latency
+				}
+
+				double us = std::chrono::duration<double, std::micro>(Clock::now() - batch[b].arrival).count();
+				std::lock_guard<std::mutex> lock(mutex);
+				latencies[latency_count++ % latency_window] = us;
+			}
+			batch.clear(); // Drop the connections before waiting again
+		}
+	}
+
+	// False when the queue is full, the request is then rejected rather than queued behind max_queue others
+	bool enqueue(Pending &&pending) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.size() >= max_queue) {
+			rejected++;
+			return false;
+		}
+		queue.push_back(std::move(pending));
+		max_depth = std::max(max_depth, queue.size());
+		requests++;
+		ready.notify_one(); // A full batch, or the deadline of a new oldest request
+		return true;
+	}
+
+	std::string metrics() {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::ostringstream out;
+		out << "queue_depth " << queue.size() << "\n";
+		out << "queue_depth_max " << max_depth << "\n";
+		out << "requests " << requests << "\n";
+		out << "rejected " << rejected << "\n";
+		out << "dropped_connections " << dropped << "\n";
+		out << "batch_size";
+		for (size_t n = 1; n < batch_sizes.size(); n++) {
+			out << " " << n << ":" << batch_sizes[n];
+		}
+		std::vector<double> recent(latencies.begin(), latencies.begin() + std::min(latency_count, latency_window));
+		out << "\nlatency_us p50 " << percentile(recent, 50) << " p99 " << percentile(recent, 99) << " over " << recent.size() << "\n";
+		out << "model " << (options.model_path ? slot.get()->name() : "cnn") << "\n";
+		return out.str();
+	}
+
+	// Read the requests of one connection until it closes, inferences are queued and answered by the workers
+	void read(std::shared_ptr<Connection> connection) {
+		ServerRequest request;
+		std::vector<char> payload;
+
+		while (readAll(connection->fd, &request, sizeof(request))) {
+			if (request.magic != SERVER_REQUEST_MAGIC || request.bytes > max_payload) {
+				connection->respondError(request.id, request.magic != SERVER_REQUEST_MAGIC ? "bad magic" : "payload too large");
+				break; // The stream cannot be resynchronized
+			}
+			payload.resize(request.bytes);
+			if (!readAll(connection->fd, payload.data(), payload.size())) {
+				break;
+			}
+
+			if (request.kind == SERVER_METRICS) {
+				std::string text = metrics();
+				connection->respond(request.id, SERVER_OK, text.data(), text.size());
+				continue;
+			}
+
+			Pending pending;
+			const char *error = NULL;
+			if (request.kind == SERVER_FEATURES && request.bytes == sizeof(input_t)) {
+				memcpy(pending.input.data(), payload.data(), sizeof(input_t));
+			} else if (request.kind == SERVER_PCM && MODEL_INPUT_CHANNELS == 1 && request.bytes == MODEL_INPUT_SAMPLES * sizeof(int16_t)) {
+				static_assert(sizeof(number_t) == sizeof(int16_t), "PCM samples are used as is");
+				memcpy(pending.input.data(), payload.data(), request.bytes);
+			} else {
+				error = request.kind == SERVER_FEATURES || request.kind == SERVER_PCM ? "payload size does not match the model" : "unknown request kind";
+			}
+			if (error) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					rejected++;
+				}
+				connection->respondError(request.id, error);
+				continue;
+			}
+
+			pending.connection = connection;
+			pending.id = request.id;
+			pending.arrival = Clock::now();
+			if (!enqueue(std::move(pending))) {
+				static const char busy[] = "queue full";
+				connection->respond(request.id, SERVER_BUSY, busy, sizeof(busy) - 1);
+			}
+		}
+		connection->done = true;
+	}
+
+public:
+	explicit Server(const ServerOptions &options) : options(options), batch_sizes(options.max_batch + 1, 0), latencies(latency_window, 0) {}
+
+	int run() {
+		if (options.model_path) {
+			const char *error = slot.load(options.model_path);
+			if (error) {
+				std::cerr << "Error loading \"" << options.model_path << "\": " << error << std::endl;
+				return 1;
+			}
+		}
+
+		sockaddr_un address;
+		if (!socketAddress(options.socket_path, address)) {
+			std::cerr << "Error: socket path \"" << options.socket_path << "\" is too long" << std::endl;
+			return 1;
+		}
+		int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		unlink(options.socket_path); // Left by a previous run
+		if (listener < 0 || bind(listener, (const sockaddr *)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+			std::cerr << "Error listening on \"" << options.socket_path << "\": " << strerror(errno) << std::endl;
+			if (listener >= 0) {
+				close(listener);
+			}
+			return 1;
+		}
+
+		struct sigaction action = {};
+		action.sa_handler = onSignal;
+		sigaction(SIGINT, &action, NULL);
+		sigaction(SIGTERM, &action, NULL);
+
+		std::vector<std::thread> workers;
+		for (unsigned int w = 0; w < options.workers; w++) {
+			workers.emplace_back(&Server::work, this);
+		}
+		std::cerr << "Serving " << (options.model_path ? slot.get()->name() : "cnn") << " on " << options.socket_path << ": "
+			<< options.workers << " workers, micro-batches of up to " << options.max_batch << " within " << options.deadline_us << " us" << std::endl;
+
+		// Accept connections, reap the finished ones and reload the model file once it is replaced
+		std::vector<std::pair<std::shared_ptr<Connection>, std::thread>> readers;
+		Clock::time_point checked = Clock::now();
+		while (!stopping) {
+			pollfd fds = {listener, POLLIN, 0};
+			if (poll(&fds, 1, 200) > 0) {
+				int fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+				timeval timeout = {send_timeout_ms / 1000, send_timeout_ms % 1000 * 1000};
+				if (fd >= 0 && setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0) {
+					std::cerr << "Error setting the send timeout of a connection: " << strerror(errno) << std::endl;
+					close(fd);
+					fd = -1;
+				}
+				if (fd >= 0) {
+					std::shared_ptr<Connection> connection = std::make_shared<Connection>(fd, dropped);
+					readers.emplace_back(connection, std::thread(&Server::read, this, connection));
+				}
+			}
+
+			for (auto reader = readers.begin(); reader != readers.end();) {
+				if (reader->first->done) {
+					reader->second.join();
+					reader = readers.erase(reader);
+				} else {
+					++reader;
+				}
+			}
+
+			if (options.model_path && Clock::now() - checked >= std::chrono::seconds(1)) {
+				checked = Clock::now();
+				if (slot.get()->changed(options.model_path)) {
+					const char *error = slot.load(options.model_path);
+					if (error) {
+						std::cerr << "Keeping " << slot.get()->name() << ", error loading \"" << options.model_path << "\": " << error << std::endl;
+					} else {
+						std::cerr << "Reloaded " << slot.get()->name() << " from " << options.model_path << std::endl;
+					}
+				}
+			}
+		}
+
+		// No new requests, the queued ones are still answered
+		close(listener);
+		unlink(options.socket_path);
+		for (auto &reader : readers) {
+			shutdown(reader.first->fd, SHUT_RD);
+			reader.second.join();
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+		}
+		ready.notify_all();
+		for (auto &worker : workers) {
+			worker.join();
+		}
+		std::cerr << metrics();
+		return 0;
+	}
+};
+
+// Client side of one connection: requests i, i + connections... of the load, depth in flight at a time
+struct LoadConnection {
+	std::vector<double> latencies; // us
+	size_t mismatches = 0, errors = 0, busy = 0;
+	bool failed = false;
+};
+
+} // namespace
+
+int serve(const ServerOptions &options) {
+	Server server(options);
+	return server.run();
+}
+
+int loadTest(const char *socket_path, const number_t (*inputs)[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], size_t inputs_count,
+             unsigned int connections, size_t count, unsigned int depth, bool pcm) {
+	sockaddr_un address;
+	if (!socketAddress(socket_path, address)) {
+		std::cerr << "Error: socket path \"" << socket_path << "\" is too long" << std::endl;
+		return 1;
+	}
+	if (inputs_count == 0) {
+		std::cerr << "Error: no inputs" << std::endl;
+		return 1;
+	}
+	auto connect = [&]() {
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd >= 0 && ::connect(fd, (const sockaddr *)&address, sizeof(address)) < 0) {
+			close(fd);
+			fd = -1;
+		}
+		return fd;
+	};
+
+	// Expected outputs of the compiled-in model, a server running a blob of other weights reports mismatches
+	std::vector<std::array<number_t, MODEL_OUTPUT_SAMPLES>> expected(inputs_count);
+	std::unique_ptr<cnn_batch_activations_t> activations(new cnn_batch_activations_t);
+	cnn_batch(inputs_count, inputs, reinterpret_cast<number_t (*)[MODEL_OUTPUT_SAMPLES]>(expected.data()), activations.get());
+
+	std::vector<LoadConnection> results(connections);
+	auto client = [&](unsigned int c) {
+		LoadConnection &result = results[c];
+		int fd = connect();
+		if (fd < 0) {
+			std::cerr << "Error connecting to \"" << socket_path << "\": " << strerror(errno) << std::endl;
+			result.failed = true;
+			return;
+		}
+
+		std::vector<Clock::time_point> sent;
+		size_t next = c, received = 0, total = count > c ? (count - c + connections - 1) / connections : 0;
+		auto send = [&]() {
+			const input_t &input = inputs[next % inputs_count];
+			ServerRequest request = {SERVER_REQUEST_MAGIC, pcm ? (uint32_t)SERVER_PCM : (uint32_t)SERVER_FEATURES, (uint32_t)sent.size(), sizeof(input_t)};
+			sent.push_back(Clock::now());
+			next += connections;
+			return writeAll(fd, &request, sizeof(request)) && writeAll(fd, input, sizeof(input_t));
+		};
+
+		bool ok = true;
+		while (ok && sent.size() < std::min<size_t>(depth, total)) {
+			ok = send();
+		}
+		while (ok && received < total) {
+			ServerResponse response;
+			ServerResult payload;
+			ok = readAll(fd, &response, sizeof(response)) && response.magic == SERVER_RESPONSE_MAGIC && response.id < sent.size();
+			if (ok && response.status == SERVER_OK && response.bytes == sizeof(payload)) {
+				ok = readAll(fd, &payload, sizeof(payload));
+				size_t input = (c + (size_t)response.id * connections) % inputs_count;
+				result.mismatches += memcmp(payload.outputs, expected[input].data(), sizeof(payload.outputs)) != 0;
+			} else if (ok) {
+				std::vector<char> message(response.bytes);
+				ok = readAll(fd, message.data(), message.size());
+				result.busy += response.status == SERVER_BUSY;
+				result.errors += response.status != SERVER_BUSY;
+			}
+			if (ok) {
+				if (response.status != SERVER_BUSY) { // Not run, its latency is not one of an inference
+					result.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent[response.id]).count());
+				}
+				received++;
+				if (sent.size() < total) {
+					ok = send();
+				}
+			}
+		}
+		result.failed = !ok;
+		close(fd);
+	};
+
+	Clock::time_point start = Clock::now();
+	std::vector<std::thread> clients;
+	for (unsigned int c = 0; c < connections; c++) {
+		clients.emplace_back(client, c);
+	}
+	for (auto &thread : clients) {
+		thread.join();
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::vector<double> latencies;
+	size_t mismatches = 0, errors = 0, busy = 0, failed = 0;
+	for (auto &result : results) {
+		latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+		mismatches += result.mismatches;
+		errors += result.errors;
+		busy += result.busy;
+		failed += result.failed;
+	}
+	std::cout << latencies.size() << "/" << count << " responses over " << connections << " connections, " << depth << " in flight each: "
+		<< latencies.size() / seconds << " per second, " << busy << " answered busy" << std::endl;
+	std::cout << "Client latency: p50 " << percentile(latencies, 50) << " us, p99 " << percentile(latencies, 99) << " us" << std::endl;
+	std::cout << mismatches << " outputs different from cnn(), " << errors << " errors, " << failed << " connections failed" << std::endl;
+
+	// Metrics of the server after the load
+	int fd = connect();
+	ServerRequest request = {SERVER_REQUEST_MAGIC, SERVER_METRICS, 0, 0};
+	ServerResponse response;
+	if (fd >= 0 && writeAll(fd, &request, sizeof(request)) && readAll(fd, &response, sizeof(response))) {
+		std::string text(response.bytes, '\0');
+		if (readAll(fd, &text[0], text.size())) {
+			std::cout << "Server metrics:\n" << text;
+		}
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	return mismatches || errors || failed ? 1 : 0;
+}
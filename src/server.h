@@ -0,0 +1,63 @@
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "model.h"
+
+// Requests and responses on the UNIX socket of the server: a fixed header followed by bytes of payload, values in host
+// byte order since both ends run on the same machine
+#define SERVER_REQUEST_MAGIC 0x51435347 // "GSCQ"
+#define SERVER_RESPONSE_MAGIC 0x52435347 // "GSCR"
+
+enum ServerRequestKind : uint32_t {
+	SERVER_FEATURES = 1, // Quantized window: number_t[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], like a number_t dataset row
+	SERVER_PCM = 2, // MODEL_INPUT_SAMPLES signed 16-bit PCM samples used as is, like the raw path of board.ino
+	SERVER_METRICS = 3, // No payload, answered with the metrics as text
+};
+
+enum ServerStatus : uint32_t {
+	SERVER_OK = 0,
+	SERVER_BAD_REQUEST = 1, // Payload is an error message
+	SERVER_BUSY = 2, // Queue full, the request was not run and can be sent again. Payload is an error message
+};
+
+struct ServerRequest {
+	uint32_t magic;
+	uint32_t kind; // ServerRequestKind
+	uint32_t id; // Returned in the response, responses of one connection may come out of order
+	uint32_t bytes; // Payload following the header
+};
+
+struct ServerResponse {
+	uint32_t magic;
+	uint32_t id;
+	uint32_t status; // ServerStatus
+	uint32_t bytes;
+};
+
+// Payload of the response to SERVER_FEATURES and SERVER_PCM
+struct ServerResult {
+	int32_t decision; // Class: the sign of a single output, the highest of several
+	number_t outputs[MODEL_OUTPUT_SAMPLES];
+};
+
+struct ServerOptions {
+	const char *socket_path;
+	unsigned int workers; // Threads running micro-batches
+	unsigned int max_batch; // Requests per micro-batch
+	unsigned int deadline_us; // Longest wait of a request for its micro-batch to fill up
+	const char *model_path; // Model blob run instead of cnn() and reloaded when the file is replaced, NULL for none
+};
+
+// Serve until SIGINT or SIGTERM, returns the exit status
+int serve(const ServerOptions &options);
+
+// Send count requests over connections concurrent connections, depth of them in flight on each, cycling through the
+// inputs, as SERVER_PCM when pcm. Checks every output against cnn() and prints latency, throughput and the metrics of
+// the server. Requests answered SERVER_BUSY are counted but not sent again. Returns the exit status
+int loadTest(const char *socket_path, const number_t (*inputs)[MODEL_INPUT_CHANNELS][MODEL_INPUT_SAMPLES], size_t inputs_count,
+             unsigned int connections, size_t count, unsigned int depth, bool pcm);
+
+#endif//_SERVER_H_